@@ -0,0 +1,103 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Microbenchmark for the CPU sort, argsort and topk kernels of tvm.contrib.sort.
+see README.md for the usage of this script.
+"""
+import argparse
+import timeit
+
+import numpy as np
+
+import tvm
+
+
+def evaluate(func, repeat):
+    """Return the mean and the standard deviation of the running time of func in ms."""
+    func()
+    costs = np.array(timeit.repeat(func, number=1, repeat=repeat)) * 1000
+    return np.mean(costs), np.std(costs)
+
+
+def benchmark(op, shape, dtype, k, is_ascend, repeat):
+    """Benchmark an op of tvm.contrib.sort against the numpy stable sort."""
+    dev = tvm.cpu(0)
+    k = min(k, shape[-1])
+    np_data = np.random.uniform(-1000, 1000, size=shape).astype(dtype)
+    data = tvm.nd.array(np_data, dev)
+    if op == "argsort":
+        func = tvm.get_global_func("tvm.contrib.sort.argsort")
+        out = tvm.nd.array(np.zeros(shape, dtype="int32"), dev)
+        run = lambda: func(data, out, -1, is_ascend)
+    elif op == "sort":
+        func = tvm.get_global_func("tvm.contrib.sort.sort")
+        out = tvm.nd.array(np.zeros(shape, dtype=dtype), dev)
+        run = lambda: func(data, out, -1, is_ascend)
+    else:
+        func = tvm.get_global_func("tvm.contrib.sort.topk")
+        out_shape = shape[:-1] + (k,)
+        values = tvm.nd.array(np.zeros(out_shape, dtype=dtype), dev)
+        indices = tvm.nd.array(np.zeros(out_shape, dtype="int32"), dev)
+        run = lambda: func(data, values, indices, k, -1, "both", is_ascend)
+    np_run = lambda: np.argsort(np_data if is_ascend else -np_data, axis=-1, kind="stable")
+    tvm_mean, tvm_std = evaluate(run, repeat)
+    np_mean, _ = evaluate(np_run, repeat)
+    print(
+        "%-8s %-16s %-8s %-5s %-19s %-10s %.2fx"
+        % (
+            op,
+            "x".join(str(dim) for dim in shape),
+            dtype,
+            k if op == "topk" else "-",
+            "%.3f ms (%.3f ms)" % (tvm_mean, tvm_std),
+            "%.3f ms" % np_mean,
+            np_mean / tvm_mean,
+        )
+    )
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument(
+        "--op", type=str, choices=["argsort", "sort", "topk"], nargs="+", default=None
+    )
+    parser.add_argument(
+        "--dtype",
+        type=str,
+        choices=["float32", "float64", "float16", "int32", "int64"],
+        nargs="+",
+        default=["float32", "float16"],
+    )
+    parser.add_argument("--k", type=int, default=100, help="The k of topk")
+    parser.add_argument("--descend", action="store_true")
+    parser.add_argument("--repeat", type=int, default=20)
+    args = parser.parse_args()
+
+    ops = args.op if args.op is not None else ["argsort", "sort", "topk"]
+    # the shapes of the detection post-processing (few long rows) and of the
+    # batched scores (many short rows)
+    shapes = [(1, 100000), (8, 20000), (256, 1000), (4096, 64)]
+
+    print("-" * 86)
+    print(
+        "%-8s %-16s %-8s %-5s %-19s %-10s %s"
+        % ("Op", "Shape", "Dtype", "K", "TVM (std dev)", "Numpy", "Speedup")
+    )
+    print("-" * 86)
+    for op in ops:
+        for dtype in args.dtype:
+            for shape in shapes:
+                benchmark(op, shape, dtype, args.k, not args.descend, args.repeat)
@@ -55,6 +55,13 @@ class DynWklDispatcherNode : public Object {
   }
   Array<ObjectRef> Dispatch(const int wkl_idx) const;
   State DispatchToState(const int wkl_idx) const;
+  /*!
+   * \brief Predict the latency (in seconds, or in FLOPs if the peak FLOPS of
+   *        the hardware is unknown) of the workload instance. The instance
+   *        does not need to be one of the tuned workload instances, in which
+   *        case the state that adapts best to it is used.
+   */
+  double PredictLatency(const Array<IntImm>& wkl_inst) const;
   // Array<ObjectRef> GetSkeleton() const;
   IRModule GetSkeleton(const String& name) const;
   Array<ObjectRef> GenerateAndCompressIRMods(const String& prefix) const;
@@ -73,6 +80,21 @@ class DynWklDispatcher : public ObjectRef {
   TVM_DEFINE_OBJECT_REF_COW_METHOD(DynWklDispatcherNode);
 };
 
+/*!
+ * \brief Unify the tiles of the static-extent axes (e.g., the I/H axes of the
+ *        weight in a dense layer) across all the dispatched states, so that a
+ *        single packed layout of the layout-free tensors serves every workload
+ *        instance. The tiles are taken from the state that serves the largest
+ *        total instance weight. Only the splits of the axes that index the
+ *        layout-free placeholders are changed. States whose transform steps
+ *        are structurally different from that state, or that exceed the
+ *        hardware limits (threads, vthreads or shared memory per block) with
+ *        the new tiles, are left untouched.
+ * \return The dispatcher with the unified states and the number of states
+ *         that could not be unified (0 means a single packed layout is valid).
+ */
+std::pair<DynWklDispatcher, size_t> UnifyLayoutFreeTiles(const DynWklDispatcher& dispatcher);
+
 
 class DecisionTreeNodeNode : public Object {
  public:
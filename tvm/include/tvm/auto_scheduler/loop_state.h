@@ -55,6 +55,7 @@
 #include <tvm/tir/dyn_shape_var.h>
 
 #include <functional>
+#include <memory>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -229,6 +230,34 @@ class AttachMap : public ObjectRef {
   static void DeleteStageEntry(AttachMapNode* pnode, int stage_id);
 };
 
+/*!
+ * \brief A 128-bit fingerprint of the transform steps of a state, used to deduplicate states.
+ * Unlike `State::ToStr`, it requires neither the bound inference nor the printing of the loop
+ * nest. Two states have the same fingerprint iff they have the same transform steps (with an
+ * overwhelming probability).
+ */
+struct StateFingerprint {
+  uint64_t hi{0};
+  uint64_t lo{0};
+
+  bool operator==(const StateFingerprint& other) const {
+    return hi == other.hi && lo == other.lo;
+  }
+  bool operator!=(const StateFingerprint& other) const { return !(*this == other); }
+};
+
+/*!
+ * \brief The running fingerprint of the transform steps of a state, after each of its steps.
+ * States derived from one another share the prefixes of their steps, hence the fingerprint of a
+ * state is extended from the longest prefix whose steps are unchanged rather than recomputed.
+ */
+struct StateFingerprintCache {
+  /*! \brief The steps that have been folded into the fingerprint. */
+  std::vector<Step> steps;
+  /*! \brief The fingerprint after folding each step, without the closing bracket. */
+  std::vector<StateFingerprint> prefix_fingerprints;
+};
+
 /*!
  * \brief A state in the search process.
  * It consists of the current loop structure and a list of transformation steps used to construct
@@ -257,6 +286,11 @@ class StateNode : public Object {
    * tile sizes of the state is filled. Only concrete state can be apply to TVM schedule.
    */
   bool concrete;
+  /*!
+   * \brief The cache of `State::Fingerprint`, which is shared by the copies of this state and
+   * is replaced (rather than mutated) when the fingerprint is extended.
+   */
+  mutable std::shared_ptr<const StateFingerprintCache> fingerprint_cache;
 
   void VisitAttrs(tvm::AttrVisitor* v) {
     v->Visit("stages", &stages);
@@ -288,6 +322,14 @@ class State : public ObjectRef {
    */
   String ToStr(bool delete_trivial_loop = true) const;
 
+  /*!
+   * \brief Compute the fingerprint of the transform steps. Only the steps after the longest
+   * prefix that is unchanged since the last call (on this state or the state it is copied from)
+   * are folded, hence appending a step costs O(1) serializations.
+   * \return The 128-bit fingerprint.
+   */
+  StateFingerprint Fingerprint() const;
+
   /********** Step APIs working on a single stage **********/
   /*!
    * \brief The schedule primitive corresponding to `te::Stage::bind`.
@@ -489,6 +531,14 @@ struct hash<::tvm::auto_scheduler::State> {
   }
 };
 
+/*! \brief The hash function for auto_scheduler::StateFingerprint. */
+template <>
+struct hash<::tvm::auto_scheduler::StateFingerprint> {
+  std::size_t operator()(const ::tvm::auto_scheduler::StateFingerprint& fingerprint) const {
+    return static_cast<std::size_t>(fingerprint.lo ^ (fingerprint.hi * 0x9e3779b97f4a7c15ULL));
+  }
+};
+
 }  // namespace std
 
 #endif  // TVM_AUTO_SCHEDULER_LOOP_STATE_H_
@@ -477,6 +477,69 @@ class RPCRunner : public ProgramRunner {
   TVM_DEFINE_MUTABLE_OBJECT_REF_METHODS(RPCRunner, ProgramRunner, RPCRunnerNode);
 };
 
+/*!
+ * \brief DistributedRPCRunner that shards the measurement of programs across all the RPC
+ * servers registered in the tracker under a set of device keys.
+ * The programs are dispatched to the device key with the lowest live queue depth, the results
+ * are streamed back as soon as they arrive, and a run that loses its RPC server is retried on
+ * another one.
+ */
+class DistributedRPCRunnerNode : public ProgramRunnerNode {
+ public:
+  /*! \brief The keys of the devices registered in the RPC tracker. */
+  Array<String> keys;
+  /*! \brief The host address of the RPC Tracker. */
+  String host;
+  /*! \brief The port of the RPC Tracker. */
+  int port;
+  /*! \brief The priority of this run request, larger is more prior. */
+  int priority;
+  /*! \brief The number of tasks run in parallel on each RPC server. */
+  int n_parallel;
+  /*! \brief The maximum number of times a run is retried after losing its RPC server. */
+  int max_retries;
+  /*! \brief The function called with (index, input, result) as each result arrives. */
+  PackedFunc on_result;
+
+  Array<MeasureResult> Run(const Array<MeasureInput>& inputs,
+                           const Array<BuildResult>& build_results, int verbose) final;
+
+  static constexpr const char* _type_key = "auto_scheduler.DistributedRPCRunner";
+  TVM_DECLARE_FINAL_OBJECT_INFO(DistributedRPCRunnerNode, ProgramRunnerNode);
+};
+
+/*!
+ * \brief Managed reference to DistributedRPCRunnerNode.
+ * \sa DistributedRPCRunnerNode
+ */
+class DistributedRPCRunner : public ProgramRunner {
+ public:
+  /*!
+   * \brief The constructor. See the corresponding class in python/tvm/auto_scheduler/measure.py
+   * for more detailed parameter explanation.
+   * \param keys The keys of the devices registered in the RPC tracker.
+   * \param host The host address of the RPC Tracker.
+   * \param port The port of RPC Tracker.
+   * \param priority The priority of this run request, larger is more prior.
+   * \param n_parallel The number of tasks run in parallel on each RPC server.
+   * \param timeout Timeout of a run.
+   * \param number The number of times to run the generated code for taking average.
+   * \param repeat The number of times to repeat the measurement.
+   * \param min_repeat_ms The minimum duration of one repeat in milliseconds.
+   * \param cooldown_interval The cool down interval between two measurements.
+   * \param enable_cpu_cache_flush Whether to flush cache on CPU between repeated measurements.
+   * \param max_retries The maximum number of retries after losing an RPC server.
+   * \param on_result The function called as each result arrives (can be null).
+   */
+  DistributedRPCRunner(const Array<String>& keys, const String& host, int port, int priority,
+                       int n_parallel, int timeout, int number, int repeat, int min_repeat_ms,
+                       double cooldown_interval, bool enable_cpu_cache_flush, int max_retries,
+                       PackedFunc on_result);
+
+  TVM_DEFINE_MUTABLE_OBJECT_REF_METHODS(DistributedRPCRunner, ProgramRunner,
+                                        DistributedRPCRunnerNode);
+};
+
 /*!
  * \brief Measurer that measures the time costs of tvm programs
  * This class combines ProgramBuilder and ProgramRunner, and provides a simpler API */
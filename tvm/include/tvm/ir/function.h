@@ -78,6 +78,11 @@ class BaseFuncNode : public RelayExprNode {
  public:
   /*! \brief Additional attributes storing the meta-data */
   DictAttrs attrs;
+  /*!
+   * \brief The structural hash value cached by MemoizedStructuralHash.
+   * \note It is not visited, and is reset whenever the function is copied or mutated.
+   */
+  mutable StructuralHashCache shash_cache_;
 
   /*!
    * \brief Get a function attribute.
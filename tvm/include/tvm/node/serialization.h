@@ -47,5 +47,23 @@ TVM_DLL std::string SaveJSON(const runtime::ObjectRef& node);
  */
 TVM_DLL runtime::ObjectRef LoadJSON(std::string json_str);
 
+/*!
+ * \brief Save the node as well as all the node it depends on in a compact,
+ *        versioned binary format. Compared with SaveJSON, strings are
+ *        interned, integers are stored as varints and arrays are not
+ *        base64-encoded.
+ *
+ * \return The bytes of the node.
+ */
+TVM_DLL std::string SaveBinary(const runtime::ObjectRef& node);
+
+/*!
+ * \brief Load tvm Node object from the bytes produced by SaveBinary.
+ * \param bytes The bytes to load from.
+ *
+ * \return The loaded Node.
+ */
+TVM_DLL runtime::ObjectRef LoadBinary(const std::string& bytes);
+
 }  // namespace tvm
 #endif  // TVM_NODE_SERIALIZATION_H_
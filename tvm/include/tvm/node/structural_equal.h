@@ -91,6 +91,27 @@ class StructuralEqual : public BaseValueEqual {
   TVM_DLL bool operator()(const ObjectRef& lhs, const ObjectRef& rhs) const;
 };
 
+/*!
+ * \brief Structural equality that rejects unequal objects by their memoized
+ *        structural hash values (see MemoizedStructuralHash) before falling
+ *        back to the full structural comparison.
+ *
+ *  This is the companion of MemoizedStructuralHash for hash-consing tables
+ *  whose keys are large, immutable IR nodes.
+ */
+class MemoizedStructuralEqual : public BaseValueEqual {
+ public:
+  // inheritate operator()
+  using BaseValueEqual::operator();
+  /*!
+   * \brief Compare objects via strutural equal.
+   * \param lhs The left operand.
+   * \param rhs The right operand.
+   * \return The comparison result.
+   */
+  TVM_DLL bool operator()(const ObjectRef& lhs, const ObjectRef& rhs) const;
+};
+
 /*!
  * \brief A Reducer class to reduce the structural equality result of two objects.
  *
@@ -26,6 +26,7 @@
 #include <tvm/node/functor.h>
 #include <tvm/runtime/data_type.h>
 
+#include <atomic>
 #include <functional>
 #include <string>
 
@@ -83,6 +84,71 @@ class StructuralHash : public BaseValueHash {
   TVM_DLL size_t operator()(const ObjectRef& key) const;
 };
 
+/*!
+ * \brief The structural hash value that MemoizedStructuralHash caches on a node.
+ *
+ *  A node opts into the memoization by carrying a mutable `shash_cache_` member
+ *  of this type. A copy of the node starts without the cached value, and
+ *  CopyOnWrite resets the value of the node before handing it out for mutation
+ *  (see TVM_DEFINE_OBJECT_REF_COW_METHOD), so that the value never goes stale.
+ */
+class StructuralHashCache {
+ public:
+  StructuralHashCache() = default;
+  StructuralHashCache(const StructuralHashCache&) {}
+  StructuralHashCache& operator=(const StructuralHashCache&) {
+    Reset();
+    return *this;
+  }
+  /*!
+   * \brief Get the cached hash value.
+   * \param value The cached value, untouched if there is none.
+   * \return Whether there is a cached value.
+   */
+  bool Get(size_t* value) const {
+    if (!valid_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    *value = value_.load(std::memory_order_relaxed);
+    return true;
+  }
+  /*! \brief Cache the hash value. */
+  void Set(size_t value) {
+    value_.store(value, std::memory_order_relaxed);
+    valid_.store(true, std::memory_order_release);
+  }
+  /*! \brief Drop the cached hash value. */
+  void Reset() { valid_.store(false, std::memory_order_release); }
+
+ private:
+  std::atomic<size_t> value_{0};
+  std::atomic<bool> valid_{false};
+};
+
+/*!
+ * \brief Structural hashing that caches the hash value on the hashed node.
+ *
+ *  The first call on a function (BaseFuncNode) computes StructuralHash and caches
+ *  the value on the node, subsequent calls on the same node are O(1). Objects of
+ *  the other types are hashed afresh on every call. Functions that are mutated in
+ *  place without CopyOnWrite (e.g., through const_cast) must not be hashed with
+ *  this functor.
+ *
+ *  Only the hash of the root object is cached, because the hash of a sub-tree
+ *  depends on the graph nodes and free variables that precede it in the visit.
+ */
+class MemoizedStructuralHash : public BaseValueHash {
+ public:
+  // inheritate operator()
+  using BaseValueHash::operator();
+  /*!
+   * \brief Compute (or look up) the structural hashing value for an object.
+   * \param key The object to hash.
+   * \return The hash value, identical to that of StructuralHash.
+   */
+  TVM_DLL size_t operator()(const ObjectRef& key) const;
+};
+
 /*!
  * \brief A Reducer class to reduce the structural hash value.
  *
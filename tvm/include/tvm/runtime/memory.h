@@ -25,7 +25,9 @@
 
 #include <tvm/runtime/object.h>
 
+#include <atomic>
 #include <cstdlib>
+#include <new>
 #include <type_traits>
 #include <utility>
 
@@ -47,6 +49,7 @@ inline ObjectPtr<T> make_object(Args&&... args);
 //
 // Possible future allocator optimizations:
 // - Arena allocator that gives ownership of memory to arena (deleter_= nullptr)
+//   (see ArenaObjAllocator, which keeps the deleter so that objects can escape the arena)
 // - Thread-local object pools: one pool per size and alignment requirement.
 // - Can specialize by type of object to give the specific allocator to each object.
 
@@ -191,13 +194,192 @@ class SimpleObjAllocator : public ObjAllocatorBase<SimpleObjAllocator> {
   };
 };
 
+// <efficient>
+/*!
+ * \brief Allocator that bump-allocates objects from reference-counted chunks.
+ *
+ *  Each chunk counts the objects that live in it plus one reference held by the
+ *  allocator while the chunk is being filled. Deleting an object only drops a
+ *  reference on its chunk, and the chunk is freed when the count reaches zero.
+ *  Objects may therefore outlive the allocator (they keep their chunk alive)
+ *  and may be deleted from any thread.
+ *
+ *  The allocator is not used directly. Instead, make_object allocates from the
+ *  allocator of the innermost ObjectArenaScope of the current thread.
+ */
+class ArenaObjAllocator : public ObjAllocatorBase<ArenaObjAllocator> {
+ public:
+  /*! \brief The size of a chunk. */
+  static constexpr size_t kChunkSize = 64 << 10;
+  /*! \brief Objects that are larger than this are allocated on the heap. */
+  static constexpr size_t kMaxObjectSize = kChunkSize / 8;
+  /*! \brief Objects with stricter alignment are allocated on the heap. */
+  static constexpr size_t kMaxAlign = 16;
+
+  ArenaObjAllocator() = default;
+  ArenaObjAllocator(const ArenaObjAllocator&) = delete;
+  ArenaObjAllocator& operator=(const ArenaObjAllocator&) = delete;
+  ~ArenaObjAllocator() {
+    if (chunk_ != nullptr) {
+      DecRef(chunk_);
+    }
+  }
+  /*! \return Whether an object of the given size and alignment can be allocated. */
+  static constexpr bool CanAllocate(size_t size, size_t align) {
+    return size <= kMaxObjectSize && align <= kMaxAlign;
+  }
+  /*! \return The allocator of the innermost ObjectArenaScope of the current thread. */
+  static ArenaObjAllocator*& ThreadLocal() {
+    static thread_local ArenaObjAllocator* inst = nullptr;
+    return inst;
+  }
+
+  template <typename T>
+  class Handler {
+   public:
+    template <typename... Args>
+    static T* New(ArenaObjAllocator* self, Args&&... args) {
+      void* data = self->Allocate(sizeof(T), alignof(T));
+      new (data) T(std::forward<Args>(args)...);
+      return reinterpret_cast<T*>(data);
+    }
+
+    static Object::FDeleter Deleter() { return Deleter_; }
+
+   private:
+    static void Deleter_(Object* objptr) {
+      T* tptr = static_cast<T*>(objptr);
+      tptr->T::~T();
+      Free(tptr);
+    }
+  };
+
+  template <typename ArrayType, typename ElemType>
+  class ArrayHandler {
+   public:
+    static_assert(alignof(ArrayType) % alignof(ElemType) == 0 &&
+                      sizeof(ArrayType) % alignof(ElemType) == 0,
+                  "element alignment constraint");
+
+    template <typename... Args>
+    static ArrayType* New(ArenaObjAllocator* self, size_t num_elems, Args&&... args) {
+      void* data = self->Allocate(RequestedSize(num_elems), alignof(ArrayType));
+      new (data) ArrayType(std::forward<Args>(args)...);
+      return reinterpret_cast<ArrayType*>(data);
+    }
+
+    static size_t RequestedSize(size_t num_elems) {
+      return num_elems * sizeof(ElemType) + sizeof(ArrayType);
+    }
+
+    static Object::FDeleter Deleter() { return Deleter_; }
+
+   private:
+    static void Deleter_(Object* objptr) {
+      ArrayType* tptr = static_cast<ArrayType*>(objptr);
+      tptr->ArrayType::~ArrayType();
+      Free(tptr);
+    }
+  };
+
+ private:
+  /*! \brief Header of a chunk, followed by the objects. */
+  struct alignas(kMaxAlign) Chunk {
+    std::atomic<size_t> ref_counter{1};
+  };
+
+  /*!
+   * \brief Allocate space for an object, preceded by a pointer to its chunk.
+   * \note CanAllocate(size, align) must hold.
+   */
+  void* Allocate(size_t size, size_t align) {
+    if (align < alignof(Chunk*)) {
+      align = alignof(Chunk*);
+    }
+    size_t offset = (offset_ + sizeof(Chunk*) + align - 1) / align * align;
+    if (chunk_ == nullptr || offset + size > kChunkSize) {
+      if (chunk_ != nullptr) {
+        DecRef(chunk_);
+      }
+      chunk_ = new (::operator new(kChunkSize)) Chunk();
+      offset = (sizeof(Chunk) + sizeof(Chunk*) + align - 1) / align * align;
+    }
+    char* data = reinterpret_cast<char*>(chunk_) + offset;
+    *reinterpret_cast<Chunk**>(data - sizeof(Chunk*)) = chunk_;
+    chunk_->ref_counter.fetch_add(1, std::memory_order_relaxed);
+    offset_ = offset + size;
+    return data;
+  }
+
+  static void Free(void* ptr) {
+    DecRef(*reinterpret_cast<Chunk**>(static_cast<char*>(ptr) - sizeof(Chunk*)));
+  }
+
+  static void DecRef(Chunk* chunk) {
+    if (chunk->ref_counter.fetch_sub(1, std::memory_order_release) == 1) {
+      std::atomic_thread_fence(std::memory_order_acquire);
+      chunk->~Chunk();
+      ::operator delete(chunk);
+    }
+  }
+
+  /*! \brief The chunk that is being filled. */
+  Chunk* chunk_{nullptr};
+  /*! \brief The first unused byte of the chunk. */
+  size_t offset_{0};
+};
+
+/*!
+ * \brief RAII scope within which make_object on the current thread allocates
+ *        from an arena rather than from the heap.
+ *
+ *  It is meant for regions that create and discard many short-lived nodes
+ *  (e.g., lowering a candidate schedule for feature extraction). Nodes that
+ *  escape the scope remain valid but keep their whole chunk alive, so the
+ *  scope should not be used where many nodes are retained.
+ *
+ * \code
+ *  {
+ *    ObjectArenaScope arena_scope;
+ *    // nodes created here are arena-allocated
+ *  }
+ * \endcode
+ */
+class ObjectArenaScope {
+ public:
+  ObjectArenaScope() : prev_(ArenaObjAllocator::ThreadLocal()) {
+    ArenaObjAllocator::ThreadLocal() = &allocator_;
+  }
+  ObjectArenaScope(const ObjectArenaScope&) = delete;
+  ObjectArenaScope& operator=(const ObjectArenaScope&) = delete;
+  ~ObjectArenaScope() { ArenaObjAllocator::ThreadLocal() = prev_; }
+
+ private:
+  /*! \brief The allocator of the enclosing scope. */
+  ArenaObjAllocator* prev_;
+  /*! \brief The allocator of this scope. */
+  ArenaObjAllocator allocator_;
+};
+
 template <typename T, typename... Args>
 inline ObjectPtr<T> make_object(Args&&... args) {
+  if (ArenaObjAllocator::CanAllocate(sizeof(T), alignof(T))) {
+    if (ArenaObjAllocator* arena = ArenaObjAllocator::ThreadLocal()) {
+      return arena->make_object<T>(std::forward<Args>(args)...);
+    }
+  }
   return SimpleObjAllocator().make_object<T>(std::forward<Args>(args)...);
 }
 
 template <typename ArrayType, typename ElemType, typename... Args>
 inline ObjectPtr<ArrayType> make_inplace_array_object(size_t num_elems, Args&&... args) {
+  using ArenaHandler = ArenaObjAllocator::ArrayHandler<ArrayType, ElemType>;
+  if (ArenaObjAllocator::CanAllocate(ArenaHandler::RequestedSize(num_elems), alignof(ArrayType))) {
+    if (ArenaObjAllocator* arena = ArenaObjAllocator::ThreadLocal()) {
+      return arena->make_inplace_array<ArrayType, ElemType>(num_elems,
+                                                            std::forward<Args>(args)...);
+    }
+  }
   return SimpleObjAllocator().make_inplace_array<ArrayType, ElemType>(num_elems,
                                                                       std::forward<Args>(args)...);
 }
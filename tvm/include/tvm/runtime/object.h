@@ -775,16 +775,29 @@ struct ObjectPtrEqual {
  *
  * \endcode
  */
-#define TVM_DEFINE_OBJECT_REF_COW_METHOD(ObjectName)     \
-  ObjectName* CopyOnWrite() {                            \
-    ICHECK(data_ != nullptr);                            \
-    if (!data_.unique()) {                               \
-      auto n = make_object<ObjectName>(*(operator->())); \
-      ObjectPtr<Object>(std::move(n)).swap(data_);       \
-    }                                                    \
-    return static_cast<ObjectName*>(data_.get());        \
+#define TVM_DEFINE_OBJECT_REF_COW_METHOD(ObjectName)                                         \
+  ObjectName* CopyOnWrite() {                                                                \
+    ICHECK(data_ != nullptr);                                                                \
+    if (!data_.unique()) {                                                                   \
+      auto n = make_object<ObjectName>(*(operator->()));                                     \
+      ObjectPtr<Object>(std::move(n)).swap(data_);                                           \
+    }                                                                                        \
+    ::tvm::runtime::detail::ResetStructuralHashCache(static_cast<ObjectName*>(data_.get())); \
+    return static_cast<ObjectName*>(data_.get());                                            \
   }
 
+namespace detail {
+/*!
+ * \brief Drop the structural hash value that a node caches (see tvm::StructuralHashCache)
+ *        before it is mutated, no-op for the nodes that do not cache one.
+ */
+template <typename ObjectType>
+inline auto ResetStructuralHashCache(ObjectType* node) -> decltype(node->shash_cache_.Reset()) {
+  node->shash_cache_.Reset();
+}
+inline void ResetStructuralHashCache(...) {}
+}  // namespace detail
+
 // Implementations details below
 // Object reference counting.
 #if TVM_OBJECT_ATOMIC_REF_COUNTER
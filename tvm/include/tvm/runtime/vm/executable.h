@@ -186,6 +186,11 @@ class Executable : public ModuleNode {
   std::unordered_map<std::string, Index> primitive_map;
   /*! \brief The structural hashes of the operators in this function. */
   std::map<Index, Map<String, ObjectRef>> op_attrs;
+  /*!
+   * \brief The attribute in `op_attrs` that marks the packed functions which compute shapes
+   *  (i.e., `vm.shape_func`), the outputs of which only depend on the values of the inputs.
+   */
+  static constexpr const char* kShapeFuncAttr = "vm.shape_func";
   /*! \brief The virtual machine's function table. */
   std::vector<VMFunction> functions;
   /*! \brief The device type for each constant. */
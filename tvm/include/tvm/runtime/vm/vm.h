@@ -33,9 +33,11 @@
 #include <tvm/runtime/vm/executable.h>
 #include <tvm/runtime/vm/memory_manager.h>
 
+#include <list>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -132,6 +134,64 @@ struct VMFrame {
         caller_return_register(0) {}
 };
 
+/*!
+ * \brief A tensor referenced by a step of an execution trace.
+ *
+ * The tensor is either owned by the trace (e.g., an intermediate tensor or a constant), in which
+ * case the replays reuse it, or it aliases one of the inputs of the traced function, in which case
+ * the replays rebind it to the same byte offset of the new input.
+ */
+struct TraceTensor {
+  /*! \brief The tensor seen while recording, which is kept alive for the replays. */
+  NDArray tensor;
+  /*! \brief The index of the aliased input leaf, or -1 if the tensor is owned by the trace. */
+  int input_leaf{-1};
+  /*! \brief The byte offset of the tensor within the aliased input leaf. */
+  int64_t input_offset{0};
+  /*! \brief The tensor handed to the kernels when it aliases an input. */
+  DLTensor rebound;
+};
+
+/*! \brief A step of an execution trace. */
+struct TraceStep {
+  enum Kind {
+    /*! \brief Call a packed function on the tensors. */
+    kCall,
+    /*! \brief Copy the first tensor into the second one. */
+    kCopy,
+    /*!
+     * \brief Check that the tensor (e.g., a shape or a condition that the interpreter branched
+     *  or allocated on) still holds the recorded value, otherwise the trace is not valid.
+     */
+    kGuard,
+  };
+  Kind kind;
+  /*! \brief The index of the packed function of a call. */
+  Index packed_index{-1};
+  /*! \brief The tensors that the step operates on. */
+  std::vector<TraceTensor> tensors;
+  /*! \brief The argument buffers of a call. */
+  std::vector<TVMValue> values;
+  std::vector<int> codes;
+  /*! \brief The recorded bytes of a guard. */
+  std::string expected;
+};
+
+/*!
+ * \brief The flattened execution of a VM function for an input-shape signature, which is the
+ *  sequence of packed function calls with their resolved arguments.
+ */
+struct ExecutionTrace {
+  /*! \brief Whether the trace can be replayed (false marks the untraceable signatures). */
+  bool valid{true};
+  /*! \brief The steps of the trace. */
+  std::vector<TraceStep> steps;
+  /*! \brief The recorded return value, whose structure is copied by the replays. */
+  ObjectRef output;
+  /*! \brief The tensors of the return value, in depth-first order. */
+  std::vector<TraceTensor> output_leaves;
+};
+
 /*!
  * \brief The virtual machine.
  *
@@ -238,6 +298,58 @@ class VirtualMachine : public runtime::ModuleNode {
   virtual void InvokePacked(Index packed_index, const PackedFunc& func, Index arg_count,
                             Index output_size, const std::vector<ObjectRef>& args);
 
+  /*!
+   * \brief Invoke a shape function, the outputs of which are memoized by the values of its
+   *  inputs. Repeated input shapes copy the memoized outputs instead of calling the function.
+   *
+   * \param packed_index The offset of the shape function in all functions.
+   * \param func The shape function to be invoked.
+   * \param arg_count The number of arguments to the shape function.
+   * \param output_size The number of outputs of the shape function.
+   * \param args Arguments to the shape function.
+   */
+  void InvokeShapeFunc(Index packed_index, const PackedFunc& func, Index arg_count,
+                       Index output_size, const std::vector<ObjectRef>& args);
+
+  /*!
+   * \brief Invoke a VM function through the execution trace of its input-shape signature.
+   *  The first invocation of a signature interprets the function while recording the trace,
+   *  and the later ones replay the trace without interpreting the bytecode.
+   *
+   * \param func The function.
+   * \param args The arguments to the function.
+   * \param output The object representing the result.
+   * \return Whether the function has been invoked, false if it has to be interpreted instead
+   *  (e.g., a signature that is not traceable or whose guards fail).
+   */
+  bool InvokeTraced(const VMFunction& func, const std::vector<ObjectRef>& args,
+                    ObjectRef* output);
+
+  /*!
+   * \brief Replay an execution trace.
+   * \param trace The trace.
+   * \param inputs The input leaves of the function.
+   * \return Whether all the guards of the trace passed.
+   */
+  bool ReplayTrace(ExecutionTrace* trace, const std::vector<NDArray>& inputs);
+
+  /*! \brief Bind a tensor seen while recording to the input leaf it aliases, if any. */
+  TraceTensor BindTraceTensor(const NDArray& tensor) const;
+
+  /*! \brief Record a packed function call into the trace being recorded, if any. */
+  void RecordTraceCall(Index packed_index, Index arg_count, Index output_size,
+                       const std::vector<ObjectRef>& args);
+
+  /*! \brief Record a device copy into the trace being recorded, if any. */
+  void RecordTraceCopy(const NDArray& src, const NDArray& dst);
+
+  /*!
+   * \brief Record a guard on the value of a register into the trace being recorded, if any.
+   *  Only the values that the trace may change (i.e., the ones written by the recorded calls or
+   *  aliasing the inputs) are guarded.
+   */
+  void RecordTraceGuard(RegName reg);
+
   /*!
    * \brief Initialize the virtual machine for a set of devices.
    * \param devices The set of TVM devices.
@@ -258,9 +370,20 @@ class VirtualMachine : public runtime::ModuleNode {
    */
   void InvokeGlobal(const VMFunction& func, const std::vector<ObjectRef>& args);
 
+  /*!
+   * \brief Get a packed function by its index. The function is looked up in the kernel
+   *  library on first use, so that loading an executable with many kernels (e.g., the ones
+   *  dispatched over dynamic shapes) does not resolve all of them upfront.
+   * \param packed_index The index of the packed function.
+   * \return The packed function.
+   */
+  const PackedFunc& GetPackedFunc(Index packed_index);
+
  protected:
   /*! \brief The virtual machine's packed function table. */
   std::vector<PackedFunc> packed_funcs_;
+  /*! \brief The names of the packed functions, used to resolve them lazily. */
+  std::vector<std::string> packed_func_names_;
   /*! \brief The current stack of call frames. */
   std::vector<VMFrame> frames_;
   /*! \brief The fuction table index of the current function. */
@@ -284,6 +407,46 @@ class VirtualMachine : public runtime::ModuleNode {
    * object to avoid rellocation of constants during inference.
    */
   std::vector<ObjectRef> const_pool_;
+  /*!
+   * \brief The argument buffers of the packed function calls, which are reused across the calls
+   *  to keep the dispatch of InvokePacked free of allocations.
+   */
+  std::vector<ObjectRef> packed_args_;
+  std::vector<TVMValue> packed_arg_values_;
+  std::vector<int> packed_arg_codes_;
+  /*! \brief The number of packed function calls in flight, for which the buffers are in use. */
+  int packed_call_depth_{0};
+  /*! \brief The LRU cache of the outputs of a shape function, keyed by the input values. */
+  struct ShapeFuncCache {
+    /*! \brief The input key and the outputs, from the most to the least recently used. */
+    using Entry = std::pair<std::string, std::vector<NDArray>>;
+    std::list<Entry> entries;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+  };
+  /*! \brief Whether each packed function is a shape function. */
+  std::vector<bool> is_shape_func_;
+  /*! \brief The shape function caches, indexed by the packed function index. */
+  std::vector<ShapeFuncCache> shape_func_caches_;
+  /*!
+   * \brief The maximum number of entries of each shape function cache (0 disables the caching),
+   *  which can be set through the environment variable TVM_VM_SHAPE_FUNC_CACHE_SIZE.
+   */
+  size_t shape_func_cache_size_{256};
+  /*! \brief The execution traces, keyed by the function and the input-shape signature. */
+  using TraceEntry = std::pair<std::string, ExecutionTrace>;
+  std::list<TraceEntry> traces_;
+  std::unordered_map<std::string, std::list<TraceEntry>::iterator> trace_index_;
+  /*!
+   * \brief The maximum number of traced signatures (0 disables the trace mode), which can be set
+   *  through the packed function set_trace_mode.
+   */
+  size_t trace_cache_size_{0};
+  /*! \brief The trace being recorded, if any. */
+  ExecutionTrace* recording_trace_{nullptr};
+  /*! \brief The input leaves of the trace being recorded. */
+  std::vector<NDArray> trace_inputs_;
+  /*! \brief The addresses of the tensors written by the recorded steps. */
+  std::unordered_set<const void*> trace_written_;
 };
 
 }  // namespace vm
@@ -40,13 +40,17 @@ from .measure import (
     LocalBuilder,
     LocalRunner,
     RPCRunner,
+    DistributedRPCRunner,
     LocalRPCMeasureContext,
+    LocalDistributedMeasureContext,
     register_task_input_check_func,
 )
 from .measure_record import RecordToFile, RecordReader, load_best_record, load_records, save_records
 from .relay_integration import (
     extract_tasks,
     extract_dyn_tasks,  # <bojian/DietCode>
+    tune_parallel_dense,
+    combine_parallel_dense,
     remove_index_check,
     rewrite_compute_body,
     is_auto_scheduler_enabled,
@@ -54,6 +58,10 @@ from .relay_integration import (
 from .search_task import SearchTask, TuningOptions, HardwareParams, create_task, auto_schedule
 
 from .dietcode import DynWklDispatcher, inline_dispatch, \
+                      get_shape_var_degrees, get_shape_var_upper_bounds, select_buckets, \
+                      generate_wkl_insts, \
+                      export_dyn_model, load_dyn_model, HotShapeSpecializer, \
+                      CostModelFusionPolicy, \
                       replace_shape_vars, instantiate_dyn_args, \
                       StateVer, DecisionTreeNode  # <bojian/DietCode>
 
@@ -23,7 +23,7 @@ import json
 
 import tvm._ffi
 from tvm.runtime import Object
-from tvm.runtime._ffi_node_api import LoadJSON, SaveJSON
+from tvm.runtime._ffi_node_api import LoadJSON, SaveJSON, LoadBinary, SaveBinary
 
 from . import _ffi_api
 from .loop_state import State, StateObject
@@ -273,12 +273,15 @@ class ComputeDAG(Object):
         return "\n".join(lines)
 
     def __getstate__(self):
-        return {"tensors": SaveJSON(self.tensors)}
+        return {"tensors": SaveBinary(self.tensors)}
 
     def __setstate__(self, state):
         # Since we always use tensors to recover the ComputeDAG, we do not support
         # (de)serialization of the ComputeDAG constructed by a schedule.
-        self.__init_handle_by_constructor__(_ffi_api.ComputeDAG, LoadJSON(state["tensors"]), None)
+        tensors = state["tensors"]
+        # The states pickled before the binary format are json strings.
+        tensors = LoadJSON(tensors) if isinstance(tensors, str) else LoadBinary(bytearray(tensors))
+        self.__init_handle_by_constructor__(_ffi_api.ComputeDAG, tensors, None)
 
 
 def get_shape_from_rewritten_layout(rewritten_layout, axis_names):
@@ -17,6 +17,8 @@
 
 """ Cost models that estimate the performance of programs """
 import ctypes
+import threading
+
 import numpy as np
 
 import tvm._ffi
@@ -92,16 +94,25 @@ def _wrap_ptr_as_np_array(ptr, shape):
 
 @tvm._ffi.register_object("auto_scheduler.PythonBasedModel")
 class PythonBasedModel(CostModel):
-    """Base class for cost models implemented in python"""
+    """Base class for cost models implemented in python
+
+    The model can be shared by the policies whose search phases run on separate threads
+    (see `TaskScheduler.tune` with `num_concurrent_tasks > 1`), hence the updates and the
+    predictions issued through the C++ interface are serialized.
+    """
 
     def __init__(self):
+        lock = threading.Lock()
+
         def update_func(inputs, results):
-            self.update(inputs, results)
+            with lock:
+                self.update(inputs, results)
 
         def predict_func(task, states, return_ptr):
             return_ptr = ctypes.cast(return_ptr, ctypes.POINTER(ctypes.c_float))
             array_wrapper = np.ctypeslib.as_array(return_ptr, shape=(len(states),))
-            array_wrapper[:] = self.predict(task, states)
+            with lock:
+                array_wrapper[:] = self.predict(task, states)
 
         # <bojian/DietCode>
         def predict_for_all_instances_func(task, states, occupancy_penalty_ptr,
@@ -113,8 +124,9 @@ class PythonBasedModel(CostModel):
             padding_penalty_np_arr = \
                     _wrap_ptr_as_np_array(padding_penalty_ptr, scores_shape)
             scores_np_arr = _wrap_ptr_as_np_array(scores_ptr, scores_shape)
-            occupancy_penalty_np_arr[:], padding_penalty_np_arr[:], \
-                    scores_np_arr[:] = self.predict_for_all_instances(task, states)
+            with lock:
+                occupancy_penalty_np_arr[:], padding_penalty_np_arr[:], \
+                        scores_np_arr[:] = self.predict_for_all_instances(task, states)
 
         # <bojian/DietCode>
         def score_func(task, num_states, scores_ptr, weights_ptr,
@@ -149,7 +161,8 @@ class PythonBasedModel(CostModel):
 
 
         def predict_stage_func(task, states, return_ptr):
-            ret = self.predict_stages(task, states)
+            with lock:
+                ret = self.predict_stages(task, states)
             return_ptr = ctypes.cast(return_ptr, ctypes.POINTER(ctypes.c_float))
             array_wrapper = np.ctypeslib.as_array(return_ptr, shape=ret.shape)
             array_wrapper[:] = ret
@@ -1,12 +1,39 @@
+import itertools
+import logging
+
 import tvm
 
 from tvm.runtime import Object
 from . import _ffi_api
+from .loop_state import StateObject
+
+logger = logging.getLogger("auto_scheduler")
 
 
 # <bojian/DietCode>
 @tvm._ffi.register_object("auto_scheduler.DynWklDispatcher")
 class DynWklDispatcher(Object):
+    """The dispatcher of a dynamic-shape workload, which maps every workload
+    instance of the search task to one of the tuned states.
+
+    Parameters
+    ----------
+    search_task : SearchTask
+        The dynamic-shape search task.
+    states : List[State]
+        The tuned states.
+    inst_disp_map : Dict[int, int]
+        The index of the state that each workload instance is dispatched to.
+    """
+
+    def __init__(self, search_task, states, inst_disp_map):
+        self.__init_handle_by_constructor__(
+            _ffi_api.DynWklDispatcher,
+            search_task,
+            [state if isinstance(state, StateObject) else state.state_object
+             for state in states],
+            inst_disp_map,
+        )
 
     def dispatch(self, shape_tuple):
         sched, in_args = _ffi_api.DispatcherDispatch(
@@ -15,8 +42,12 @@ class DynWklDispatcher(Object):
         return sched, in_args
 
     def dispatch_to_state(self, shape_tuple):
+        """Dispatch the shape to a state. Shapes that are not tuned are rounded
+        up to the smallest covering workload instance (i.e., bucket), the state
+        of which handles the padding through its boundary checks.
+        """
         return _ffi_api.DispatcherDispatchToState(
-                   self, self._find_wkl_id(shape_tuple)
+                   self, self._find_wkl_id(shape_tuple, round_up=True)
                )
 
     @property
@@ -27,15 +58,28 @@ class DynWklDispatcher(Object):
     def inst_disp_map(self):
         return _ffi_api.DispatcherInstDispMap(self)
 
-    def _find_wkl_id(self, shape_tuple):
+    def _find_wkl_id(self, shape_tuple, round_up=False):
         from tvm.ir import Array
 
         if isinstance(shape_tuple, Array):
             shape_tuple = tuple([int(v) for v in list(shape_tuple)])
-        for i, wkl_inst in enumerate(list(self.search_task.wkl_insts)):
-            wkl_inst = tuple([int(v) for v in list(wkl_inst)])
+        wkl_insts = [tuple([int(v) for v in list(wkl_inst)])
+                     for wkl_inst in list(self.search_task.wkl_insts)]
+        for i, wkl_inst in enumerate(wkl_insts):
             if wkl_inst == shape_tuple:
                 return i
+        if round_up:
+            # Pick the smallest bucket that covers the shape, where the size
+            # of a bucket accounts for the tied shape variables.
+            degrees = get_shape_var_degrees(self.search_task)
+            covering_wkl_ids = [i for i, wkl_inst in enumerate(wkl_insts)
+                                if all([b >= v for b, v in zip(wkl_inst, shape_tuple)])]
+            if covering_wkl_ids:
+                wkl_id = min(covering_wkl_ids,
+                             key=lambda i: _get_bucket_volume(wkl_insts[i], degrees))
+                logger.info("%s has not been tuned and is dispatched to the bucket %s",
+                            shape_tuple, wkl_insts[wkl_id])
+                return wkl_id
         assert False, "{} not found".format(shape_tuple)
 
     def get_skeleton(self, name):
@@ -44,6 +88,334 @@ class DynWklDispatcher(Object):
     def embed_compute_dag(self, compute_dag):
         return _ffi_api.DispatcherEmbedComputeDAG(self, compute_dag)
 
+    def matches(self, io_tensors):
+        """Whether a compute with dynamic shapes (e.g., from a Relay function
+        with `relay.Any` dimensions) is the workload of the search task, i.e.,
+        whether the computes have the same tags and their I/O tensors have the
+        same dtypes and static dimensions, with every shape variable mapped to
+        one symbolic dimension consistently.
+
+        Parameters
+        ----------
+        io_tensors : List[Tensor]
+            The input and output tensors of the compute.
+
+        Returns
+        -------
+        matched : bool
+            Whether the compute matches the search task.
+        """
+        tensors = list(self.search_task.compute_dag.tensors)
+        if len(tensors) != len(io_tensors) or \
+           _get_compute_op_tags(tensors) != _get_compute_op_tags(io_tensors):
+            return False
+        bound_dims = {}
+        for tensor, io_tensor in zip(tensors, io_tensors):
+            if tensor.dtype != io_tensor.dtype or len(tensor.shape) != len(io_tensor.shape):
+                return False
+            for dim, io_dim in zip(tensor.shape, io_tensor.shape):
+                if isinstance(dim, tvm.tir.DynShapeVar):
+                    if isinstance(io_dim, tvm.tir.IntImm):
+                        return False
+                    if not bound_dims.setdefault(dim.name, io_dim).same_as(io_dim):
+                        return False
+                elif not isinstance(io_dim, tvm.tir.IntImm) or int(dim) != int(io_dim):
+                    return False
+        return len(set(dim.handle.value for dim in bound_dims.values())) == len(bound_dims)
+
+    def match_instance(self, io_tensors):
+        """Get the workload instance that a compute with static shapes (e.g.,
+        from a Relay function specialized to its input shapes) instantiates,
+        i.e., the values of the shape variables if the computes have the same
+        tags and their I/O tensors have the same dtypes and static dimensions,
+        with every shape variable mapped to one value consistently.
+
+        Parameters
+        ----------
+        io_tensors : List[Tensor]
+            The input and output tensors of the compute.
+
+        Returns
+        -------
+        wkl_inst : Optional[Tuple[int, ...]]
+            The values of the shape variables, or None if the compute is not an
+            instance of the search task.
+        """
+        tensors = list(self.search_task.compute_dag.tensors)
+        if len(tensors) != len(io_tensors) or \
+           _get_compute_op_tags(tensors) != _get_compute_op_tags(io_tensors):
+            return None
+        bound_values = {}
+        for tensor, io_tensor in zip(tensors, io_tensors):
+            if tensor.dtype != io_tensor.dtype or len(tensor.shape) != len(io_tensor.shape):
+                return None
+            for dim, io_dim in zip(tensor.shape, io_tensor.shape):
+                if not isinstance(io_dim, tvm.tir.IntImm):
+                    return None
+                if isinstance(dim, tvm.tir.DynShapeVar):
+                    if bound_values.setdefault(dim.name, int(io_dim)) != int(io_dim):
+                        return None
+                elif not isinstance(dim, tvm.tir.IntImm) or int(dim) != int(io_dim):
+                    return None
+        shape_var_names = [shape_var.name for shape_var in self.search_task.shape_vars]
+        if any([name not in bound_values for name in shape_var_names]):
+            return None
+        return tuple([bound_values[name] for name in shape_var_names])
+
+    def predict_latency(self, shape_tuple):
+        """Predict the latency of a workload instance using the dispatched
+        states. The instance needs not be one of the tuned ones.
+
+        Parameters
+        ----------
+        shape_tuple : Tuple[int]
+            The values of the shape variables.
+
+        Returns
+        -------
+        latency : float
+            The predicted latency (in seconds, or in FLOPs if the peak FLOPS
+            of the hardware is unknown).
+        """
+        from tvm.tir import IntImm
+
+        return float(_ffi_api.DispatcherPredictLatency(
+                         self, [IntImm("int32", int(v)) for v in shape_tuple]
+                     ))
+
+    def unify_layout_free_tiles(self):
+        """Unify the tiles of the static-extent axes across all the dispatched
+        states, so that the layout-free tensors (e.g., the weights) can be
+        packed once into a layout that is shared by every workload instance.
+
+        Returns
+        -------
+        dispatcher : DynWklDispatcher
+            The dispatcher with the unified states.
+        is_unified : bool
+            Whether all the states have been unified. If False, there is no
+            single packed layout that is valid for all the states.
+        """
+        dispatcher, num_incompatible_states = \
+                _ffi_api.DispatcherUnifyLayoutFreeTiles(self)
+        return dispatcher, int(num_incompatible_states) == 0
+
+
+def _get_compute_op_tags(tensors):
+    """Get the sorted tags of all the compute operators that the tensors depend on."""
+    tags, visited = [], set()
+
+    def _traverse(tensor):
+        if tensor.op.handle.value in visited:
+            return
+        visited.add(tensor.op.handle.value)
+        if isinstance(tensor.op, tvm.te.ComputeOp):
+            tags.append(tensor.op.tag)
+        for input_tensor in tensor.op.input_tensors:
+            _traverse(input_tensor)
+
+    for tensor in tensors:
+        _traverse(tensor)
+    return sorted(tags)
+
+
+def get_shape_var_degrees(search_task):
+    """Get the number of output axes that each shape variable appears in. A
+    shape variable that is tied to several axes (e.g., T in the TxT attention
+    scores of `batch_matmul`) has a degree larger than 1, and padding it wastes
+    compute polynomially rather than linearly.
+
+    Returns
+    -------
+    degrees : Tuple[int]
+        The degree of every shape variable of the search task.
+    """
+    return _get_shape_var_degrees(search_task.compute_dag, search_task.shape_vars)
+
+
+def _get_shape_var_degrees(compute_dag, shape_vars):
+    from tvm.tir import DynShapeVar
+    from tvm.tir.stmt_functor import post_order_visit
+
+    shape_var_names = [shape_var.name for shape_var in shape_vars]
+    degrees = [0 for _ in shape_var_names]
+    for axis in compute_dag.tensors[-1].shape:
+        visited_names = set()
+
+        def _visit(node):
+            if isinstance(node, DynShapeVar):
+                visited_names.add(node.name)
+
+        post_order_visit(axis, _visit)
+        for name in visited_names:
+            degrees[shape_var_names.index(name)] += 1
+    return tuple([max(degree, 1) for degree in degrees])
+
+
+def get_shape_var_upper_bounds(search_tasks):
+    """Get the upper bounds of the shape variables over the workload instances
+    of the search tasks, which allow the graph and AOT executors to statically
+    plan the tensors w/ dynamic shapes at their upper bounds, e.g.,
+
+    .. code-block:: python
+
+        with tvm.transform.PassContext(config={
+                 "relay.backend.DynShape": {
+                     "shape_var_upper_bounds": get_shape_var_upper_bounds(tasks)}}):
+            lib = relay.build(mod, target)
+
+    Parameters
+    ----------
+    search_tasks : List[SearchTask]
+        The (dynamic) search tasks.
+
+    Returns
+    -------
+    upper_bounds : Dict[str, int]
+        The upper bound of every shape variable, indexed by its name.
+    """
+    upper_bounds = {}
+    for search_task in search_tasks:
+        if not search_task.shape_vars:
+            continue
+        for i, shape_var in enumerate(search_task.shape_vars):
+            upper_bound = max([int(wkl_inst[i]) for wkl_inst in search_task.wkl_insts])
+            upper_bounds[shape_var.name] = \
+                    max(upper_bounds.get(shape_var.name, 0), upper_bound)
+    return upper_bounds
+
+
+def _get_bucket_volume(wkl_inst, degrees):
+    volume = 1
+    for value, degree in zip(wkl_inst, degrees):
+        volume *= value ** degree
+    return volume
+
+
+def select_buckets(shape_value_freqs, num_buckets, degree=1):
+    """Select the buckets of a shape variable that minimize the expected
+    padding waste. A value `v` dispatched to bucket `b >= v` wastes
+    `b ** degree - v ** degree` of compute, hence tied shape variables
+    (`degree > 1`, see `get_shape_var_degrees`) favor finer buckets for the
+    large values.
+
+    Parameters
+    ----------
+    shape_value_freqs : Dict[int, float]
+        The frequency of every value of the shape variable.
+    num_buckets : int
+        The maximum number of buckets.
+    degree : int
+        The degree of the shape variable.
+
+    Returns
+    -------
+    buckets : List[int]
+        The (sorted) upper bounds of the buckets, all of which are observed values.
+    """
+    values = sorted(shape_value_freqs.keys())
+    freqs = [shape_value_freqs[v] for v in values]
+    num_values = len(values)
+    num_buckets = min(num_buckets, num_values)
+    if num_buckets == 0:
+        return []
+
+    # prefix sums of the frequencies and of the frequency-weighted volumes
+    freq_prefix_sums, volume_prefix_sums = [0.], [0.]
+    for value, freq in zip(values, freqs):
+        freq_prefix_sums.append(freq_prefix_sums[-1] + freq)
+        volume_prefix_sums.append(volume_prefix_sums[-1] + freq * value ** degree)
+
+    def _waste(i, j):
+        # the waste of dispatching values[i..j] to the bucket values[j]
+        return values[j] ** degree * (freq_prefix_sums[j + 1] - freq_prefix_sums[i]) - \
+               (volume_prefix_sums[j + 1] - volume_prefix_sums[i])
+
+    inf = float("inf")
+    # cost[b][j]: the minimum waste of covering values[0..j] with b+1 buckets
+    cost = [[inf] * num_values for _ in range(num_buckets)]
+    prev = [[-1] * num_values for _ in range(num_buckets)]
+    for j in range(num_values):
+        cost[0][j] = _waste(0, j)
+    for b in range(1, num_buckets):
+        for j in range(b, num_values):
+            for i in range(b - 1, j):
+                candidate_cost = cost[b - 1][i] + _waste(i + 1, j)
+                if candidate_cost < cost[b][j]:
+                    cost[b][j], prev[b][j] = candidate_cost, i
+    b = min(range(num_buckets), key=lambda b: cost[b][num_values - 1])
+    buckets, j = [], num_values - 1
+    while b >= 0:
+        buckets.append(values[j])
+        j = prev[b][j]
+        b -= 1
+    return sorted(buckets)
+
+
+def generate_wkl_insts(func, args, shape_vars, shape_value_freqs, num_buckets):
+    """Generate the workload instances of a dynamic-shape workload from the
+    observed values of its shape variables. The values of every shape variable
+    are grouped into buckets by `select_buckets`, with its degree in the
+    workload (see `get_shape_var_degrees`), and the workload instances are the
+    combinations of the buckets.
+
+    .. code-block:: python
+
+        wkl_insts, wkl_inst_weights = generate_wkl_insts(
+            BatchMatmulNT, (192, T, T, 64), (T,), [{5: 10, 17: 3, 120: 1}], 8)
+        task = SearchTask(func=BatchMatmulNT, args=(192, T, T, 64), shape_vars=(T,),
+                          wkl_insts=wkl_insts, wkl_inst_weights=wkl_inst_weights,
+                          target=target)
+
+    Parameters
+    ----------
+    func : Union[Function, str]
+        The workload function.
+    args : Tuple
+        The arguments of the workload function, including the shape variables.
+    shape_vars : Tuple[DynShapeVar]
+        The shape variables.
+    shape_value_freqs : List[Dict[int, float]]
+        The frequency of every observed value of each shape variable.
+    num_buckets : Union[int, List[int]]
+        The maximum number of buckets of (each) shape variable.
+
+    Returns
+    -------
+    wkl_insts : List[Tuple[int]]
+        The workload instances.
+    wkl_inst_weights : List[float]
+        The total frequency of the values that each workload instance covers,
+        assuming that the shape variables are independent.
+    """
+    # pylint: disable=import-outside-toplevel
+    from .compute_dag import ComputeDAG
+    from .workload_registry import make_workload_key
+
+    assert len(shape_vars) == len(shape_value_freqs)
+    if isinstance(num_buckets, int):
+        num_buckets = [num_buckets for _ in shape_vars]
+    degrees = _get_shape_var_degrees(ComputeDAG(make_workload_key(func, args)), shape_vars)
+
+    shape_var_buckets = []
+    for value_freqs, var_num_buckets, degree in zip(shape_value_freqs, num_buckets, degrees):
+        buckets = select_buckets(value_freqs, var_num_buckets, degree)
+        total_freq = sum(value_freqs.values())
+        bucket_weights = [0. for _ in buckets]
+        for value, freq in value_freqs.items():
+            bucket_weights[min([i for i, b in enumerate(buckets) if b >= value])] += \
+                    freq / total_freq
+        shape_var_buckets.append(list(zip(buckets, bucket_weights)))
+
+    wkl_insts, wkl_inst_weights = [], []
+    for bucket_combination in itertools.product(*shape_var_buckets):
+        wkl_insts.append(tuple([bucket for bucket, _ in bucket_combination]))
+        weight = 1.
+        for _, bucket_weight in bucket_combination:
+            weight *= bucket_weight
+        wkl_inst_weights.append(weight)
+    return wkl_insts, wkl_inst_weights
+
 
 # def inline_dispatch(skeleton_mod_host, merged_mod_dev, dyn_wkl_dispatcher):
 #     return _ffi_api.InlineDispatch(skeleton_mod_host, merged_mod_dev,
@@ -89,3 +461,382 @@ class DecisionTreeNode(Object):
                 else_node,
                 state_ver
                 )
+
+
+def export_dyn_model(mod, params, target, records, path, target_host=None, opt_level=3):
+    """Compile a model tuned for dynamic shapes into a single deployable library.
+
+    The dispatchers in the tuning records are resolved at compile time, so the
+    library contains all the dispatched kernels together with their dispatching
+    decision trees. It can be loaded by the C++ runtime alone (e.g., through
+    `tvm::runtime::Module::LoadFromFile` followed by the VM), without the tuner,
+    the tuning records or `DIETCODE_SCHED_LOG_DIR`.
+
+    Parameters
+    ----------
+    mod : tvm.IRModule
+        The Relay module with dynamic shapes.
+    params : Dict[str, tvm.nd.NDArray]
+        The model parameters.
+    target : Union[tvm.target.Target, str]
+        The compilation target.
+    records : Union[str, Tuple]
+        The tuning records (or the file that stores them) with the dispatchers.
+    path : str
+        The path of the exported library.
+    target_host : Optional[Union[tvm.target.Target, str]]
+        The host compilation target.
+    opt_level : int
+        The optimization level of the Relay build.
+    """
+    # pylint: disable=import-outside-toplevel
+    from tvm import relay
+    from .dispatcher import ApplyHistoryBest
+
+    with ApplyHistoryBest(records):
+        with tvm.transform.PassContext(opt_level=opt_level,
+                                       config={"relay.backend.use_auto_scheduler": True}):
+            vm_exec = relay.vm.compile(mod, target=target, target_host=target_host,
+                                       params=params)
+    vm_exec.mod.export_library(path)
+
+
+def load_dyn_model(path, dev):
+    """Load a library exported by `export_dyn_model`.
+
+    Parameters
+    ----------
+    path : str
+        The path of the exported library.
+    dev : tvm.runtime.Device
+        The device to run the model on.
+
+    Returns
+    -------
+    vm : tvm.runtime.vm.VirtualMachine
+        The virtual machine that runs the model.
+    load_time : float
+        The start-up time (in seconds), i.e., the time of loading the library
+        and initializing the virtual machine. The kernels are resolved lazily
+        on their first invocation, and hence are not part of it.
+    """
+    # pylint: disable=import-outside-toplevel
+    import time
+    from tvm.runtime import vm as _vm
+
+    start = time.perf_counter()
+    vm_exec = tvm.runtime.load_module(path)
+    vm = _vm.VirtualMachine(vm_exec, dev)
+    return vm, time.perf_counter() - start
+
+
+class HotShapeSpecializer:
+    """Run a model tuned for dynamic shapes, while specializing its hot shapes.
+
+    Every request first runs through the generic virtual machine, whose
+    kernels are dispatched over the shapes at runtime. The specializer tracks
+    the input-shape signatures of the recent requests. For each signature that
+    dominates the traffic, it builds a fully static module in a background
+    thread. The module is built from the model with its inputs bound to the
+    concrete shapes and `DynamicToStatic` applied, and its kernels use the
+    tuned per-instance states of the dispatchers (whose dispatch context is
+    local to the background thread). The module is then swapped
+    into the request path of that signature. The signatures whose static build
+    fails (e.g., because of control flow) stay on the virtual machine.
+
+    Parameters
+    ----------
+    mod : tvm.IRModule
+        The Relay module with dynamic shapes.
+    params : Dict[str, tvm.nd.NDArray]
+        The model parameters.
+    target : Union[tvm.target.Target, str]
+        The compilation target.
+    records : Union[str, Tuple]
+        The tuning records (or the file that stores them) with the dispatchers.
+    dev : tvm.runtime.Device
+        The device to run the model on.
+    target_host : Optional[Union[tvm.target.Target, str]]
+        The host compilation target.
+    opt_level : int
+        The optimization level of the Relay build.
+    vm : Optional[tvm.runtime.vm.VirtualMachine]
+        The generic virtual machine (e.g., from `load_dyn_model`), which is
+        compiled from the model if not given.
+    window : int
+        The number of recent requests over which the traffic is tracked.
+    hot_ratio : float
+        The fraction of the recent requests above which a signature is hot.
+    min_count : int
+        The number of recent requests below which a signature is never hot.
+    max_num_specialized : int
+        The maximum number of signatures to specialize, including the ones
+        whose build fails.
+    """
+
+    def __init__(self, mod, params, target, records, dev, target_host=None, opt_level=3,
+                 vm=None, window=1024, hot_ratio=0.1, min_count=32, max_num_specialized=8):
+        # pylint: disable=import-outside-toplevel
+        import collections
+        import concurrent.futures
+        import threading
+        from tvm import relay
+        from tvm.runtime import vm as _vm
+        from .dispatcher import ApplyHistoryBest
+
+        self._mod = mod
+        self._params = params if params is not None else {}
+        self._target = target
+        self._target_host = target_host
+        self._records = records
+        self._dev = dev
+        self._opt_level = opt_level
+        self._hot_ratio = hot_ratio
+        self._min_count = min_count
+        self._max_num_specialized = max_num_specialized
+        # the inputs of the model are the parameters that are not bound to the weights
+        self._input_names = [param.name_hint for param in mod["main"].params
+                             if param.name_hint not in self._params]
+        if vm is None:
+            with ApplyHistoryBest(records):
+                with tvm.transform.PassContext(opt_level=opt_level,
+                                               config={"relay.backend.use_auto_scheduler": True}):
+                    vm_exec = relay.vm.compile(mod, target=target, target_host=target_host,
+                                               params=self._params)
+            vm = _vm.VirtualMachine(vm_exec, dev)
+        self._vm = vm
+
+        self._recent = collections.deque()
+        self._window = window
+        self._counts = collections.Counter()
+        # signature -> graph module, which is replaced as a whole on every swap
+        self._specialized = {}
+        # the signatures that are being built, or whose build failed
+        self._attempted = set()
+        self._lock = threading.Lock()
+        self._builder = concurrent.futures.ThreadPoolExecutor(max_workers=1)
+        self._pending = []
+
+    @staticmethod
+    def _get_signature(inputs):
+        return tuple((tuple(int(dim) for dim in data.shape), str(data.dtype)) for data in inputs)
+
+    def _track(self, signature):
+        self._recent.append(signature)
+        self._counts[signature] += 1
+        if len(self._recent) > self._window:
+            evicted = self._recent.popleft()
+            self._counts[evicted] -= 1
+            if self._counts[evicted] == 0:
+                del self._counts[evicted]
+        count = self._counts[signature]
+        if count < self._min_count or count < self._hot_ratio * len(self._recent):
+            return
+        with self._lock:
+            if signature in self._attempted or \
+                    len(self._attempted) >= self._max_num_specialized:
+                return
+            self._attempted.add(signature)
+        self._pending.append(self._builder.submit(self._specialize, signature))
+
+    def _specialize(self, signature):
+        """Build the static module of a signature and swap it into the request path."""
+        # pylint: disable=import-outside-toplevel
+        import logging
+        from tvm import relay
+        from tvm.contrib import graph_executor
+        from .dispatcher import ApplyHistoryBest
+
+        try:
+            func = self._mod["main"]
+            shapes = dict(zip(self._input_names, signature))
+            binds, new_params = {}, []
+            for param in func.params:
+                if param.name_hint in shapes:
+                    shape, dtype = shapes[param.name_hint]
+                    new_param = relay.var(param.name_hint, shape=shape, dtype=dtype)
+                    binds[param] = new_param
+                    param = new_param
+                new_params.append(param)
+            mod = tvm.IRModule(self._mod.functions, self._mod.type_definitions)
+            mod["main"] = relay.Function(new_params, relay.bind(func.body, binds),
+                                         attrs=func.attrs)
+            mod = relay.transform.InferType()(mod)
+            mod = relay.transform.DynamicToStatic()(mod)
+            with ApplyHistoryBest(self._records):
+                with tvm.transform.PassContext(opt_level=self._opt_level,
+                                               config={"relay.backend.use_auto_scheduler": True}):
+                    lib = relay.build(mod, target=self._target, target_host=self._target_host,
+                                      params=self._params)
+            module = graph_executor.GraphModule(lib["default"](self._dev))
+        except Exception:  # pylint: disable=broad-except
+            logging.getLogger("auto_scheduler").warning(
+                "Unable to specialize the model for the input shapes %s", signature,
+                exc_info=True)
+            return
+        with self._lock:
+            specialized = dict(self._specialized)
+            specialized[signature] = module
+            self._specialized = specialized
+
+    def run(self, *inputs):
+        """Run the model on the inputs. Like the virtual machine, the runs must
+        not be issued concurrently.
+
+        Parameters
+        ----------
+        inputs : List[Union[np.ndarray, tvm.nd.NDArray]]
+            The inputs of the model, in the order of its parameters.
+
+        Returns
+        -------
+        outputs : List[tvm.nd.NDArray]
+            The outputs of the model.
+        """
+        signature = self._get_signature(inputs)
+        self._track(signature)
+        module = self._specialized.get(signature)
+        if module is None:
+            outputs = self._vm.run(*inputs)
+            if isinstance(outputs, tvm.nd.NDArray):
+                return [outputs]
+            return list(outputs)
+        for name, data in zip(self._input_names, inputs):
+            module.set_input(name, data)
+        module.run()
+        # copy the outputs, which the next run of the module overwrites
+        return [module.get_output(i).copyto(self._dev) for i in range(module.get_num_outputs())]
+
+    @property
+    def specialized_signatures(self):
+        """The input-shape signatures that have been specialized."""
+        return list(self._specialized.keys())
+
+    def wait(self):
+        """Wait for the pending specializations to be swapped in."""
+        for future in self._pending:
+            future.result()
+        self._pending = []
+
+    def close(self):
+        """Stop the background specialization."""
+        self._builder.shutdown(wait=True)
+
+
+class CostModelFusionPolicy:
+    """Decide whether to fuse the OutEWiseFusable ops (e.g., dense) with their
+    elementwise tails by the estimated latency of the fused kernel against
+    the unfused ones, in place of the fixed rules of `FuseOps`.
+
+    The policy is enabled through the config of the pass context, e.g.,
+
+    .. code-block:: python
+
+        policy = auto_scheduler.CostModelFusionPolicy(target, dispatchers)
+        with tvm.transform.PassContext(opt_level=3, config=policy.config):
+            lib = relay.build(mod, target=target, params=params)
+
+    The latency of a kernel is predicted by the dispatcher whose search task
+    its compute matches, either at the workload instance of a static compute
+    or weighted over the workload instances of the search task. The kernels
+    that no dispatcher matches are estimated by `estimate`. A candidate is
+    fused as by the fixed rules unless all of the fused kernel, the anchor
+    and the tail have their latencies estimated. Since the elementwise tails
+    are rarely tuned as tasks of their own, the dispatchers alone seldom
+    reject a fusion, and `estimate` is expected to cover such kernels (e.g.,
+    through the learned cost model).
+
+    Parameters
+    ----------
+    target : Union[tvm.target.Target, str]
+        The compilation target.
+    dispatchers : Optional[List[DynWklDispatcher]]
+        The dispatchers of the tuned tasks.
+    estimate : Optional[Callable[[tvm.relay.Function], Optional[float]]]
+        The function that estimates the latency of a primitive function that
+        no dispatcher matches, or returns None if it cannot.
+    name : str
+        The name of the global function that the pass calls.
+    """
+
+    def __init__(self, target, dispatchers=None, estimate=None,
+                 name="auto_scheduler.cost_model_fusion_policy"):
+        # pylint: disable=import-outside-toplevel
+        from .search_task import SearchTask
+
+        self._target = tvm.target.Target(target)
+        self._dispatchers = []
+        for dispatcher in dispatchers if dispatchers is not None else []:
+            search_task = dispatcher.search_task
+            if search_task.compute_dag is None:
+                # the compute DAGs are not serialized in the records
+                dispatcher = dispatcher.embed_compute_dag(
+                    SearchTask(workload_key=search_task.workload_key,
+                               target=search_task.target).compute_dag
+                )
+            self._dispatchers.append(dispatcher)
+        self._estimate = estimate
+        self._name = name
+        tvm._ffi.register_func(name, self._decide, override=True)
+
+    @property
+    def config(self):
+        """The config of the pass context that enables the policy."""
+        return {"relay.FuseOps.fusion_policy": self._name}
+
+    def _predict_latency(self, func):
+        # pylint: disable=import-outside-toplevel
+        from tvm import relay
+        from tvm.relay.backend import compile_engine
+        from .relay_integration import TracingEnvironment, TracingMode
+
+        if not self._dispatchers:
+            return None
+        mod = relay.transform.InferType()(tvm.IRModule.from_expr(func))
+        # Lower as the task extraction does, so that the computes are the ones that the tasks
+        # are tuned on rather than the target-specific TOPI ones, without applying any schedule.
+        # The tracing environment of the caller (if any) is restored afterwards.
+        old_env = TracingEnvironment.current
+        try:
+            with TracingEnvironment(TracingMode.EXTRACT_COMPLEX_TASK_ONLY):
+                with tvm.transform.PassContext(opt_level=3, config={
+                        "relay.backend.use_auto_scheduler": True}):
+                    cached_func = compile_engine.get().lower(mod["main"], self._target)
+        finally:
+            TracingEnvironment.current = old_env
+        io_tensors = list(cached_func.inputs) + list(cached_func.outputs)
+        for dispatcher in self._dispatchers:
+            wkl_inst = dispatcher.match_instance(io_tensors)
+            if wkl_inst is not None:
+                return dispatcher.predict_latency(wkl_inst)
+            if dispatcher.matches(io_tensors):
+                search_task = dispatcher.search_task
+                latency = 0.0
+                for wkl_inst, weight in zip(search_task.wkl_insts,
+                                            search_task.wkl_inst_weights):
+                    latency += float(weight.value) * \
+                            dispatcher.predict_latency([int(v) for v in wkl_inst])
+                return latency
+        return None
+
+    def _estimate_latency(self, func):
+        latency = self._predict_latency(func)
+        if latency is None and self._estimate is not None:
+            latency = self._estimate(func)
+        return latency
+
+    def _decide(self, fused, anchor, tail):
+        # pylint: disable=import-outside-toplevel
+        import logging
+
+        try:
+            fused_latency = self._estimate_latency(fused)
+            anchor_latency = self._estimate_latency(anchor)
+            tail_latency = self._estimate_latency(tail)
+        except Exception:  # pylint: disable=broad-except
+            logging.getLogger("auto_scheduler").debug(
+                "Unable to estimate the latency of the fusion candidate", exc_info=True)
+            return True
+        if fused_latency is None or anchor_latency is None or tail_latency is None:
+            return True
+        return fused_latency <= anchor_latency + tail_latency
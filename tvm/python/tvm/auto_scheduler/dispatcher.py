@@ -25,6 +25,7 @@ as a schedule configuration here.
 
 import logging
 import pathlib
+import threading
 
 import numpy as np
 
@@ -40,13 +41,38 @@ from .utils import calc_workload_dis_factor, decode_workload_key
 logger = logging.getLogger("auto_scheduler")
 
 
-class DispatchContext(object):
+class _DispatchContextMeta(type):
+    """The metaclass that keeps the dispatch contexts entered by a background
+    thread (e.g., one that builds a model while the main thread serves the
+    requests) local to that thread. The main thread sets the process-wide
+    context, which the other threads see unless they enter their own."""
+
+    _global_current = None
+    _thread_local = threading.local()
+
+    def _get_thread_current(cls):
+        if threading.current_thread() is threading.main_thread():
+            return _DispatchContextMeta._global_current
+        return getattr(_DispatchContextMeta._thread_local, "current", None)
+
+    @property
+    def current(cls):
+        ctx = cls._get_thread_current()
+        return ctx if ctx is not None else _DispatchContextMeta._global_current
+
+    @current.setter
+    def current(cls, ctx):
+        if threading.current_thread() is threading.main_thread():
+            _DispatchContextMeta._global_current = ctx
+        else:
+            _DispatchContextMeta._thread_local.current = ctx
+
+
+class DispatchContext(metaclass=_DispatchContextMeta):
     """
     Base class of dispatch context.
     """
 
-    current = None
-
     def __init__(self):
         self._old_ctx = DispatchContext.current
 
@@ -115,13 +141,80 @@ class DispatchContext(object):
         """
         raise NotImplementedError()
 
+    # <bojian/DietCode>
+    def query_dyn_wkl_dispatcher(self, target, io_tensors):
+        """
+        Query the context to get the dynamic workload dispatcher for a compute
+        with dynamic shapes. If this function cannot find the dispatcher inside
+        this context, it will query the dispatcher from the upper contexts.
+
+        Parameters
+        ----------
+        target: Target
+            The current target
+        io_tensors: List[Tensor]
+            The input and output tensors of the compute, with symbolic shapes.
+
+        Returns
+        -------
+        dispatcher : Optional[DynWklDispatcher]
+            The dispatcher whose search task matches the compute.
+        """
+        ret = self._query_dyn_wkl_dispatcher_inside(target, io_tensors)
+        if ret is None and self._old_ctx is not None:
+            ret = self._old_ctx.query_dyn_wkl_dispatcher(target, io_tensors)
+        return ret
+
+    def _query_dyn_wkl_dispatcher_inside(self, target, io_tensors):
+        """
+        Query the context to get the dynamic workload dispatcher for a compute
+        with dynamic shapes. This function only query dispatchers inside this
+        context.
+        """
+        return None
+
+    def query_dyn_wkl_inst(self, target, io_tensors):
+        """
+        Query the context to get the dynamic workload dispatcher of which a
+        compute with static shapes is an instance (e.g., a model specialized to
+        its input shapes). If this function cannot find the dispatcher inside
+        this context, it will query the dispatcher from the upper contexts.
+
+        Parameters
+        ----------
+        target: Target
+            The current target
+        io_tensors: List[Tensor]
+            The input and output tensors of the compute, with static shapes.
+
+        Returns
+        -------
+        dispatcher_and_wkl_inst : Optional[Tuple[DynWklDispatcher, Tuple[int, ...]]]
+            The dispatcher whose search task the compute is an instance of,
+            together with the values of its shape variables.
+        """
+        ret = self._query_dyn_wkl_inst_inside(target, io_tensors)
+        if ret is None and self._old_ctx is not None:
+            ret = self._old_ctx.query_dyn_wkl_inst(target, io_tensors)
+        return ret
+
+    def _query_dyn_wkl_inst_inside(self, target, io_tensors):
+        """
+        Query the context to get the dynamic workload dispatcher of which a
+        compute with static shapes is an instance. This function only query
+        dispatchers inside this context.
+        """
+        return None
+
     def __enter__(self):
         self._old_ctx = DispatchContext.current
+        # the context that this thread has entered, which is restored on exit
+        self._old_thread_ctx = DispatchContext._get_thread_current()
         DispatchContext.current = self
         return self
 
     def __exit__(self, ptype, value, trace):
-        DispatchContext.current = self._old_ctx
+        DispatchContext.current = self._old_thread_ctx
 
 
 class ApplyHistoryBest(DispatchContext):
@@ -151,6 +244,8 @@ class ApplyHistoryBest(DispatchContext):
         self.best_by_targetkey = {}
         self.best_by_model = {}
         self._best_user_defined = {}
+        # <bojian/DietCode>
+        self.dyn_wkl_dispatchers = []
 
         self.load(records, n_lines)
 
@@ -304,6 +399,7 @@ class ApplyHistoryBest(DispatchContext):
                     )
             # print("workload_hash={}".format(workload_hash))
             entry['cached_autosched_result'] = disp
+            self.dyn_wkl_dispatchers.append(disp)
             for k in disp.search_task.target.keys:
                 entry, workload_hash, workload_args = \
                         self.get_workload_entry(
@@ -406,6 +502,42 @@ class ApplyHistoryBest(DispatchContext):
 
         return None
 
+    # <bojian/DietCode>
+    def _query_dyn_wkl_dispatcher_inside(self, target, io_tensors):
+        if target is None:
+            return None
+        for dispatcher in self.dyn_wkl_dispatchers:
+            search_task = dispatcher.search_task
+            if not set(target.keys) & set(search_task.target.keys):
+                continue
+            if search_task.compute_dag is None:
+                # the compute DAGs are not serialized in the records
+                dispatcher.embed_compute_dag(
+                    SearchTask(workload_key=search_task.workload_key,
+                               target=search_task.target).compute_dag
+                )
+            if dispatcher.matches(io_tensors):
+                return dispatcher
+        return None
+
+    # <bojian/DietCode>
+    def _query_dyn_wkl_inst_inside(self, target, io_tensors):
+        if target is None:
+            return None
+        for dispatcher in self.dyn_wkl_dispatchers:
+            search_task = dispatcher.search_task
+            if not set(target.keys) & set(search_task.target.keys):
+                continue
+            if search_task.compute_dag is None:
+                dispatcher.embed_compute_dag(
+                    SearchTask(workload_key=search_task.workload_key,
+                               target=search_task.target).compute_dag
+                )
+            wkl_inst = dispatcher.match_instance(io_tensors)
+            if wkl_inst is not None:
+                return dispatcher, wkl_inst
+        return None
+
     def update(self, target, workload_key, state):
 
         # <bojian/DietCode>
@@ -563,4 +695,5 @@ class FallbackContext(DispatchContext):
         self.memory[key] = state
 
 
-DispatchContext.current = FallbackContext()
+# the process-wide context, even if the module is imported by a background thread
+_DispatchContextMeta._global_current = FallbackContext()
@@ -34,14 +34,18 @@ We implement these in python to utilize python's multiprocessing and error handl
 import os
 import time
 import shutil
+import struct
 import tempfile
 import multiprocessing
 import logging
+import threading
+from concurrent.futures import ThreadPoolExecutor, as_completed
 
 # <bojian/DietCode>
 import numpy as np
 
 import tvm._ffi
+from tvm import rpc
 from tvm.runtime import Object, module, ndarray
 from tvm.driver import build_module
 from tvm.ir import transform
@@ -505,6 +509,109 @@ class RPCRunner(ProgramRunner):
             )
 
 
+@tvm._ffi.register_object("auto_scheduler.DistributedRPCRunner")
+class DistributedRPCRunner(ProgramRunner):
+    """DistributedRPCRunner that shards the measurement of programs across all the RPC servers
+    registered in the tracker under a set of device keys.
+
+    Each program goes to the device key with the lowest live queue depth, i.e., the number of
+    runs in flight plus the requests pending in the tracker, divided by the number of servers
+    of that key. The results are streamed back through `on_result` as soon as they arrive, and
+    a run that loses its RPC server (e.g., the server is shut down or the connection drops) is
+    retried on another server.
+
+    Parameters
+    ----------
+    keys : Union[str, List[str]]
+        The keys of the devices registered in the RPC tracker.
+    host : str
+        The host address of the RPC Tracker.
+    port : int
+        The port of RPC Tracker.
+    priority : int = 1
+        The priority of this run request, larger is more prior.
+    n_parallel : int = 1
+        The number of tasks run in parallel on each RPC server.
+    timeout : int = 10
+        The timeout limit (in second) for each run.
+        This is used as the session timeout of the RPC servers.
+    number : int = 3
+        The number of times to run the generated code for taking average.
+        We call these runs as one `repeat` of measurement.
+    repeat : int = 1
+        The number of times to repeat the measurement.
+        In total, the generated code will be run (1 + number x repeat) times,
+        where the first "1" is warm up and will be discarded.
+        The returned result contains `repeat` costs,
+        each of which is an average of `number` costs.
+    min_repeat_ms : int = 100
+        The minimum duration of one `repeat` in milliseconds.
+        By default, one `repeat` contains `number` runs. If this parameter is set,
+        the parameters `number` will be dynamically adjusted to meet the
+        minimum duration requirement of one `repeat`.
+        i.e., When the run time of one `repeat` falls below this time, the `number` parameter
+        will be automatically increased.
+    cooldown_interval : float = 0.0
+        The cool down interval between two measurements.
+    enable_cpu_cache_flush: bool = False
+        Whether to flush cache on CPU between repeated measurements.
+        Flushing cache can make the measured latency of one operator closer to
+        its actual latency during end-to-end inference.
+        To make this option effective, the argument `number` should also be set to 1.
+        This is only has effect on CPU task.
+    max_retries : int = 2
+        The maximum number of times a run is retried after losing its RPC server.
+    on_result : Optional[Callable[[int, MeasureInput, MeasureResult], None]] = None
+        The function called with the index, the input and the result of each run as soon as
+        it finishes, in the order of completion.
+    """
+
+    def __init__(
+        self,
+        keys,
+        host,
+        port,
+        priority=1,
+        n_parallel=1,
+        timeout=10,
+        number=3,
+        repeat=1,
+        min_repeat_ms=100,
+        cooldown_interval=0.0,
+        enable_cpu_cache_flush=False,
+        max_retries=2,
+        on_result=None,
+    ):
+        if isinstance(keys, str):
+            keys = [keys]
+        self.__init_handle_by_constructor__(
+            _ffi_api.DistributedRPCRunner,
+            keys,
+            host,
+            port,
+            priority,
+            n_parallel,
+            timeout,
+            number,
+            repeat,
+            min_repeat_ms,
+            cooldown_interval,
+            enable_cpu_cache_flush,
+            max_retries,
+            on_result,
+        )
+
+        if any(check_remote(key, host, port, priority, timeout) for key in keys):
+            print("Get devices for measurement successfully!")
+        else:
+            raise RuntimeError(
+                "Cannot get remote devices from the tracker. "
+                "Please check the status of tracker by "
+                "'python -m tvm.exec.query_rpc_tracker --port [THE PORT YOU USE]' "
+                "and make sure you have free devices on the queue status."
+            )
+
+
 class LocalRPCMeasureContext:
     """A context wrapper for running RPCRunner locally.
     This will launch a local RPC Tracker and local RPC Server.
@@ -595,6 +702,98 @@ class LocalRPCMeasureContext:
         time.sleep(0.5)
 
 
+class LocalDistributedMeasureContext:
+    """A context wrapper for running DistributedRPCRunner locally.
+    This will launch a local RPC Tracker and several local RPC Servers that stand in for a
+    fleet of devices.
+
+    Parameters
+    ----------
+    num_servers : int = 2
+        The number of local RPC Servers to launch.
+    num_keys : int = 1
+        The number of device keys that the servers are spread over (round-robin).
+    priority : int = 1
+        The priority of this run request, larger is more prior.
+    n_parallel : int = 1
+        The number of tasks run in parallel on each RPC server.
+    timeout : int = 10
+        The timeout limit (in second) for each run.
+    number : int = 3
+        The number of times to run the generated code for taking average.
+    repeat : int = 1
+        The number of times to repeat the measurement.
+    min_repeat_ms : int = 0
+        The minimum duration of one `repeat` in milliseconds.
+    cooldown_interval : float = 0.0
+        The cool down interval between two measurements.
+    enable_cpu_cache_flush: bool = False
+        Whether to flush cache on CPU between repeated measurements.
+    max_retries : int = 2
+        The maximum number of times a run is retried after losing its RPC server.
+    on_result : Optional[Callable[[int, MeasureInput, MeasureResult], None]] = None
+        The function called with the index, the input and the result of each run as soon as
+        it finishes.
+    """
+
+    def __init__(
+        self,
+        num_servers=2,
+        num_keys=1,
+        priority=1,
+        n_parallel=1,
+        timeout=10,
+        number=3,
+        repeat=1,
+        min_repeat_ms=0,
+        cooldown_interval=0.0,
+        enable_cpu_cache_flush=False,
+        max_retries=2,
+        on_result=None,
+    ):
+        # pylint: disable=import-outside-toplevel
+        from tvm.rpc.tracker import Tracker
+        from tvm.rpc.server import Server
+
+        assert num_servers >= num_keys >= 1, "Each device key needs at least one server"
+        self.tracker = Tracker(port=9000, port_end=10000, silent=True)
+        self.keys = ["$local$device$%d$%d" % (self.tracker.port, i) for i in range(num_keys)]
+        self.servers = [
+            Server(
+                port=self.tracker.port,
+                port_end=10000,
+                key=self.keys[i % num_keys],
+                silent=True,
+                tracker_addr=("127.0.0.1", self.tracker.port),
+            )
+            for i in range(num_servers)
+        ]
+        # Wait for the servers to register themselves to the tracker
+        time.sleep(0.5)
+        self.runner = DistributedRPCRunner(
+            self.keys,
+            "127.0.0.1",
+            self.tracker.port,
+            priority,
+            n_parallel,
+            timeout,
+            number,
+            repeat,
+            min_repeat_ms,
+            cooldown_interval,
+            enable_cpu_cache_flush,
+            max_retries,
+            on_result,
+        )
+
+    def __del__(self):
+        # Close the tracker and servers before exit
+        self.tracker.terminate()
+        for server in self.servers:
+            server.terminate()
+        time.sleep(0.5)
+
+
 class MeasureErrorNo(object):
     """Error type for MeasureResult."""
 
@@ -1100,6 +1299,42 @@ def local_run(
     return measure_results
 
 
+def _get_remote_measure_module(remote):
+    """Get the function that measures an uploaded module in a single round trip, or None if the
+    RPC server does not provide it."""
+    try:
+        return remote.get_function("tvm.rpc.server.MeasureModule")
+    except AttributeError:
+        return None
+
+
+def _rpc_measure_module(measure_module, inp, build_res, number, repeat, min_repeat_ms, f_prepare):
+    """Load, prepare, check and time an uploaded module with one RPC call. The arguments are
+    randomly filled on the remote device instead of going through the RPC channel.
+
+    Returns
+    -------
+    costs : Tuple[float]
+        The `repeat` costs of the module, in seconds.
+    """
+    arg_info = []
+    for arg in build_res.args:
+        shape = get_const_tuple(arg.shape)
+        arg_info += [arg.dtype, len(shape)] + list(shape)
+    dev = ndarray.device(str(inp.task.target), 0)
+    blob = measure_module(
+        os.path.split(build_res.filename)[1],
+        dev.device_type,
+        dev.device_id,
+        number,
+        repeat,
+        min_repeat_ms,
+        f_prepare,
+        *arg_info,
+    )
+    return struct.unpack("@" + "d" * repeat, blob)
+
+
 def _rpc_run(
     inp_serialized,
     build_res,
@@ -1115,38 +1350,59 @@ def _rpc_run(
     cooldown_interval,
     enable_cpu_cache_flush,
     verbose,
+    cleanup=True,
+    on_session_start=None,
 ):
     inp = MeasureInput.deserialize(inp_serialized)
     tic = time.time()
     error_no = 0
     error_msg = None
+    measure_module = None
     try:
         # upload built module
         remote = request_remote(key, host, port, priority, timeout)
+        if on_session_start is not None:
+            on_session_start()
         remote.upload(build_res.filename)
-        func = remote.load_module(os.path.split(build_res.filename)[1])
-        dev = remote.device(str(inp.task.target), 0)
         # Limitation:
         # We can not get PackFunction directly in the remote mode as it is wrapped
         # under the std::function. We could lift the restriction later once we fold
         # the PackedFunc as an object. Currently, we pass function name to work
         # around it.
         f_prepare = "cache_flush_cpu_non_first_arg" if enable_cpu_cache_flush else ""
-        time_f = func.time_evaluator(
-            func.entry_name,
-            dev,
-            number=number,
-            repeat=repeat,
-            min_repeat_ms=min_repeat_ms,
-            f_preproc=f_prepare,
-        )
+        if all(arg is None for arg in args):
+            measure_module = _get_remote_measure_module(remote)
+        if measure_module is None:
+            func = remote.load_module(os.path.split(build_res.filename)[1])
+            dev = remote.device(str(inp.task.target), 0)
+            time_f = func.time_evaluator(
+                func.entry_name,
+                dev,
+                number=number,
+                repeat=repeat,
+                min_repeat_ms=min_repeat_ms,
+                f_preproc=f_prepare,
+            )
     # pylint: disable=broad-except
     except Exception:
         costs = (MAX_FLOAT,)
         error_no = MeasureErrorNo.COMPILE_DEVICE
         error_msg = make_traceback_info()
 
-    if error_no == 0:
+    if error_no == 0 and measure_module is not None:
+        try:
+            costs = _rpc_measure_module(
+                measure_module, inp, build_res, number, repeat, min_repeat_ms, f_prepare
+            )
+        # pylint: disable=broad-except
+        except Exception:
+            costs = (MAX_FLOAT,)
+            error_msg = make_traceback_info()
+            if "Cannot load module" in error_msg:
+                error_no = MeasureErrorNo.COMPILE_DEVICE
+            else:
+                error_no = MeasureErrorNo.RUNTIME_DEVICE
+    elif error_no == 0:
         try:
             stream = dev.create_raw_stream()
             dev.set_raw_stream(stream)
@@ -1207,7 +1463,8 @@ def _rpc_run(
             # <bojian/DietCode>
             # assert False, "RUNTIME_DEVICE error found with msg={}".format(error_msg)
 
-    shutil.rmtree(os.path.dirname(build_res.filename))
+    if cleanup:
+        shutil.rmtree(os.path.dirname(build_res.filename))
     toc = time.time()
 
     time.sleep(cooldown_interval)
@@ -1382,3 +1639,287 @@ def rpc_runner_run(
         print("")
 
     return results
+
+
+# The error messages that indicate a run failed because its RPC server was lost, rather than
+# because of the program itself.
+RPC_SERVER_LOSS_MESSAGES = (
+    "Connection",
+    "connection",
+    "Broken pipe",
+    "Socket",
+    "socket",
+    "code=kShutdown",
+)
+
+
+class _RPCFleetBalancer:
+    """Balance the runs of DistributedRPCRunner over the device keys by their live queue depth.
+
+    The queue depth of a key is the number of runs in flight plus the number of requests pending
+    in the tracker, divided by the number of RPC servers registered under that key.
+    """
+
+    def __init__(self, keys, host, port):
+        self.keys = list(keys)
+        self.host = host
+        self.port = port
+        self.lock = threading.Lock()
+        self.in_flight = {key: 0 for key in self.keys}
+        self.num_servers = {key: 0 for key in self.keys}
+        self.pending = {key: 0 for key in self.keys}
+        self.refresh()
+
+    def refresh(self):
+        """Query the servers and the pending requests of each device key from the tracker."""
+        try:
+            tracker = rpc.connect_tracker(self.host, self.port)
+            summary = tracker.summary()
+            tracker.close()
+        # pylint: disable=broad-except
+        except Exception:
+            # Keep the last view of the fleet if the tracker cannot be reached.
+            logger.warning("Cannot query the RPC tracker at %s:%d", self.host, self.port)
+            return
+        num_servers = {key: 0 for key in self.keys}
+        for item in summary["server_info"]:
+            key = item["key"].split(":")[1]  # 'server:rasp3b' -> 'rasp3b'
+            if key in num_servers:
+                num_servers[key] += 1
+        queue_info = summary["queue_info"]
+        pending = {key: queue_info.get(key, {}).get("pending", 0) for key in self.keys}
+        with self.lock:
+            self.num_servers, self.pending = num_servers, pending
+
+    def total_servers(self):
+        """The total number of RPC servers of all the device keys."""
+        with self.lock:
+            return sum(self.num_servers.values())
+
+    def acquire(self, excluded_keys):
+        """Pick the least loaded device key, preferring the ones not in `excluded_keys`."""
+        with self.lock:
+            candidates = [key for key in self.keys if self.num_servers[key] > 0]
+            # Let the tracker queue the requests if no server is registered at the moment.
+            candidates = candidates or self.keys
+            candidates = [key for key in candidates if key not in excluded_keys] or candidates
+            key = min(
+                candidates,
+                key=lambda key: (self.in_flight[key] + self.pending[key])
+                / max(self.num_servers[key], 1),
+            )
+            self.in_flight[key] += 1
+            return key
+
+    def release(self, key):
+        """Mark a run on the device key `key` as finished."""
+        with self.lock:
+            self.in_flight[key] -= 1
+
+
+def _is_rpc_server_loss(error_no, error_msg):
+    if error_no == MeasureErrorNo.COMPILE_DEVICE:
+        # The remote session could not be requested or the module could not be uploaded.
+        return True
+    return (
+        error_no == MeasureErrorNo.RUNTIME_DEVICE
+        and error_msg is not None
+        and any(msg in error_msg for msg in RPC_SERVER_LOSS_MESSAGES)
+    )
+
+
+def _distributed_rpc_run_worker(inp, build_res, balancer, run_args, timeout, max_retries):
+    """Function to be ran in the DistributedRPCRunner thread pool.
+
+    Parameters
+    ----------
+    inp : MeasureInput
+        The MeasureInput to be measured.
+    build_res : BuildResult
+        The BuildResult of `inp`.
+    balancer : _RPCFleetBalancer
+        The balancer that picks the device key of each attempt.
+    run_args : Tuple
+        The host, port, priority, timeout, number, repeat, min_repeat_ms, cooldown_interval and
+        enable_cpu_cache_flush arguments of `_rpc_run`.
+    timeout : int
+        The timeout limit (in second) for each run, counted from the start of its RPC session.
+    max_retries : int
+        The maximum number of times the run is retried after losing its RPC server.
+
+    Returns
+    -------
+    res : Tuple
+        The fields of the MeasureResult of `inp`.
+    """
+    if build_res.error_no != MeasureErrorNo.NO_ERROR:
+        return (
+            (MAX_FLOAT,),
+            build_res.error_no,
+            build_res.error_msg,
+            build_res.time_cost,
+            time.time(),
+        )
+
+    excluded_keys = set()
+    try:
+        inp_serialized = inp.serialize()
+        args = prepare_runner_args(inp, build_res)
+        for attempt in range(max_retries + 1):
+            key = balancer.acquire(excluded_keys)
+            session_start = []
+            try:
+                res = _rpc_run(
+                    inp_serialized,
+                    build_res,
+                    list(args),
+                    key,
+                    *run_args,
+                    verbose=0,
+                    cleanup=False,
+                    on_session_start=lambda: session_start.append(time.time()),
+                )
+            finally:
+                balancer.release(key)
+            costs, error_no, error_msg, _, toc = res
+            if error_no == MeasureErrorNo.NO_ERROR:
+                break
+            # The session timeout of the server counts from the start of the session, not from
+            # the request that may have been waiting in the tracker queue.
+            if session_start and toc - session_start[0] >= timeout:
+                # The server closed the session as it ran out of time.
+                res = (
+                    costs,
+                    MeasureErrorNo.RUN_TIMEOUT,
+                    None,
+                    build_res.time_cost + timeout,
+                    time.time(),
+                )
+                break
+            if attempt == max_retries or not _is_rpc_server_loss(error_no, error_msg):
+                break
+            logger.info("Lost the RPC server of device %s, retrying on another server", key)
+            excluded_keys.add(key)
+            balancer.refresh()
+    # pylint: disable=broad-except
+    except Exception:
+        res = (
+            (MAX_FLOAT,),
+            MeasureErrorNo.RUNTIME_DEVICE,
+            make_traceback_info(),
+            build_res.time_cost + timeout,
+            time.time(),
+        )
+    finally:
+        shutil.rmtree(os.path.dirname(build_res.filename), ignore_errors=True)
+    return res
+
+
+@tvm._ffi.register_func("auto_scheduler.distributed_rpc_runner.run")
+def distributed_rpc_runner_run(
+    inputs,
+    build_results,
+    keys,
+    host,
+    port,
+    priority=1,
+    n_parallel=1,
+    timeout=10,
+    number=3,
+    repeat=1,
+    min_repeat_ms=0,
+    cooldown_interval=0.0,
+    enable_cpu_cache_flush=False,
+    max_retries=2,
+    on_result=None,
+    verbose=1,
+):
+    """Run function of DistributedRPCRunner to test the performance of the input BuildResults.
+
+    Parameters
+    ----------
+    inputs : List[MeasureInput]
+        The MeasureInputs to be measured.
+    build_results : List[BuildResult]
+        The BuildResults to be measured.
+    keys : List[str]
+        The keys of the devices registered in the RPC tracker.
+    host : str
+        The host address of the RPC Tracker.
+    port : int
+        The port of RPC Tracker.
+    priority : int = 1
+        The priority of this run request, larger is more prior.
+    n_parallel : int = 1
+        The number of tasks run in parallel on each RPC server.
+    timeout : int = 10
+        The timeout limit (in second) for each run.
+    number : int = 3
+        The number of times to run the generated code for taking average.
+    repeat : int = 1
+        The number of times to repeat the measurement.
+    min_repeat_ms : int = 0
+        The minimum duration of one `repeat` in milliseconds.
+    cooldown_interval : float = 0.0
+        The cool down interval between two measurements.
+    enable_cpu_cache_flush: bool = False
+        Whether to flush cache on CPU between repeated measurements.
+    max_retries : int = 2
+        The maximum number of times a run is retried after losing its RPC server.
+    on_result : Optional[Callable[[int, MeasureInput, MeasureResult], None]] = None
+        The function called with the index, the input and the result of each run as soon as
+        it finishes.
+    verbose: int = 1
+        Verbosity level. 0 for silent, 1 to output information during program measuring.
+
+    Returns
+    -------
+    res : List[MeasureResult]
+        The measure results of these MeasureInputs, in the order of the inputs.
+    """
+    assert len(inputs) == len(build_results), "Measure input size should be equal to build results"
+    balancer = _RPCFleetBalancer(keys, host, port)
+    run_args = (
+        host,
+        port,
+        priority,
+        timeout,
+        number,
+        repeat,
+        min_repeat_ms,
+        cooldown_interval,
+        enable_cpu_cache_flush,
+    )
+
+    results = [None] * len(inputs)
+    # The runs only wait for the RPC servers, so threads are enough to keep the fleet busy.
+    with ThreadPoolExecutor(max(balancer.total_servers(), 1) * n_parallel) as executor:
+        futures = {
+            executor.submit(
+                _distributed_rpc_run_worker,
+                inp,
+                build_res,
+                balancer,
+                run_args,
+                timeout,
+                max_retries,
+            ): i
+            for i, (inp, build_res) in enumerate(zip(inputs, build_results))
+        }
+        for future in as_completed(futures):
+            i = futures[future]
+            results[i] = MeasureResult(*future.result())
+            if verbose >= 1:
+                if results[i].error_no == MeasureErrorNo.NO_ERROR:
+                    print("*", end="", flush=True)
+                elif results[i].error_no == MeasureErrorNo.RUN_TIMEOUT:
+                    print("*T", end="", flush=True)  # Run timeout
+                else:
+                    print("*E", end="", flush=True)  # Run error
+            if on_result is not None:
+                on_result(i, inputs[i], results[i])
+
+    if verbose >= 1:
+        print("")
+
+    return results
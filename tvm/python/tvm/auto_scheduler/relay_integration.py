@@ -212,8 +212,186 @@ def RelayIntegration_BatchMatmul(B, M, K, N):
     return [X, W, Y]
 
 
+@register_workload
+def RelayIntegration_DenseAdd(M, K, N):
+    from tvm import topi
+    X = te.placeholder((M, K), name='X')
+    W = te.placeholder((N, K), name='W')
+    B = te.placeholder((N,), name='B')
+    Y = topi.add(topi.nn.dense(X, W), B)
+    return [X, W, B, Y]
+
+
+@register_workload
+def RelayIntegration_Softmax(B, M, N):
+    from tvm import topi
+    X = te.placeholder((B, M, N), name='X')
+    Y = topi.nn.softmax(X, axis=-1)
+    return [X, Y]
+
+
 DYN_SEARCH_TASK_REGISTRY = {}
 DYN_FUNC_REGISTRY = {}
+# (with_bias, K, N) -> DynWklDispatcher, filled by `tune_parallel_dense`
+PARALLEL_DENSE_DISPATCHER_REGISTRY = {}
+
+
+def _query_parallel_dense_dispatcher(func_name, io_tensors):
+    """Query the dispatcher tuned by `tune_parallel_dense` for a dense operator.
+
+    Returns
+    -------
+    dispatcher : Optional[DynWklDispatcher]
+        The dispatcher, None if the operator has not been tuned.
+    wkl_inst : Optional[Tuple[int]]
+        The tuned (M, N) workload instance that the operator is dispatched to.
+    """
+    if not PARALLEL_DENSE_DISPATCHER_REGISTRY:
+        return None, None
+
+    from tvm.relay.backend.utils import mangle_prefix
+
+    if re.match('^{}.*_fused_nn_dense(_[0-9]+)?$'.format(mangle_prefix), func_name):
+        with_bias = False
+    elif re.match('^{}.*_fused_nn_dense_add(_[0-9]+)?$'.format(mangle_prefix), func_name):
+        with_bias = True
+    else:
+        return None, None
+    X_shape, W_shape = get_const_tuple(io_tensors[0].shape), \
+                       _get_dense_weight_shape(io_tensors)
+    M, (N, K) = X_shape[0], W_shape
+    dispatcher = PARALLEL_DENSE_DISPATCHER_REGISTRY.get((with_bias, K, N))
+    if dispatcher is None:
+        logger.info("%s (M=%d, K=%d, N=%d) has not been tuned by tune_parallel_dense, "
+                    "falling back to the default dispatching", func_name, M, K, N)
+        return None, None
+    # Round M up to the smallest tuned bucket, the state of which handles the
+    # padding through its boundary checks.
+    tuned_M_values = [int(tuned_wkl_inst[0])
+                      for tuned_wkl_inst in dispatcher.search_task.wkl_insts
+                      if int(tuned_wkl_inst[1]) == N and int(tuned_wkl_inst[0]) >= M]
+    if not tuned_M_values:
+        logger.warning("%s (M=%d, K=%d, N=%d) exceeds all the tuned buckets of M, "
+                       "falling back to the default dispatching", func_name, M, K, N)
+        return None, None
+    if min(tuned_M_values) != M:
+        logger.info("%s (M=%d, K=%d, N=%d) is dispatched to the bucket M=%d",
+                    func_name, M, K, N, min(tuned_M_values))
+    return dispatcher, (min(tuned_M_values), N)
+
+
+def _make_dense_task(M_values, M_weights, K, N_values, with_bias, target, hardware_api):
+    # K is shared by all the parallel dense operators and hence kept static
+    M, N = tir.DynShapeVar('M'), tir.DynShapeVar('N')
+    wkl_insts, wkl_inst_weights = [], []
+    for M_value, weight in zip(M_values, M_weights):
+        for N_value in N_values:
+            wkl_insts.append((M_value, N_value))
+            wkl_inst_weights.append(weight * 1.)
+    return SearchTask(func=RelayIntegration_DenseAdd if with_bias else RelayIntegration_Dense,
+                      args=(M, K, N),
+                      shape_vars=(M, N),
+                      wkl_insts=wkl_insts,
+                      wkl_inst_weights=wkl_inst_weights,
+                      hardware_api=hardware_api,
+                      target=target)
+
+
+def tune_parallel_dense(M_values, M_weights, K, N_branches, target, hardware_api,
+                        tuning_options, with_bias=True, search_policy_func=None):
+    """Jointly decide whether to combine parallel dense operators (e.g., the
+    Q/K/V projections of BERT) and tune the chosen form.
+
+    A joint task that covers both the split (N = N_i) and the combined
+    (N = sum(N_i)) forms is tuned once. Its dispatcher predicts the latency of
+    both forms on every bucket of M, and the form with the smaller weighted
+    latency is chosen. As the joint dispatcher already holds the states of
+    both forms, it is reused for the chosen form rather than retuned, so the
+    tuning budget is only spent once. The dispatcher is picked up by
+    `auto_schedule_topi` when the model is built.
+
+    Parameters
+    ----------
+    M_values : List[int]
+        The buckets of the dynamic axis M (e.g., batch size x sequence length).
+    M_weights : List[float]
+        The frequency of each bucket.
+    K : int
+        The reduction axis that is shared by all the parallel dense operators.
+    N_branches : List[int]
+        The output dimension of every parallel dense operator.
+    target : Union[tvm.target.Target, str]
+        The compilation target.
+    hardware_api : tvm.hardware.HardwareAPI
+        The hardware description. `EfficientSearch` is used when its
+        `num_level` is not 0.
+    tuning_options : TuningOptions
+        The tuning options.
+    with_bias : bool
+        Whether the dense operators are followed by a bias add.
+    search_policy_func : Optional[Callable[[SearchTask], SearchPolicy]]
+        The function that creates the search policy of a task. The default
+        `SketchPolicy` with `XGBModel` is used if None.
+
+    Returns
+    -------
+    combine : bool
+        Whether the parallel dense operators should be combined.
+    dispatcher : DynWklDispatcher
+        The joint dispatcher, which also serves the chosen form.
+    """
+    assert len(M_values) == len(M_weights)
+    N_combined = sum(N_branches)
+
+    def _tune(task):
+        search_policy = search_policy_func(task) if search_policy_func is not None else None
+        return task.tune(tuning_options, search_policy)
+
+    dispatcher = _tune(_make_dense_task(M_values, M_weights, K,
+                                        sorted(set(N_branches) | {N_combined}),
+                                        with_bias, target, hardware_api))
+    split_latency, combined_latency = 0., 0.
+    for M, weight in zip(M_values, M_weights):
+        inst_split_latency = sum([dispatcher.predict_latency((M, N)) for N in N_branches])
+        inst_combined_latency = dispatcher.predict_latency((M, N_combined))
+        logger.info("M=%d: split=%.3e, combined=%.3e", M, inst_split_latency,
+                    inst_combined_latency)
+        split_latency += weight * inst_split_latency
+        combined_latency += weight * inst_combined_latency
+    combine = combined_latency < split_latency
+    logger.info("Parallel dense (K=%d, N=%s) is %s", K, N_branches,
+                "combined" if combine else "kept split")
+
+    for N in [N_combined] if combine else set(N_branches):
+        PARALLEL_DENSE_DISPATCHER_REGISTRY[(with_bias, K, N)] = dispatcher
+    return combine, dispatcher
+
+
+def combine_parallel_dense(mod, combine, min_num_branches=3):
+    """Apply the decision made by `tune_parallel_dense` to a Relay module.
+
+    Parameters
+    ----------
+    mod : tvm.IRModule
+        The Relay module.
+    combine : bool
+        Whether the parallel dense operators should be combined.
+    min_num_branches : int
+        The minimum number of parallel dense operators to be combined.
+
+    Returns
+    -------
+    mod : tvm.IRModule
+        The module, with the parallel dense operators combined into a wider
+        dense if `combine` is True.
+    """
+    # pylint: disable=import-outside-toplevel
+    from tvm import relay
+
+    if not combine:
+        return mod
+    return relay.transform.CombineParallelDense(min_num_branches=min_num_branches,
+                                                to_batch=False)(mod)
 
 
 def remove_func_name_indices(func_name):
@@ -288,6 +466,16 @@ def extract_dyn_tasks(mod, params, target):
                                              wkl_info[5]),
                                 weight=weight))
             continue
+        if re.match('{}.*_fused_nn_softmax'.format(mangle_prefix), func_name) and \
+           len(wkl_info) == 7:
+            # memory-bound row reductions, tuned by EfficientRowReductionSearch
+            if func_name not in dyn_task_info:
+                dyn_task_info[func_name] = (RelayIntegration_Softmax,
+                                            ('B', 'M', 'N'), [])
+            dyn_task_info[func_name][2].append(
+                    DynTaskInfo(shape_tuple=(wkl_info[1], wkl_info[2], wkl_info[3]),
+                                weight=weight))
+            continue
         tasks.append(
                 SearchTask(workload_key=wkl_key,
                            target=target,
@@ -414,7 +602,7 @@ def exit_layout_rewrite():
     env.__exit__(None, None, None)
 
 
-def traverse_to_get_io_tensors(outs):
+def traverse_to_get_io_tensors(outs, allow_dynamic_shape=False):
     """Traverse from a list of output tensors to get input/output tensors and
     other useful information.
 
@@ -422,11 +610,15 @@ def traverse_to_get_io_tensors(outs):
     ----------
     outs: List[Tensor]
         The output tensors
+    allow_dynamic_shape: bool
+        Whether to keep the I/O tensors with dynamic shapes, which can only be
+        scheduled by the dynamic workload dispatchers, rather than to reject them.
 
     Returns
     -------
     io_tensors: List[Tensor]
-        The input and output tensors with static shape
+        The input and output tensors with static shape (or with dynamic shape if
+        `allow_dynamic_shape` is set)
     has_layout_free: bool
         Whether the compute DAG has layout_free placeholders
     has_complex_op: bool
@@ -483,14 +675,28 @@ def traverse_to_get_io_tensors(outs):
         traverse(t)
 
     io_tensors = inputs + list(outs)
-    for tensor in io_tensors:
+    if not allow_dynamic_shape and _has_dynamic_shape(io_tensors):
         # Reject the compute if any of its I/O tensors has dynamic shape.
-        if any([not isinstance(v, int) for v in get_const_tuple(tensor.shape)]):
-            return ([], False, False)
+        return ([], False, False)
 
     return (io_tensors, len(layout_free_ops) > 0, has_complex_op)
 
 
+# <bojian/DietCode>
+def _has_dynamic_shape(io_tensors):
+    return any([any([not isinstance(v, int) for v in get_const_tuple(tensor.shape)])
+                for tensor in io_tensors])
+
+
+def _get_dense_weight_shape(io_tensors):
+    """Get the logical (N, K) shape of the dense weight, which could have been
+    packed by the layout rewrite.
+    """
+    X_shape, Y_shape = get_const_tuple(io_tensors[0].shape), \
+                       get_const_tuple(io_tensors[-1].shape)
+    return (Y_shape[-1], X_shape[-1])
+
+
 @tvm._ffi.register_func("auto_scheduler.relay_integration.auto_schedule_topi_compute")
 def auto_schedule_topi(func_name, outs):
     """Use auto-scheduler to schedule any topi compute function.
@@ -517,9 +723,24 @@ def auto_schedule_topi(func_name, outs):
         prepare_input_map,
     )  # lazily import to avoid recursive dependency
 
-    io_tensors, has_layout_free, has_complex_op = traverse_to_get_io_tensors(outs)
-    if not io_tensors:  # The compute includes dynamic shapes which are not supported yet.
-        return None
+    # <bojian/DietCode>
+    # io_tensors, has_layout_free, has_complex_op = traverse_to_get_io_tensors(outs)
+    # if not io_tensors:  # The compute includes dynamic shapes which are not supported yet.
+    #     return None
+    io_tensors, has_layout_free, has_complex_op = \
+            traverse_to_get_io_tensors(outs, allow_dynamic_shape=True)
+    if _has_dynamic_shape(io_tensors):
+        # The computes with dynamic shapes are scheduled by the dispatchers in
+        # the tuning records, which are lowered into the kernels of the tuned
+        # states together with their decision trees. They are left to the
+        # fallback topi schedules in the tracing modes.
+        if TracingEnvironment.current is not None:
+            return None
+        dyn_wkl_dispatcher = DispatchContext.current.query_dyn_wkl_dispatcher(
+            tvm.target.Target.current(), io_tensors)
+        if dyn_wkl_dispatcher is None:
+            logger.info("No dynamic workload dispatcher is found for %s", func_name)
+        return dyn_wkl_dispatcher
 
     try:
         dag = ComputeDAG(io_tensors)
@@ -535,73 +756,96 @@ def auto_schedule_topi(func_name, outs):
     # <bojian/DietCode>
     # state = dispatch_ctx.query(target, key, has_complex_op, dag, func_name)
     import os
-    if 'DIETCODE_SCHED_LOG_DIR' in os.environ:
+    if 'DIETCODE_SCHED_LOG_DIR' in os.environ or PARALLEL_DENSE_DISPATCHER_REGISTRY:
         from tvm.auto_scheduler import load_records
         from tvm.relay.backend.utils import mangle_prefix
 
         print("Loading DietCode schedules for func_name={}".format(func_name))
-        dyn_wkl_dispatcher = None
-        if re.match('^{}.*_fused_nn_dense$'.format(mangle_prefix), func_name) or \
-           re.match('^{}.*_fused_nn_dense_[0-9]+$'.format(mangle_prefix), func_name):
-
-            X_shape, W_shape = get_const_tuple(io_tensors[0].shape), \
-                               get_const_tuple(io_tensors[1].shape)
-
-            if W_shape[0] == 768:
-                dyn_wkl_dispatcher = load_records(os.environ['DIETCODE_SCHED_LOG_DIR'] + 'dense/saved_schedules_G4/dietcode_autosched_dense_16xTxIx768.json')[1][-1]
-            if W_shape[0] == 3072:
-                assert W_shape[1] == 768
-                dyn_wkl_dispatcher = load_records(os.environ['DIETCODE_SCHED_LOG_DIR'] + 'dense/saved_schedules_G4/dietcode_autosched_dense_16xTx768x3072.json')[1][-1]
-            if W_shape[0] == 1024 and W_shape[1] == 4096:
-                dyn_wkl_dispatcher = load_records(os.environ['DIETCODE_SCHED_LOG_DIR'] + 'dense/saved_schedules_G4/dietcode_autosched_dense_16xTx4096x1024.json')[1][-1]
-            if W_shape[0] == 4096 and W_shape[1] == 1024:
-                dyn_wkl_dispatcher = load_records(os.environ['DIETCODE_SCHED_LOG_DIR'] + 'dense/saved_schedules_G4/dietcode_autosched_dense_16xTx1024x4096.json')[1][-1]
-            if W_shape[0] == 1024 and W_shape[1] == 1024:
-                dyn_wkl_dispatcher = load_records(os.environ['DIETCODE_SCHED_LOG_DIR'] + 'dense/saved_schedules_G4/dietcode_autosched_dense_16xTx1024x1024.json')[1][-1]
-            if W_shape[0] == 50257 and W_shape[1] == 768:
-                dyn_wkl_dispatcher = load_records(os.environ['DIETCODE_SCHED_LOG_DIR'] + 'dense/saved_schedules_G4/dietcode_autosched_dense_16xTx768x50257.json')[1][-1]
-            wkl_inst = (X_shape[0] // 16, X_shape[1], W_shape[0])
-        if re.match('^{}.*_fused_nn_dense_add$'.format(mangle_prefix), func_name) or \
-           re.match('^{}.*_fused_nn_dense_add_[0-9]+$'.format(mangle_prefix), func_name):
-
-            X_shape, W_shape = get_const_tuple(io_tensors[0].shape), \
-                               get_const_tuple(io_tensors[1].shape)
-
-            if W_shape[0] == 768 and W_shape[1] == 768:
-                dyn_wkl_dispatcher = load_records(os.environ['DIETCODE_SCHED_LOG_DIR'] + 'dense/saved_schedules_G4/dietcode_autosched_dense_add_16xTx768x768.json')[1][-1]
-            if W_shape[0] == 3072 and W_shape[1] == 768:
-                dyn_wkl_dispatcher = load_records(os.environ['DIETCODE_SCHED_LOG_DIR'] + 'dense/saved_schedules_G4/dietcode_autosched_dense_add_16xTx768x3072.json')[1][-1]
-            if W_shape[0] == 768 and W_shape[1] == 3072:
-                dyn_wkl_dispatcher = load_records(os.environ['DIETCODE_SCHED_LOG_DIR'] + 'dense/saved_schedules_G4/dietcode_autosched_dense_add_16xTx3072x768.json')[1][-1]
-            if W_shape[0] == 2304 and W_shape[1] == 768:
-                dyn_wkl_dispatcher = load_records(os.environ['DIETCODE_SCHED_LOG_DIR'] + 'dense/saved_schedules_G4/dietcode_autosched_dense_add_16xTx768x2304.json')[1][-1]
-            wkl_inst = (X_shape[0] // 16, X_shape[1], W_shape[0])
-        if re.match('^{}.*_fused_nn_batch_matmul$'.format(mangle_prefix), func_name) or \
-           re.match('^{}.*_fused_nn_batch_matmul_[0-9]+$'.format(mangle_prefix), func_name):
-
-            X_shape, W_shape = get_const_tuple(io_tensors[0].shape), \
-                               get_const_tuple(io_tensors[1].shape)
-
-            assert (X_shape[0] == 192 or X_shape[0] == 256) and X_shape[2] == W_shape[2]
-            if X_shape[1] == X_shape[2]:
-                assert W_shape[1] == 64
-                if X_shape[0] == 192:
-                    dyn_wkl_dispatcher = load_records(os.environ['DIETCODE_SCHED_LOG_DIR'] + 'batch_matmul/saved_schedules_G4/dietcode_autosched_batch_matmul_nt_192xTxTx64.json')[1][-1]
-                if X_shape[0] == 256:
-                    dyn_wkl_dispatcher = load_records(os.environ['DIETCODE_SCHED_LOG_DIR'] + 'batch_matmul/saved_schedules_G4/dietcode_autosched_batch_matmul_nt_256xTxTx64.json')[1][-1]
-            if X_shape[1] == W_shape[1]:
-                assert X_shape[2] == 64
-                if X_shape[0] == 192:
-                    dyn_wkl_dispatcher = load_records(os.environ['DIETCODE_SCHED_LOG_DIR'] + 'batch_matmul/saved_schedules_G4/dietcode_autosched_batch_matmul_nt_192xTx64xT.json')[1][-1]
-                if X_shape[0] == 256:
-                    dyn_wkl_dispatcher = load_records(os.environ['DIETCODE_SCHED_LOG_DIR'] + 'batch_matmul/saved_schedules_G4/dietcode_autosched_batch_matmul_nt_256xTx64xT.json')[1][-1]
+        # schedules that are tuned by `tune_parallel_dense` take precedence
+        dyn_wkl_dispatcher, wkl_inst = _query_parallel_dense_dispatcher(func_name, io_tensors)
+        if dyn_wkl_dispatcher is None and 'DIETCODE_SCHED_LOG_DIR' in os.environ:
+            if re.match('^{}.*_fused_nn_dense$'.format(mangle_prefix), func_name) or \
+               re.match('^{}.*_fused_nn_dense_[0-9]+$'.format(mangle_prefix), func_name):
+
+                X_shape, W_shape = get_const_tuple(io_tensors[0].shape), \
+                                   _get_dense_weight_shape(io_tensors)
+
+                if W_shape[0] == 768:
+                    dyn_wkl_dispatcher = load_records(os.environ['DIETCODE_SCHED_LOG_DIR'] + 'dense/saved_schedules_G4/dietcode_autosched_dense_16xTxIx768.json')[1][-1]
+                if W_shape[0] == 3072:
+                    assert W_shape[1] == 768
+                    dyn_wkl_dispatcher = load_records(os.environ['DIETCODE_SCHED_LOG_DIR'] + 'dense/saved_schedules_G4/dietcode_autosched_dense_16xTx768x3072.json')[1][-1]
+                if W_shape[0] == 1024 and W_shape[1] == 4096:
+                    dyn_wkl_dispatcher = load_records(os.environ['DIETCODE_SCHED_LOG_DIR'] + 'dense/saved_schedules_G4/dietcode_autosched_dense_16xTx4096x1024.json')[1][-1]
+                if W_shape[0] == 4096 and W_shape[1] == 1024:
+                    dyn_wkl_dispatcher = load_records(os.environ['DIETCODE_SCHED_LOG_DIR'] + 'dense/saved_schedules_G4/dietcode_autosched_dense_16xTx1024x4096.json')[1][-1]
+                if W_shape[0] == 1024 and W_shape[1] == 1024:
+                    dyn_wkl_dispatcher = load_records(os.environ['DIETCODE_SCHED_LOG_DIR'] + 'dense/saved_schedules_G4/dietcode_autosched_dense_16xTx1024x1024.json')[1][-1]
+                if W_shape[0] == 50257 and W_shape[1] == 768:
+                    dyn_wkl_dispatcher = load_records(os.environ['DIETCODE_SCHED_LOG_DIR'] + 'dense/saved_schedules_G4/dietcode_autosched_dense_16xTx768x50257.json')[1][-1]
+                wkl_inst = (X_shape[0] // 16, X_shape[1], W_shape[0])
+            if re.match('^{}.*_fused_nn_dense_add$'.format(mangle_prefix), func_name) or \
+               re.match('^{}.*_fused_nn_dense_add_[0-9]+$'.format(mangle_prefix), func_name):
+
+                X_shape, W_shape = get_const_tuple(io_tensors[0].shape), \
+                                   _get_dense_weight_shape(io_tensors)
+
+                if W_shape[0] == 768 and W_shape[1] == 768:
+                    dyn_wkl_dispatcher = load_records(os.environ['DIETCODE_SCHED_LOG_DIR'] + 'dense/saved_schedules_G4/dietcode_autosched_dense_add_16xTx768x768.json')[1][-1]
+                if W_shape[0] == 3072 and W_shape[1] == 768:
+                    dyn_wkl_dispatcher = load_records(os.environ['DIETCODE_SCHED_LOG_DIR'] + 'dense/saved_schedules_G4/dietcode_autosched_dense_add_16xTx768x3072.json')[1][-1]
+                if W_shape[0] == 768 and W_shape[1] == 3072:
+                    dyn_wkl_dispatcher = load_records(os.environ['DIETCODE_SCHED_LOG_DIR'] + 'dense/saved_schedules_G4/dietcode_autosched_dense_add_16xTx3072x768.json')[1][-1]
+                if W_shape[0] == 2304 and W_shape[1] == 768:
+                    dyn_wkl_dispatcher = load_records(os.environ['DIETCODE_SCHED_LOG_DIR'] + 'dense/saved_schedules_G4/dietcode_autosched_dense_add_16xTx768x2304.json')[1][-1]
+                wkl_inst = (X_shape[0] // 16, X_shape[1], W_shape[0])
+            if re.match('^{}.*_fused_nn_batch_matmul$'.format(mangle_prefix), func_name) or \
+               re.match('^{}.*_fused_nn_batch_matmul_[0-9]+$'.format(mangle_prefix), func_name):
+
+                X_shape, W_shape = get_const_tuple(io_tensors[0].shape), \
+                                   get_const_tuple(io_tensors[1].shape)
+
+                assert (X_shape[0] == 192 or X_shape[0] == 256) and X_shape[2] == W_shape[2]
+                if X_shape[1] == X_shape[2]:
+                    assert W_shape[1] == 64
+                    if X_shape[0] == 192:
+                        dyn_wkl_dispatcher = load_records(os.environ['DIETCODE_SCHED_LOG_DIR'] + 'batch_matmul/saved_schedules_G4/dietcode_autosched_batch_matmul_nt_192xTxTx64.json')[1][-1]
+                    if X_shape[0] == 256:
+                        dyn_wkl_dispatcher = load_records(os.environ['DIETCODE_SCHED_LOG_DIR'] + 'batch_matmul/saved_schedules_G4/dietcode_autosched_batch_matmul_nt_256xTxTx64.json')[1][-1]
+                if X_shape[1] == W_shape[1]:
+                    assert X_shape[2] == 64
+                    if X_shape[0] == 192:
+                        dyn_wkl_dispatcher = load_records(os.environ['DIETCODE_SCHED_LOG_DIR'] + 'batch_matmul/saved_schedules_G4/dietcode_autosched_batch_matmul_nt_192xTx64xT.json')[1][-1]
+                    if X_shape[0] == 256:
+                        dyn_wkl_dispatcher = load_records(os.environ['DIETCODE_SCHED_LOG_DIR'] + 'batch_matmul/saved_schedules_G4/dietcode_autosched_batch_matmul_nt_256xTx64xT.json')[1][-1]
                 
-            wkl_inst = (X_shape[1],)
+                wkl_inst = (X_shape[1],)
         if dyn_wkl_dispatcher is not None:
 
             print("{}({})".format(func_name, io_tensors))
 
+            # Pack the layout-free tensors (i.e., the weights) into one layout
+            # that is shared by all the dispatched states, so that the packing
+            # can be folded at build time regardless of the sequence length.
+            enable_layout_rewrite = has_layout_free and \
+                    LayoutRewriteOption.get_target_default(target, True) != \
+                        LayoutRewriteOption.NO_REWRITE
+            if enable_layout_rewrite:
+                dyn_wkl_dispatcher, enable_layout_rewrite = \
+                        dyn_wkl_dispatcher.unify_layout_free_tiles()
+                if not enable_layout_rewrite:
+                    logger.warning("Unable to find a packed layout that is shared by all "
+                                   "the dispatched states of %s", func_name)
+
             state = dyn_wkl_dispatcher.dispatch_to_state(wkl_inst)
+
+            env = TracingEnvironment.current
+            if env is not None and env.tracing_mode == TracingMode.PREPARE_LAYOUT_REWRITE:
+                if enable_layout_rewrite:
+                    # record the layout transform for the AutoSchedulerLayoutRewrite pass
+                    dag.rewrite_layout_from_state(state)
+                return None
+
             sched, _ = dag.apply_steps_from_state(state)
 
             # dietcode_jit_kernel = tvm.build(sched, io_tensors, target=tvm.target.Target('nvidia/nvidia-t4'))
@@ -642,7 +886,15 @@ def auto_schedule_topi(func_name, outs):
         # if state is None:
         #     return None
         if query_result is None:
-            return None
+            # A static instance of a dynamic workload (e.g., from a model that is specialized
+            # to its input shapes) takes the state that its dispatcher dispatches it to.
+            dyn_wkl_inst = dispatch_ctx.query_dyn_wkl_inst(target, io_tensors)
+            if dyn_wkl_inst is None:
+                return None
+            dyn_wkl_dispatcher, wkl_inst = dyn_wkl_inst
+            schedule, _ = dag.apply_steps_from_state(
+                dyn_wkl_dispatcher.dispatch_to_state(wkl_inst))
+            return schedule
         state, _ = query_result        
 
         schedule, _ = dag.apply_steps_from_state(state)
@@ -191,6 +191,17 @@ class SketchPolicy(SearchPolicy):
         "max_innermost_split_factor": 64,
         "max_vectorize_size": 16,
         "disable_change_compute_location": 0,
+        # The extra trials that refine the hardware-aligned configurations of `EfficientSearch`
+        # with the evolutionary search (0 runs the one-shot search only)
+        "hybrid_refine_trials": 0,
+        # The binary file to periodically checkpoint the search to and resume it from
+        # ("" disables checkpointing), and the number of search rounds between two checkpoints.
+        # Only the evolutionary search is checkpointed, `EfficientSearch` always starts afresh.
+        "checkpoint_file": "",
+        "checkpoint_interval": 1,
+        # The number of trials w/o improvement after which an instance of a dynamic task stops
+        # receiving trials when tuned by the task scheduler (-1 only checks the roofline)
+        "inst_early_stopping": -1,
     }
 
     def __init__(
@@ -273,3 +284,79 @@ class SketchPolicy(SearchPolicy):
         """
         states = _ffi_api.SketchPolicyEvolutionarySearch(self, init_populations, out_size)
         return states
+
+    def propose_measure_inputs(self, num_measure):
+        """The search phase of `continue_search_one_round`.
+        It does not touch the measurer and releases the GIL, so the search phases of
+        several policies can run on separate threads.
+
+        Parameters
+        ----------
+        num_measure: int
+            The number of programs to measure in this round
+
+        Returns
+        -------
+        inputs: List[MeasureInput]
+            The states to measure
+        """
+        return _ffi_api.SketchPolicyProposeMeasureInputs(self, num_measure)
+
+    def measure_and_update(self, inputs, measurer):
+        """The measurement phase of `continue_search_one_round`.
+
+        Parameters
+        ----------
+        inputs: List[MeasureInput]
+            The states returned by `propose_measure_inputs`
+        measurer: ProgramMeasurer
+            The program measurer to measure programs
+
+        Returns
+        -------
+        num_measure_inputs: int
+            The number of measured states
+        best_measure_avg_latency: float
+            The best latency of the task so far
+        """
+        num_measure_inputs, best_measure_avg_latency = _ffi_api.SketchPolicyMeasureAndUpdate(
+            self, inputs, measurer
+        )
+        return num_measure_inputs.value, best_measure_avg_latency.value
+
+    def save_checkpoint(self, filename, measurer, ct):
+        """Save the search state of the policy and the measurer to a checkpoint file.
+
+        Parameters
+        ----------
+        filename: str
+            The checkpoint file, which is replaced atomically
+        measurer: ProgramMeasurer
+            The program measurer whose per-instance bests are saved along
+        ct: int
+            The number of completed trials
+        """
+        _ffi_api.SketchPolicySaveCheckpoint(self, filename, measurer, ct)
+
+    def load_checkpoint(self, filename, measurer):
+        """Restore the search state saved by `save_checkpoint`.
+
+        Parameters
+        ----------
+        filename: str
+            The checkpoint file
+        measurer: ProgramMeasurer
+            The program measurer to restore the per-instance bests into
+
+        Returns
+        -------
+        ct: int
+            The number of completed trials, -1 if the checkpoint file does not exist
+        """
+        return _ffi_api.SketchPolicyLoadCheckpoint(self, filename, measurer)
+
+    @property
+    def all_insts_converged(self):
+        """Whether all the weighted workload instances of a dynamic task had converged after
+        the last `measure_and_update`, hence the task needs no more trials."""
+        return bool(_ffi_api.SketchPolicyAllInstsConverged(self))
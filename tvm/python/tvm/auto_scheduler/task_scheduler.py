@@ -26,6 +26,7 @@ import os
 import time
 import math
 import logging
+from concurrent.futures import ThreadPoolExecutor, FIRST_COMPLETED, wait
 
 import numpy as np
 
@@ -289,6 +290,7 @@ class TaskScheduler:
         search_policy_params=None,
         adapative_training=False,
         per_task_early_stopping=None,
+        num_concurrent_tasks=1,
     ):
         """Tune a batch of tasks together.
 
@@ -309,6 +311,11 @@ class TaskScheduler:
             too many logs.
         per_task_early_stopping : Optional[int]
             Stop tuning a task early if getting no improvement after n measurements.
+        num_concurrent_tasks : int = 1
+            The number of tasks whose search phases run concurrently on separate threads.
+            The measurements of all the tasks still go through the single measurer (and hence
+            its builder pool) one batch at a time, interleaved in the order their searches
+            finish. Only supported for SketchPolicy.
         """
         # init members
         self.tune_option = tune_option
@@ -354,6 +361,10 @@ class TaskScheduler:
             adapative_training,
         )
 
+        if num_concurrent_tasks > 1:
+            self._tune_concurrently(num_concurrent_tasks)
+            return
+
         # do a round robin first to warm up
         for idx in range(len(self.tasks)):
             # skip warming up this task if it has been tuned before (restored from the log file)
@@ -369,73 +380,7 @@ class TaskScheduler:
         # use the specific strategy to choose workload to tune
         task_idx = -1
         while self.ct < tune_option.num_measure_trials and len(self.dead_tasks) < len(self.tasks):
-            if self.strategy == "round-robin":
-                task_idx = (task_idx + 1) % len(self.tasks)
-                while task_idx in self.dead_tasks:
-                    task_idx = (task_idx + 1) % len(self.tasks)
-            elif self.strategy == "gradient":
-                gradients = []
-                for i in range(len(self.tasks)):
-                    if i in self.dead_tasks:
-                        gradients.append(0)
-                        continue
-
-                    # compute gradient from chain rule : (delta f / delta g_i)
-                    delta = 1e-4
-                    new_costs = list(self.best_costs)
-                    new_costs[i] -= delta
-                    chain_grad = (
-                        self._compute_score(self.best_costs) - self._compute_score(new_costs)
-                    ) / delta
-
-                    # compute (g_i(t_i) - g(t_i - \Delta t)) / (\Delta t)
-                    if (
-                        self.task_cts[i] - 1 < len(self.task_costs_history[i])
-                        and self.task_cts[i] - 1 - self.backward_window_size >= 0
-                    ):
-                        backward_grad = (
-                            self.task_costs_history[i][self.task_cts[i] - 1]
-                            - self.task_costs_history[i][
-                                self.task_cts[i] - 1 - self.backward_window_size
-                            ]
-                        ) / self.backward_window_size
-                    else:
-                        backward_grad = 0
-
-                    # compute (g_i(t_i + \Delta t) - g(t_i)) / (\Delta t)
-                    g_next_1 = self.best_costs[i] - (self.best_costs[i] / self.task_cts[i])
-
-                    g_next_2 = self.beta * 1e30
-                    
-                    
-                    # <bojian/DietCode>
-                    # group_id = self.tag_to_group_id.get(self.task_tags[i], None)
-                    # if group_id is not None and len(self.group_task_ids[group_id]) > 1:
-                    #     best_flops = max(
-                    #         [
-                    #             self.flop_cts[j] / self.best_costs[j]
-                    #             for j in self.group_task_ids[group_id]
-                    #         ]
-                    #     )
-                    #     g_next_2 = self.beta * self.flop_cts[i] / best_flops
-
-                    
-                    g_next = min(g_next_1, g_next_2)
-                    forward_grad = g_next - self.best_costs[i]
-
-                    # combine all grads
-                    grad = chain_grad * (
-                        self.alpha * backward_grad + (1 - self.alpha) * forward_grad
-                    )
-                    assert grad <= 0
-                    gradients.append(grad)
-
-                if max(gradients) == min(gradients):
-                    task_idx = np.random.choice(len(gradients))
-                else:
-                    task_idx = np.argmin(gradients)
-            else:
-                raise ValueError("Invalid strategy: " + self.strategy)
+            task_idx = self._pick_next_task(task_idx)
 
             self._tune_task(task_idx)
 
@@ -443,21 +388,188 @@ class TaskScheduler:
             # <bojian/DietCode>
             # self._adjust_similarity_group(task_idx)
 
-            
-            if self.cur_score < self.best_score:
-                self.best_score = self.cur_score
-                self.best_ct = self.ct
-            elif self.ct - self.best_ct >= self.early_stopping_all and all(
-                cost < 1e9 for cost in self.best_costs
-            ):
-                if self.tune_option.verbose >= 1:
-                    print(
-                        "Stop early since no performance improvement in the last "
-                        + str(self.early_stopping_all)
-                        + " measurement trials."
-                    )
+            if self._check_early_stopping():
                 break
 
+    def _pick_next_task(self, task_idx, busy_tasks=()):
+        """Choose the next task to tune with the scheduling strategy.
+
+        Parameters
+        ----------
+        task_idx: int
+            The task that was tuned last (-1 if none).
+        busy_tasks: Collection[int]
+            The tasks that are being tuned and hence cannot be chosen.
+
+        Returns
+        -------
+        task_idx: Optional[int]
+            The chosen task, None if all the live tasks are busy.
+        """
+        unavailable = self.dead_tasks.union(busy_tasks)
+        if len(unavailable) >= len(self.tasks):
+            return None
+        if self.strategy == "round-robin":
+            task_idx = (task_idx + 1) % len(self.tasks)
+            while task_idx in unavailable:
+                task_idx = (task_idx + 1) % len(self.tasks)
+        elif self.strategy == "gradient":
+            gradients = []
+            for i in range(len(self.tasks)):
+                if i in unavailable:
+                    gradients.append(0)
+                    continue
+
+                # compute gradient from chain rule : (delta f / delta g_i)
+                delta = 1e-4
+                new_costs = list(self.best_costs)
+                new_costs[i] -= delta
+                chain_grad = (
+                    self._compute_score(self.best_costs) - self._compute_score(new_costs)
+                ) / delta
+
+                # compute (g_i(t_i) - g(t_i - \Delta t)) / (\Delta t)
+                if (
+                    self.task_cts[i] - 1 < len(self.task_costs_history[i])
+                    and self.task_cts[i] - 1 - self.backward_window_size >= 0
+                ):
+                    backward_grad = (
+                        self.task_costs_history[i][self.task_cts[i] - 1]
+                        - self.task_costs_history[i][
+                            self.task_cts[i] - 1 - self.backward_window_size
+                        ]
+                    ) / self.backward_window_size
+                else:
+                    backward_grad = 0
+
+                # compute (g_i(t_i + \Delta t) - g(t_i)) / (\Delta t)
+                g_next_1 = self.best_costs[i] - (self.best_costs[i] / self.task_cts[i])
+
+                g_next_2 = self.beta * 1e30
+                
+                
+                # <bojian/DietCode>
+                # group_id = self.tag_to_group_id.get(self.task_tags[i], None)
+                # if group_id is not None and len(self.group_task_ids[group_id]) > 1:
+                #     best_flops = max(
+                #         [
+                #             self.flop_cts[j] / self.best_costs[j]
+                #             for j in self.group_task_ids[group_id]
+                #         ]
+                #     )
+                #     g_next_2 = self.beta * self.flop_cts[i] / best_flops
+
+                
+                g_next = min(g_next_1, g_next_2)
+                forward_grad = g_next - self.best_costs[i]
+
+                # combine all grads
+                grad = chain_grad * (
+                    self.alpha * backward_grad + (1 - self.alpha) * forward_grad
+                )
+                assert grad <= 0
+                gradients.append(grad)
+
+            if max(gradients) == min(gradients):
+                task_idx = np.random.choice(
+                    [i for i in range(len(self.tasks)) if i not in unavailable]
+                )
+            else:
+                task_idx = np.argmin(gradients)
+        else:
+            raise ValueError("Invalid strategy: " + self.strategy)
+        return task_idx
+
+    def _check_early_stopping(self):
+        """Update the best score and check whether the whole tuning should stop early"""
+        if self.cur_score < self.best_score:
+            self.best_score = self.cur_score
+            self.best_ct = self.ct
+        elif self.ct - self.best_ct >= self.early_stopping_all and all(
+            cost < 1e9 for cost in self.best_costs
+        ):
+            if self.tune_option.verbose >= 1:
+                print(
+                    "Stop early since no performance improvement in the last "
+                    + str(self.early_stopping_all)
+                    + " measurement trials."
+                )
+            return True
+        return False
+
+    def _tune_concurrently(self, num_concurrent_tasks):
+        """Overlap the search phases of several tasks with the measurements of the others.
+
+        The search phases run on a thread pool (the GIL is released inside the C++ search),
+        while the main thread drains a single measurement queue in the order the searches
+        finish, so that the builder and the device are never shared by two batches. The cost
+        model that the policies may share serializes its updates and predictions.
+        """
+        for policy in self.search_policies:
+            assert isinstance(
+                policy, SketchPolicy
+            ), "Concurrent tuning requires the search phase of SketchPolicy"
+
+        # warm up every task that has not been tuned before, then follow the strategy
+        warmup_tasks = [idx for idx in range(len(self.tasks)) if not self.task_cts[idx]]
+        num_warmup_left = len(warmup_tasks)
+        if not num_warmup_left:
+            self.best_ct = self.ct
+            self.best_score = self.cur_score
+        searching = {}  # future -> task_idx
+        task_idx = -1
+        stopped = False
+
+        with ThreadPoolExecutor(max_workers=num_concurrent_tasks) as executor:
+
+            def launch_searches():
+                nonlocal task_idx
+                while len(searching) < num_concurrent_tasks:
+                    if warmup_tasks:
+                        next_task_idx = warmup_tasks.pop(0)
+                    elif (
+                        not stopped
+                        and num_warmup_left == 0
+                        and self.ct < self.tune_option.num_measure_trials
+                    ):
+                        next_task_idx = self._pick_next_task(task_idx, searching.values())
+                    else:
+                        next_task_idx = None
+                    if next_task_idx is None:
+                        break
+                    task_idx = next_task_idx
+                    future = executor.submit(
+                        self.search_policies[task_idx].propose_measure_inputs,
+                        self.num_measures_per_round,
+                    )
+                    searching[future] = task_idx
+
+            launch_searches()
+            while searching:
+                done, _ = wait(searching, return_when=FIRST_COMPLETED)
+                # measure one batch at a time and refill the search threads right after it
+                future = next(iter(done))
+                done_task_idx = searching.pop(future)
+                inputs = future.result()
+
+                for callback in self.callbacks:
+                    callback.pre_tune(self, done_task_idx)
+                num_measure_inputs, best_measure_avg_latency = self.search_policies[
+                    done_task_idx
+                ].measure_and_update(inputs, self.measurer)
+                self._record_tune_result(
+                    done_task_idx, num_measure_inputs, best_measure_avg_latency
+                )
+
+                if num_warmup_left > 0:
+                    num_warmup_left -= 1
+                    if num_warmup_left == 0:
+                        self.best_ct = self.ct
+                        self.best_score = self.cur_score
+                elif self._check_early_stopping():
+                    stopped = True
+                launch_searches()
+
     def _tune_task(self, task_idx):
         """Tune the select task for one round"""
 
@@ -480,6 +592,10 @@ class TaskScheduler:
         # print("num_measure_inputs={}, best_measure_avg_latency={}"
         #       .format(num_measure_inputs, best_measure_avg_latency))
 
+        self._record_tune_result(task_idx, num_measure_inputs, best_measure_avg_latency)
+
+    def _record_tune_result(self, task_idx, num_measure_inputs, best_measure_avg_latency):
+        """Update the status of the task scheduler after tuning the selected task for one round"""
         self.task_cts[task_idx] += 1
 
         # <bojian/DietCode>
@@ -503,6 +619,9 @@ class TaskScheduler:
         if num_measure_inputs == 0 \
            or no_change_trials > self.early_stopping_task:
             self.dead_tasks.add(task_idx)
+        policy = self.search_policies[task_idx]
+        if isinstance(policy, SketchPolicy) and policy.all_insts_converged:
+            self.dead_tasks.add(task_idx)
 
         self.task_costs_history[task_idx].append(self.best_costs[task_idx])
 
@@ -35,7 +35,7 @@ import pickle
 import json
 
 import tvm._ffi
-from tvm.runtime._ffi_node_api import LoadJSON, SaveJSON
+from tvm.runtime._ffi_node_api import LoadBinary, SaveBinary
 from .utils import serialize_args, deserialize_args, get_func_name
 
 logger = logging.getLogger("auto_scheduler")
@@ -235,7 +235,7 @@ def serialize_workload_registry_entry(workload_key):
     svalue = WORKLOAD_FUNC_REGISTRY[sname]
     if not callable(svalue):
         # pylint: disable=assignment-from-no-return
-        svalue = SaveJSON(svalue)
+        svalue = SaveBinary(svalue)
 
     return sname, svalue
 
@@ -256,7 +256,7 @@ def deserialize_workload_registry_entry(data):
     if name not in WORKLOAD_FUNC_REGISTRY:
         # pylint: disable=assignment-from-no-return
         if not callable(value):
-            value = LoadJSON(value)
+            value = LoadBinary(bytearray(value))
         WORKLOAD_FUNC_REGISTRY[name] = value
 
 
@@ -166,6 +166,52 @@ def _train_decision_tree(wkl_insts, wkl_inst_id_state_ver_map):
     return tree_classifier
 
 
+def _make_host_dispatch_mod(tree, shape_vars, tensors, state_ver_ir_mod_map, name):
+    """Make the function that dispatches over the state versions on the host,
+    for the targets (e.g., llvm) whose kernels are host functions and hence have
+    no kernel launch to inline the dispatching into. The body of each state
+    version is inlined into the leaf of the decision tree that selects it, and
+    the shape variables are bound from the shapes of the tensor arguments.
+    """
+    from sklearn.tree import _tree
+
+    tree_ = tree.tree_
+    buffers = [tvm.tir.decl_buffer(t.shape, t.dtype, t.op.name) for t in tensors]
+    # the shape variables are matched by their names, as those of the compute
+    # DAG, of the search task and of each state version are distinct objects
+    dag_shape_vars = {}
+    for buffer in buffers:
+        for dim in buffer.shape:
+            if isinstance(dim, (Var, tvm.tir.DynShapeVar)):
+                dag_shape_vars[dim.name] = dim
+    shape_vars = [dag_shape_vars.get(shape_var.name, shape_var) for shape_var in shape_vars]
+
+    state_ver_bodies = {}
+    for state_ver, ir_mod in state_ver_ir_mod_map.items():
+        kernel = ir_mod["{}_{}_{}".format(name, state_ver.major, state_ver.minor)]
+        vmap = {}
+        for param, buffer in zip(kernel.params, buffers):
+            vmap[kernel.buffer_map[param].data] = buffer.data
+        for param in kernel.params[len(buffers):]:
+            vmap[param] = dag_shape_vars[param.name]
+        state_ver_bodies[(int(state_ver.major), int(state_ver.minor))] = \
+                tvm.tir.stmt_functor.substitute(kernel.body, vmap)
+
+    def _recurse(node=0):
+        if tree_.feature[node] != _tree.TREE_UNDEFINED:
+            return tvm.tir.IfThenElse(
+                shape_vars[tree_.feature[node]] <= int(tree_.threshold[node]),
+                _recurse(tree_.children_left[node]),
+                _recurse(tree_.children_right[node]))
+        return state_ver_bodies[(int(tree_.value[node][0][0]), int(tree_.value[node][1][0]))]
+
+    params = [tvm.tir.Var(buffer.name, "handle") for buffer in buffers]
+    dispatch_func = PrimFunc(params, _recurse(), buffer_map=dict(zip(params, buffers)))
+    dispatch_func = dispatch_func.with_attr("global_symbol", name)
+    dispatch_func = dispatch_func.with_attr("tir.noalias", True)
+    return IRModule({name: dispatch_func})
+
+
 _check_no_opt_status = \
         tvm.tir.transform.Filter(
             lambda f: "already_opt" not in f.attrs or
@@ -280,10 +326,6 @@ def lower_dyn_wkl_dispatcher(
     
     shape_vars = dyn_wkl_dispatcher.search_task.shape_vars
 
-    tree_classifier_nodes = _convert_decision_tree(tree, shape_vars)
-    tree_classifier_root = tree_classifier_nodes[0]
-    print(tree_classifier_root)
-
     input_mods = []
     for _, ir_mod in state_ver_ir_mod_map.items():
         input_mods.append(ir_mod)
@@ -294,6 +336,16 @@ def lower_dyn_wkl_dispatcher(
                                 )
     merged_mod_host, merged_mod_dev = _split_host_device(merged_mod)
 
+    tensor_args = dyn_wkl_dispatcher.search_task.compute_dag.tensors
+    if not merged_mod_dev.functions:
+        dispatch_mod_host, _ = _split_host_device(
+            _make_host_dispatch_mod(tree, shape_vars, tensor_args, state_ver_ir_mod_map, name))
+        return [_opt_host(target_host)(dispatch_mod_host), list(tensor_args)]
+
+    tree_classifier_nodes = _convert_decision_tree(tree, shape_vars)
+    tree_classifier_root = tree_classifier_nodes[0]
+    print(tree_classifier_root)
+
     skeleton_mod = dyn_wkl_dispatcher.get_skeleton(name)
     skeleton_mod_host, _ = _split_host_device(skeleton_mod)
 
@@ -157,6 +157,39 @@ def save_json(node):
     return tvm.runtime._ffi_node_api.SaveJSON(node)
 
 
+def load_binary(data):
+    """Load tvm object from the bytes produced by :code:`save_binary`.
+
+    Parameters
+    ----------
+    data : bytes
+        The serialized bytes
+
+    Returns
+    -------
+    node : Object
+        The loaded tvm node.
+    """
+    return tvm.runtime._ffi_node_api.LoadBinary(bytearray(data))
+
+
+def save_binary(node):
+    """Save tvm object in the compact binary format, which is smaller and
+    faster to (de)serialize than json, but cannot be upgraded across versions.
+
+    Parameters
+    ----------
+    node : Object
+        A TVM object to be saved.
+
+    Returns
+    -------
+    data : bytes
+        Saved bytes.
+    """
+    return tvm.runtime._ffi_node_api.SaveBinary(node)
+
+
 def structural_equal(lhs, rhs, map_free_vars=False):
     """Check structural equality of lhs and rhs.
 
@@ -560,3 +560,9 @@ class StorageInfo(Node):
     @property
     def storage_sizes(self):
         return _ffi_api.StorageInfoStorageSizes(self)
+
+    @property
+    def storage_offsets(self):
+        """The byte offsets within the storages, empty unless planned by the
+        interval packing."""
+        return _ffi_api.StorageInfoStorageOffsets(self)
@@ -492,6 +492,23 @@ class VirtualMachine(object):
         """
         return [self._get_output(i) for i in range(self._get_num_outputs())]
 
+    def set_trace_mode(self, max_num_signatures):
+        """Enable or disable the trace mode, which is limited to the host.
+
+        In the trace mode, the first invocation of a function for an input-shape
+        signature records the packed function calls that it executes, and the
+        later invocations with the same signature replay them without
+        interpreting the bytecode. The signatures whose control flow depends on
+        the values of the inputs are detected and interpreted instead.
+
+        Parameters
+        ----------
+        max_num_signatures : int
+            The maximum number of traced signatures, beyond which the least
+            recently used traces are dropped. 0 disables the trace mode.
+        """
+        self.module["set_trace_mode"](max_num_signatures)
+
     def get_input_index(self, input_name, func_name="main"):
         """Get inputs index via input name.
         Parameters
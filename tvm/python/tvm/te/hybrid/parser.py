@@ -374,6 +374,8 @@ class HybridParser(ast.NodeVisitor):
 
     def visit_Subscript(self, node):
         args = self.visit(node.slice)
+        if not isinstance(node.slice, (ast.Index, ast.Tuple)) and not isinstance(args, (list, tuple)):
+            args = [args]
         arr = self.visit(node.value)
         if isinstance(arr, Array):
             for i in args:
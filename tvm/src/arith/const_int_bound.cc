@@ -121,6 +121,11 @@ class ConstIntBoundAnalyzer::Impl
 
   // <bojian/DietCode>
   Entry VisitExpr_(const DynShapeVarNode* op) final {
+    // the dynamic shape variables that have been bound, e.g., to their upper bounds
+    auto it = var_map_.find(GetRef<Var>(op));
+    if (it != var_map_.end()) {
+      return it->second;
+    }
     // if (op->possible_values.empty()) {
     return Everything(op->dtype);
     // }
@@ -62,8 +62,10 @@ AutoSchedule(SearchPolicy search_policy, TuningOptions tuning_options) {
   // Search for the best schedule
   std::vector<State> states;
   std::unordered_map<size_t, size_t> inst_disp_map;
-  // <efficient>
-  if (search_policy->search_task->hardware_api->num_level != 0) {
+  // <efficient> Without a measurement budget, dynamic tasks take the zero-measurement path of
+  //             `Search` instead.
+  if (search_policy->search_task->hardware_api->num_level != 0 &&
+      !(IsDynTask(search_policy->search_task) && tuning_options->num_measure_trials <= 1)) {
     std::tie(states, inst_disp_map) = search_policy->EfficientSearch(measurer);
   } else {
     std::tie(states, inst_disp_map) =
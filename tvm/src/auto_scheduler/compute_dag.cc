@@ -1333,9 +1333,14 @@ std::tuple<Array<IntImm>, double, float> ComputeDAG::CherryPickAlignHardwareWork
 
   // std::vector<float> adapted_scores;
 
+  // the grid extents of row reductions only depend on the state
+  Optional<Array<PrimExpr>> grid_extents;
+  if (IsRowReductionTask(task)) {
+    grid_extents = GetRowReductionGridExtents(task, state_mutable_copy);
+  }
   for (const Array<IntImm>& wkl_inst : task->wkl_insts) {
     AlignHWAdaptStateToWorkload(task, state_mutable_copy, wkl_inst, base_score, &occupancy_penalty,
-                                &padding_penalty, &adapted_score);
+                                &padding_penalty, &adapted_score, grid_extents);
 
     // adapted_scores.push_back(adapted_score);
 
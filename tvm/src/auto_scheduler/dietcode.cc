@@ -3,8 +3,12 @@
 // <bojian/DietCode>
 #include <tvm/driver/driver_api.h>
 #include <tvm/ir/function.h>
+#include <tvm/tir/stmt_functor.h>
 #include <tvm/tir/transform.h>
 
+#include <set>
+#include <string>
+
 #include "./utils.h"
 
 
@@ -47,6 +51,38 @@ State DynWklDispatcherNode::DispatchToState(const int wkl_id) const {
   return states[inst_disp_map.at(wkl_id)];
 }
 
+double DynWklDispatcherNode::PredictLatency(const Array<IntImm>& wkl_inst) const {
+  CHECK(search_task->shape_vars != nullptr);
+  float occupancy_penalty, padding_penalty, adapted_score;
+  // the fraction of the peak throughput that a state achieves on the instance
+  auto get_efficiency = [&](const State& state) -> float {
+    AlignHWAdaptStateToWorkload(search_task, state, wkl_inst, 1., &occupancy_penalty,
+                                &padding_penalty, &adapted_score);
+    return occupancy_penalty * padding_penalty;
+  };
+
+  float efficiency = 0.;
+  size_t wkl_id = 0;
+  for (; wkl_id < search_task->wkl_insts.size(); ++wkl_id) {
+    if (StructuralEqual()(search_task->wkl_insts[wkl_id], wkl_inst)) {
+      break;
+    }
+  }
+  if (wkl_id < search_task->wkl_insts.size()) {
+    efficiency = get_efficiency(DispatchToState(wkl_id));
+  } else {
+    for (const State& state : states) {
+      efficiency = std::max(efficiency, get_efficiency(state));
+    }
+  }
+  CHECK(efficiency > 0) << "No state can be adapted to " << wkl_inst;
+
+  double inst_flop =
+      EstimateFlopForInst(search_task->compute_dag, search_task->shape_vars.value(), wkl_inst);
+  double peak_flops = search_task->hardware_api->peak_flops;
+  return inst_flop / (peak_flops > 0 ? peak_flops : 1.) / efficiency;
+}
+
 void
 DynWklDispatcherNode::EmbedComputeDAG(const ComputeDAG& compute_dag) {
   SearchTaskNode* const mutable_search_task = search_task.CopyOnWrite();
@@ -74,6 +110,255 @@ DynWklDispatcherNode::GetSkeleton(const String& name) const {
 }
 
 
+namespace {
+
+// Whether the split step splits an axis whose extent is independent of all the
+// shape variables. Such axes do not vary across the workload instances.
+bool IsStaticExtentSplit(const SplitStepNode* const split_step) {
+  if (!split_step->extent.defined()) {
+    return false;
+  }
+  bool has_dyn_shape_var = false;
+  tir::PostOrderVisit(split_step->extent.value(), [&has_dyn_shape_var](const ObjectRef& node) {
+    if (node->IsInstance<DynShapeVarNode>()) {
+      has_dyn_shape_var = true;
+    }
+  });
+  return !has_dyn_shape_var;
+}
+
+// Whether two states are generated from the same sketch, i.e., whether they
+// only differ in the split factors.
+bool HaveSameSketch(const State& lhs, const State& rhs) {
+  if (lhs->transform_steps.size() != rhs->transform_steps.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < lhs->transform_steps.size(); ++i) {
+    const Step& lhs_step = lhs->transform_steps[i];
+    const Step& rhs_step = rhs->transform_steps[i];
+    if (lhs_step->type_index() != rhs_step->type_index() ||
+        lhs_step->stage_id != rhs_step->stage_id) {
+      return false;
+    }
+    if (const SplitStepNode* const lhs_split = lhs_step.as<SplitStepNode>()) {
+      const SplitStepNode* const rhs_split = rhs_step.as<SplitStepNode>();
+      if (lhs_split->iter_id != rhs_split->iter_id ||
+          lhs_split->lengths.size() != rhs_split->lengths.size()) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Get the name of the original axis that an iterator is split from (e.g., "j"
+// for "j.0" and "j.c"). Fused iterators mix several original axes, and hence
+// have an empty base name.
+std::string IterBaseName(const std::string& name) {
+  if (name.find('@') != std::string::npos) {
+    return "";
+  }
+  return name.substr(0, name.find('.'));
+}
+
+// Get the base names of the axes of an op that index its layout-free
+// placeholders (e.g., the I/H axes of the weight in a dense layer).
+std::set<std::string> GetLayoutFreeAxisNames(
+    const te::Operation& op, const std::set<std::string>& layout_free_placeholder_names) {
+  std::set<std::string> axis_names;
+  const te::ComputeOpNode* const compute_op = op.as<te::ComputeOpNode>();
+  if (compute_op == nullptr) {
+    return axis_names;
+  }
+  for (const PrimExpr& expr : compute_op->body) {
+    tir::PostOrderVisit(expr, [&](const ObjectRef& node) {
+      const ProducerLoadNode* const load = node.as<ProducerLoadNode>();
+      if (load == nullptr ||
+          !layout_free_placeholder_names.count(Downcast<te::Tensor>(load->producer)->op->name)) {
+        return;
+      }
+      for (const PrimExpr& index : load->indices) {
+        tir::PostOrderVisit(index, [&axis_names](const ObjectRef& index_node) {
+          const VarNode* const var = index_node.as<VarNode>();
+          if (var != nullptr && !index_node->IsInstance<DynShapeVarNode>()) {
+            axis_names.insert(IterBaseName(var->name_hint));
+          }
+        });
+      }
+    });
+  }
+  return axis_names;
+}
+
+// Mark the split steps of the state that split an axis of a layout-free
+// placeholder. The steps are replayed on the initial state so that every split
+// step sees the stages (including the cache stages) that exist at its time.
+std::vector<bool> GetLayoutFreeSplitSteps(const ComputeDAG& dag, const State& state) {
+  std::vector<bool> is_layout_free_split(state->transform_steps.size(), false);
+  std::set<std::string> layout_free_placeholder_names;
+  for (const te::Operation& op : dag->ops) {
+    if (const te::ComputeOpNode* const compute_op = op.as<te::ComputeOpNode>()) {
+      auto it = compute_op->attrs.find(ComputeDAG::layout_free_placeholders_key);
+      if (it == compute_op->attrs.end()) {
+        continue;
+      }
+      for (const te::Tensor& placeholder : Downcast<Array<te::Tensor>>((*it).second)) {
+        layout_free_placeholder_names.insert(placeholder->op->name);
+      }
+    }
+  }
+  if (layout_free_placeholder_names.empty()) {
+    return is_layout_free_split;
+  }
+  State replay_state = dag->init_state;
+  for (size_t step_id = 0; step_id < state->transform_steps.size(); ++step_id) {
+    const Step& step = state->transform_steps[step_id];
+    if (const SplitStepNode* const split_step = step.as<SplitStepNode>()) {
+      const Stage& stage = replay_state->stages[split_step->stage_id];
+      const std::string iter_base_name = IterBaseName(stage->iters[split_step->iter_id]->name);
+      is_layout_free_split[step_id] =
+          !iter_base_name.empty() &&
+          GetLayoutFreeAxisNames(stage->op, layout_free_placeholder_names).count(iter_base_name);
+    }
+    replay_state.CopyOnWrite()->transform_steps.push_back(step);
+    StepApplyToState(step, &replay_state, dag);
+  }
+  return is_layout_free_split;
+}
+
+// Whether the state stays within the per-block thread, vthread and shared
+// memory limits of the hardware. Extents that depend on the shape variables
+// are not checked.
+bool IsWithinHardwareLimits(const SearchTask& search_task, const State& state) {
+  if (!search_task->hardware_params.defined()) {
+    return true;
+  }
+  const HardwareParams& hardware_params = search_task->hardware_params;
+  const State bound_state = search_task->compute_dag.InferBound(state);
+  int64_t shared_memory_bytes = 0;
+  for (const Stage& stage : bound_state->stages) {
+    int64_t num_threads = 1, num_vthreads = 1, num_elems = 1;
+    bool is_const_extent = true;
+    for (const Iterator& iter : stage->iters) {
+      const IntImmNode* const extent =
+          iter->range.defined() ? iter->range->extent.as<IntImmNode>() : nullptr;
+      if (extent == nullptr) {
+        is_const_extent = false;
+        continue;
+      }
+      num_elems *= extent->value;
+      if (iter->annotation == IteratorAnnotation::kThreadX ||
+          iter->annotation == IteratorAnnotation::kThreadY ||
+          iter->annotation == IteratorAnnotation::kThreadZ) {
+        num_threads *= extent->value;
+      } else if (iter->annotation == IteratorAnnotation::kVThread) {
+        num_vthreads *= extent->value;
+      }
+    }
+    // stages without any thread binding (e.g., on CPUs) are not limited
+    if ((num_threads > 1 && num_threads > hardware_params->max_threads_per_block) ||
+        (num_vthreads > 1 && num_vthreads > hardware_params->max_vthread_extent)) {
+      return false;
+    }
+    if (is_const_extent && StrEndsWith(stage->op->name, ".shared")) {
+      shared_memory_bytes += num_elems * stage->op->output_dtype(0).bytes();
+    }
+  }
+  return shared_memory_bytes == 0 ||
+         shared_memory_bytes <= hardware_params->max_shared_memory_per_block;
+}
+
+// Replay the transform steps on the initial state of the DAG.
+State ReplaySteps(const ComputeDAG& dag, const Array<Step>& transform_steps) {
+  State state = dag->init_state;
+  for (const Step& step : transform_steps) {
+    state.CopyOnWrite()->transform_steps.push_back(step);
+    StepApplyToState(step, &state, dag);
+  }
+  return state;
+}
+
+}  // namespace anonymous
+
+
+std::pair<DynWklDispatcher, size_t>
+UnifyLayoutFreeTiles(const DynWklDispatcher& dispatcher) {
+  const SearchTask& search_task = dispatcher->search_task;
+  if (dispatcher->states.size() <= 1) {
+    return std::make_pair(dispatcher, 0);
+  }
+  // pick the state that serves the largest total instance weight
+  std::vector<double> state_weights(dispatcher->states.size(), 0.);
+  for (const auto& inst_state_pair : dispatcher->inst_disp_map) {
+    state_weights[inst_state_pair.second] +=
+        search_task->wkl_inst_weights.empty()
+            ? 1.
+            : search_task->wkl_inst_weights[inst_state_pair.first]->value;
+  }
+  const size_t packing_state_id =
+      std::max_element(state_weights.begin(), state_weights.end()) - state_weights.begin();
+  const State& packing_state = dispatcher->states[packing_state_id];
+  // only the splits of the axes that index the layout-free placeholders
+  // determine the packed layout, the other ones are left as they are tuned
+  const std::vector<bool> is_layout_free_split =
+      GetLayoutFreeSplitSteps(search_task->compute_dag, packing_state);
+
+  std::vector<State> unified_states;
+  size_t num_incompatible_states = 0;
+  for (size_t state_id = 0; state_id < dispatcher->states.size(); ++state_id) {
+    const State& state = dispatcher->states[state_id];
+    if (state_id == packing_state_id) {
+      unified_states.push_back(state);
+      continue;
+    }
+    if (!HaveSameSketch(state, packing_state)) {
+      LOG(WARNING) << "state_id=" << state_id << " is not generated from the same sketch as "
+                      "the packing state and hence keeps its own layout";
+      ++num_incompatible_states;
+      unified_states.push_back(state);
+      continue;
+    }
+    Array<Step> transform_steps = state->transform_steps;
+    bool is_changed = false;
+    for (size_t step_id = 0; step_id < transform_steps.size(); ++step_id) {
+      const SplitStepNode* const split_step = transform_steps[step_id].as<SplitStepNode>();
+      if (split_step == nullptr || !is_layout_free_split[step_id] ||
+          !IsStaticExtentSplit(split_step)) {
+        continue;
+      }
+      const SplitStepNode* const packing_split_step =
+          packing_state->transform_steps[step_id].as<SplitStepNode>();
+      if (StructuralEqual()(split_step->lengths, packing_split_step->lengths)) {
+        continue;
+      }
+      transform_steps.Set(
+          step_id, SplitStep(split_step->stage_id, split_step->iter_id, split_step->extent,
+                             packing_split_step->lengths, split_step->inner_to_outer));
+      is_changed = true;
+    }
+    if (!is_changed) {
+      unified_states.push_back(state);
+      continue;
+    }
+    // the new tiles can exceed the hardware limits (e.g., the number of
+    // threads per block), in which case the state keeps its own layout
+    State unified_state = ReplaySteps(search_task->compute_dag, transform_steps);
+    if (!IsWithinHardwareLimits(search_task, unified_state)) {
+      LOG(WARNING) << "state_id=" << state_id << " exceeds the hardware limits with the tiles "
+                      "of the packing state and hence keeps its own layout";
+      ++num_incompatible_states;
+      unified_states.push_back(state);
+      continue;
+    }
+    unified_states.push_back(std::move(unified_state));
+  }
+  std::unordered_map<size_t, size_t> inst_disp_map = dispatcher->inst_disp_map;
+  return std::make_pair(
+      DynWklDispatcher(search_task, std::move(unified_states), std::move(inst_disp_map)),
+      num_incompatible_states);
+}
+
+
 static inline size_t BitVectorToInt(const std::vector<bool>& bit_vector) {
   size_t ret = 0;
   for (const bool b : bit_vector) {
@@ -166,6 +451,18 @@ DynWklDispatcherNode::GenerateAndCompressIRMods(const String& prefix) const {
 }
 
 
+TVM_REGISTER_GLOBAL("auto_scheduler.DynWklDispatcher")
+    .set_body_typed([](const SearchTask& search_task, const Array<State>& states,
+                       const Map<Integer, Integer>& inst_disp_map) {
+      std::vector<State> state_vec(states.begin(), states.end());
+      std::unordered_map<size_t, size_t> inst_disp_umap;
+      for (const auto& kv_pair : inst_disp_map) {
+        inst_disp_umap[kv_pair.first->value] = kv_pair.second->value;
+      }
+      return DynWklDispatcher(search_task, std::move(state_vec), std::move(inst_disp_umap));
+    });
+
+
 TVM_REGISTER_GLOBAL("auto_scheduler.DispatcherDispatch")
     .set_body_typed([](const DynWklDispatcher& dispatcher, const int wkl_id) {
       return dispatcher->Dispatch(wkl_id);
@@ -203,6 +500,21 @@ TVM_REGISTER_GLOBAL("auto_scheduler.DispatcherInstDispMap")
       return inst_disp_map;
     });
 
+TVM_REGISTER_GLOBAL("auto_scheduler.DispatcherPredictLatency")
+    .set_body_typed([](const DynWklDispatcher& dispatcher,
+                       const Array<IntImm>& wkl_inst) {
+      return dispatcher->PredictLatency(wkl_inst);
+    });
+
+TVM_REGISTER_GLOBAL("auto_scheduler.DispatcherUnifyLayoutFreeTiles")
+    .set_body_typed([](const DynWklDispatcher& dispatcher) {
+      DynWklDispatcher unified_dispatcher;
+      size_t num_incompatible_states;
+      std::tie(unified_dispatcher, num_incompatible_states) =
+          UnifyLayoutFreeTiles(dispatcher);
+      return Array<ObjectRef>{unified_dispatcher, Integer(num_incompatible_states)};
+    });
+
 TVM_REGISTER_GLOBAL("auto_scheduler.DispatcherEmbedComputeDAG")
     .set_body_typed([](DynWklDispatcher dispatcher,
                        const ComputeDAG& compute_dag) {
@@ -1291,6 +1291,10 @@ extern bool enable_verbose_logging;
 
 void GetPerStoreFeaturesWorkerFunc(const SearchTask& task, const State& state, int max_n_bufs,
                                    std::vector<float>* feature, std::atomic<int>* error_ct) {
+  // <efficient>
+  // The schedule and the lowered function are thrown away once the features
+  // are extracted, so allocate their nodes from an arena.
+  runtime::ObjectArenaScope arena_scope;
   te::Schedule sch;
   Array<te::Tensor> tensors;
 
@@ -1760,10 +1764,24 @@ TVM_REGISTER_GLOBAL("auto_scheduler.GetPerStoreFeatureNames")
     });
 
 // <efficient>
+Array<PrimExpr> GetRowReductionGridExtents(const SearchTask& task, const State& state) {
+  Array<PrimExpr> grid_extents;
+  const State bound_state = task->compute_dag.InferBound(state);
+  for (const Stage& stage : bound_state->stages) {
+    for (const Iterator& iter : stage->iters) {
+      if (iter->annotation == IteratorAnnotation::kBlockX && iter->range.defined()) {
+        grid_extents.push_back(iter->range->extent);
+      }
+    }
+  }
+  return grid_extents;
+}
+
 void AlignHWAdaptStateToWorkload(const SearchTask& task, const State& state,
                                  const Array<IntImm>& wkl_inst, const float score,
                                  float* const occupancy_penalty, float* const padding_penalty,
-                                 float* const adapted_score) {
+                                 float* const adapted_score,
+                                 const Optional<Array<PrimExpr>>& row_reduction_grid_extents) {
   Map<String, IntImm> shape_var_value_map;
   Array<DynShapeVar> shape_vars = task->shape_vars.value();
   CHECK(shape_vars.size() == wkl_inst.size());
@@ -1787,10 +1805,18 @@ void AlignHWAdaptStateToWorkload(const SearchTask& task, const State& state,
   arith::Analyzer analyzer;
 
   size_t grid_size = 1;
+  // The states of row reductions (see InitEfficientRowReduction) are not multi-level tiled, and
+  // their single-level splits are the cross-thread reductions.
+  Optional<Array<PrimExpr>> grid_extents = row_reduction_grid_extents;
+  if (!grid_extents.defined() && IsRowReductionTask(task)) {
+    grid_extents = GetRowReductionGridExtents(task, state);
+  }
+  const bool is_row_reduction = grid_extents.defined();
   *padding_penalty = 1.;
   for (const Step& step : state->transform_steps) {
     if (const SplitStepNode* const split_step = step.as<SplitStepNode>()) {
-      if (split_step->lengths.size() == 3 || split_step->lengths.size() == 2) {
+      if (split_step->lengths.size() == 3 || split_step->lengths.size() == 2 ||
+          (split_step->lengths.size() == 1 && is_row_reduction)) {
         int64_t extent = GetIntImm(analyzer.Simplify(replacer(split_step->extent.value())));
         int64_t split_length = 1;
 
@@ -1810,6 +1836,13 @@ void AlignHWAdaptStateToWorkload(const SearchTask& task, const State& state,
       }  // if (split_step->lengths.size() == 4)
     }    // if (split_step = step.as<SplitStepNode>())
   }      // for (step ∈ state->transform_steps)
+  if (is_row_reduction) {
+    // The grid of row reductions is given by the largest blockIdx.x among their kernels.
+    for (const PrimExpr& grid_extent : grid_extents.value()) {
+      grid_size = std::max(grid_size, static_cast<size_t>(GetIntImm(
+                                          analyzer.Simplify(replacer(grid_extent)))));
+    }
+  }
   float coeff = grid_size < static_cast<size_t>(task->hardware_params->num_cores)
                     ? task->hardware_api->lt_ratio
                     : task->hardware_api->gt_ratio;
@@ -1827,6 +1860,122 @@ void AlignHWAdaptStateToWorkload(const SearchTask& task, const State& state,
   // }
 }
 
+float EstimateRowReductionEfficiency(const SearchTask& task, const State& state,
+                                     const Array<IntImm>& wkl_inst) {
+  Map<String, IntImm> shape_var_value_map;
+  Array<DynShapeVar> shape_vars = task->shape_vars.value();
+  CHECK(shape_vars.size() == wkl_inst.size());
+  for (size_t i = 0; i < shape_vars.size(); ++i) {
+    shape_var_value_map.Set(shape_vars[i]->name_hint, wkl_inst[i]);
+  }
+  DynShapeVarReplacer replacer([&shape_var_value_map](const DynShapeVarNode* op) -> PrimExpr {
+    auto shape_var_value_map_iter = shape_var_value_map.find(op->name_hint);
+    CHECK(shape_var_value_map_iter != shape_var_value_map.end())
+        << "Dynamic Axis Node " << GetRef<DynShapeVar>(op) << " has not been found in "
+        << MapToString(shape_var_value_map);
+    return (*shape_var_value_map_iter).second;
+  });
+  arith::Analyzer analyzer;
+
+  // the number of threads that access the global memory concurrently
+  const int64_t num_lanes = task->hardware_api->mem_max_core.empty()
+                                ? static_cast<int64_t>(task->hardware_params->num_cores) *
+                                      task->hardware_params->max_threads_per_block
+                                : task->hardware_api->mem_max_core.back()->value;
+  const size_t max_vector_width = std::max(
+      task->hardware_params->vector_unit_bytes / task->compute_dag->tensors.back()->dtype.bytes(),
+      1);
+  const State& init_state = task->compute_dag->init_state;
+  double ideal_steps = 0., modeled_steps = 0.;
+  for (const Step& step : state->transform_steps) {
+    const SplitStepNode* const split_step = step.as<SplitStepNode>();
+    if (split_step == nullptr || split_step->lengths.size() > 2) {
+      continue;
+    }
+    const size_t extent = GetIntImm(analyzer.Simplify(replacer(split_step->extent.value())));
+    if (split_step->lengths.size() == 2) {
+      // The element-wise stages (see `InitEfficientRowReduction`) ideally issue the widest
+      // vectorized accesses on every lane.
+      const size_t vector_width = split_step->lengths[1].value()->value;
+      modeled_steps += floor_div(extent, num_lanes * vector_width);
+      ideal_steps += 1. * extent / (num_lanes * max_vector_width);
+      continue;
+    }
+    const size_t threads_per_row = split_step->lengths[0].value()->value;
+    size_t num_rows = 1;
+    for (const Iterator& iter : init_state->stages[split_step->stage_id]->iters) {
+      if (iter->iter_kind == IteratorKind::kSpatial) {
+        num_rows *= GetIntImm(analyzer.Simplify(replacer(iter->range->extent)));
+      }
+    }
+    // Every row is loaded by its threads in ceil(extent / threads_per_row) steps and then reduced
+    // in log2(threads_per_row) steps, while num_lanes / threads_per_row rows run concurrently.
+    const size_t rows_per_wave = std::max<size_t>(num_lanes / threads_per_row, 1);
+    modeled_steps += floor_div(num_rows, rows_per_wave) *
+                     (floor_div(extent, threads_per_row) + std::log2(threads_per_row));
+    ideal_steps += 1. * num_rows * extent / num_lanes;
+  }
+  return modeled_steps > 0. ? ideal_steps / modeled_steps : 1.;
+}
+
+std::vector<std::pair<size_t, float>> DispatchToAdaptedStates(const SearchTask& task,
+                                                              const std::vector<State>& states,
+                                                              const std::vector<float>& scores) {
+  CHECK_EQ(states.size(), scores.size());
+  CHECK(!states.empty());
+  // the grid extents of row reductions only depend on the states
+  std::vector<Optional<Array<PrimExpr>>> grid_extents(states.size());
+  if (IsRowReductionTask(task)) {
+    for (size_t state_id = 0; state_id < states.size(); ++state_id) {
+      grid_extents[state_id] = GetRowReductionGridExtents(task, states[state_id]);
+    }
+  }
+  std::vector<std::pair<size_t, float>> inst_disp(task->wkl_insts.size());
+  support::parallel_for(0, task->wkl_insts.size(), [&](int inst_id) {
+    float occupancy_penalty, padding_penalty, adapted_score;
+    size_t select_state_id = 0, fallback_state_id = 0;
+    float max_score = 0., max_fallback_score = 0.;
+    for (size_t state_id = 0; state_id < states.size(); ++state_id) {
+      AlignHWAdaptStateToWorkload(task, states[state_id], task->wkl_insts[inst_id],
+                                  scores[state_id], &occupancy_penalty, &padding_penalty,
+                                  &adapted_score, grid_extents[state_id]);
+      if (adapted_score > max_score) {
+        max_score = adapted_score;
+        select_state_id = state_id;
+      }
+      const float fallback_score = scores[state_id] * occupancy_penalty * padding_penalty;
+      if (fallback_score > max_fallback_score) {
+        max_fallback_score = fallback_score;
+        fallback_state_id = state_id;
+      }
+    }
+    if (max_score <= 0.) {
+      LOG(WARNING) << "The grid of " << task->wkl_insts[inst_id] << " is too small to fill the "
+                   << "device with any state, dispatching it to state " << fallback_state_id;
+      select_state_id = fallback_state_id;
+      max_score = max_fallback_score;
+    }
+    inst_disp[inst_id] = std::make_pair(select_state_id, max_score);
+  });
+  return inst_disp;
+}
+
+TVM_REGISTER_GLOBAL("auto_scheduler.DispatchToAdaptedStates")
+    .set_body_typed([](const SearchTask& task, const Array<State>& states,
+                       const Array<FloatImm>& scores) {
+      std::vector<float> score_vec;
+      for (const FloatImm& score : scores) {
+        score_vec.push_back(score->value);
+      }
+      Array<Integer> state_ids;
+      for (const std::pair<size_t, float>& disp :
+           DispatchToAdaptedStates(task, std::vector<State>(states.begin(), states.end()),
+                                   score_vec)) {
+        state_ids.push_back(disp.first);
+      }
+      return state_ids;
+    });
+
 // <bojian/DietCode>
 void AdaptStateToWorkload(const SearchTask& task, const State& state, const Array<IntImm>& wkl_inst,
                           const float score, float* const occupancy_penalty,
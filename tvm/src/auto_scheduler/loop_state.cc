@@ -23,12 +23,15 @@
  * see auto_scheduler/loop_state.h for more explanation.
  */
 
+#include <dmlc/json.h>
 #include <tvm/auto_scheduler/compute_dag.h>
 #include <tvm/auto_scheduler/loop_state.h>
 #include <tvm/auto_scheduler/transform_step.h>
 #include <tvm/runtime/registry.h>
 #include <tvm/te/operation.h>
 
+#include <algorithm>
+#include <memory>
 #include <utility>
 
 #include "utils.h"
@@ -531,6 +534,131 @@ String State::ToStr(bool delete_trivial_loop) const {
   return os.str();
 }
 
+namespace {
+
+/*! \brief A stream buffer that folds all the characters written to it into a fingerprint. */
+class FingerprintStreamBuf : public std::streambuf {
+ public:
+  FingerprintStreamBuf() = default;
+  /*! \brief Resume folding from a fingerprint. */
+  explicit FingerprintStreamBuf(const StateFingerprint& fingerprint)
+      : hi_(fingerprint.hi), lo_(fingerprint.lo) {}
+
+  StateFingerprint fingerprint() const {
+    StateFingerprint ret;
+    ret.hi = hi_;
+    ret.lo = lo_;
+    return ret;
+  }
+
+ protected:
+  int_type overflow(int_type c) final {
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+      Update(static_cast<unsigned char>(c));
+    }
+    return traits_type::not_eof(c);
+  }
+
+  std::streamsize xsputn(const char* s, std::streamsize n) final {
+    for (std::streamsize i = 0; i < n; ++i) {
+      Update(static_cast<unsigned char>(s[i]));
+    }
+    return n;
+  }
+
+ private:
+  // two independent 64-bit lanes: FNV-1a and a multiplicative hash
+  void Update(unsigned char c) {
+    lo_ = (lo_ ^ c) * 0x100000001b3ULL;
+    hi_ = (hi_ + c + 1) * 0x9e3779b97f4a7c15ULL;
+    hi_ ^= hi_ >> 29;
+  }
+
+  uint64_t hi_{0x84222325cbf29ce4ULL};
+  uint64_t lo_{0xcbf29ce484222325ULL};
+};
+
+/*!
+ * \brief Fold a step into the fingerprint. The steps form the JSON array of the record, so the
+ * fingerprint does not depend on how many of them have been folded incrementally.
+ */
+void FoldStep(const Step& step, bool is_first, FingerprintStreamBuf* buf) {
+  std::ostream os(buf);
+  if (!is_first) {
+    os << ',';
+  }
+  dmlc::JSONWriter writer(&os);
+  writer.BeginArray(false);
+  if (const auto* ps = step.as<SplitStepNode>()) {
+    // The extent is implied by the preceding steps, and serializing it (as a JSON string of
+    // the expression) would be as costly as printing the state.
+    writer.WriteArrayItem(std::string(SplitStepNode::record_prefix_str));
+    writer.WriteArrayItem(ps->stage_id);
+    writer.WriteArrayItem(ps->iter_id);
+    for (const Optional<Integer>& length : ps->lengths) {
+      writer.WriteArrayItem(length ? length.value()->value : -1);
+    }
+    writer.WriteArrayItem(static_cast<int>(ps->inner_to_outer));
+  } else {
+    step->WriteToRecord(&writer);
+  }
+  writer.EndArray();
+  os.flush();
+}
+
+}  // namespace
+
+StateFingerprint State::Fingerprint() const {
+  const Array<Step>& steps = operator->()->transform_steps;
+  // the cache may be shared with the copies of this state on other threads
+  std::shared_ptr<const StateFingerprintCache> cache =
+      std::atomic_load(&operator->()->fingerprint_cache);
+
+  size_t num_cached_steps = 0;
+  if (cache != nullptr) {
+    while (num_cached_steps < std::min(cache->steps.size(), steps.size()) &&
+           cache->steps[num_cached_steps].same_as(steps[num_cached_steps])) {
+      ++num_cached_steps;
+    }
+  }
+  StateFingerprint prefix_fingerprint;
+  if (num_cached_steps == 0) {
+    FingerprintStreamBuf buf;
+    std::ostream os(&buf);
+    os << '[';
+    os.flush();
+    prefix_fingerprint = buf.fingerprint();
+  } else {
+    prefix_fingerprint = cache->prefix_fingerprints[num_cached_steps - 1];
+  }
+
+  if (num_cached_steps < steps.size()) {
+    auto new_cache = std::make_shared<StateFingerprintCache>();
+    new_cache->steps.reserve(steps.size());
+    new_cache->prefix_fingerprints.reserve(steps.size());
+    if (num_cached_steps != 0) {
+      new_cache->steps.assign(cache->steps.begin(), cache->steps.begin() + num_cached_steps);
+      new_cache->prefix_fingerprints.assign(cache->prefix_fingerprints.begin(),
+                                            cache->prefix_fingerprints.begin() + num_cached_steps);
+    }
+    FingerprintStreamBuf buf(prefix_fingerprint);
+    for (size_t i = num_cached_steps; i < steps.size(); ++i) {
+      FoldStep(steps[i], i == 0, &buf);
+      new_cache->steps.push_back(steps[i]);
+      new_cache->prefix_fingerprints.push_back(buf.fingerprint());
+    }
+    prefix_fingerprint = buf.fingerprint();
+    std::atomic_store(&operator->()->fingerprint_cache,
+                      std::shared_ptr<const StateFingerprintCache>(std::move(new_cache)));
+  }
+
+  FingerprintStreamBuf buf(prefix_fingerprint);
+  std::ostream os(&buf);
+  os << ']';
+  os.flush();
+  return buf.fingerprint();
+}
+
 TVM_STATIC_IR_FUNCTOR(ReprPrinter, vtable)
     .set_dispatch<StageNode>([](const ObjectRef& ref, ReprPrinter* p) {
       const auto& stage = tvm::Downcast<Stage>(ref);
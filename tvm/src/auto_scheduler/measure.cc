@@ -48,6 +48,7 @@ TVM_REGISTER_OBJECT_TYPE(ProgramMeasurerNode);
 TVM_REGISTER_OBJECT_TYPE(LocalBuilderNode);
 TVM_REGISTER_OBJECT_TYPE(LocalRunnerNode);
 TVM_REGISTER_OBJECT_TYPE(RPCRunnerNode);
+TVM_REGISTER_OBJECT_TYPE(DistributedRPCRunnerNode);
 
 static const char* ErrorNoToStr[] = {
     "NoError",
@@ -200,6 +201,47 @@ Array<MeasureResult> RPCRunnerNode::Run(const Array<MeasureInput>& inputs,
   return Array<MeasureResult>();
 }
 
+/********** DistributedRPCRunner **********/
+DistributedRPCRunner::DistributedRPCRunner(const Array<String>& keys, const String& host,
+                                           int port, int priority, int n_parallel, int timeout,
+                                           int number, int repeat, int min_repeat_ms,
+                                           double cooldown_interval, bool enable_cpu_cache_flush,
+                                           int max_retries, PackedFunc on_result) {
+  ICHECK(!keys.empty()) << "DistributedRPCRunner needs at least one device key";
+  auto node = make_object<DistributedRPCRunnerNode>();
+  node->keys = keys;
+  node->host = host;
+  node->port = port;
+  node->priority = priority;
+  node->timeout = timeout;
+  node->n_parallel = n_parallel;
+  node->number = number;
+  node->repeat = repeat;
+  node->min_repeat_ms = min_repeat_ms;
+  node->cooldown_interval = cooldown_interval;
+  node->enable_cpu_cache_flush = enable_cpu_cache_flush;
+  node->max_retries = max_retries;
+  node->on_result = std::move(on_result);
+  data_ = std::move(node);
+}
+
+Array<MeasureResult> DistributedRPCRunnerNode::Run(const Array<MeasureInput>& inputs,
+                                                   const Array<BuildResult>& build_results,
+                                                   int verbose) {
+  if (const auto* f = runtime::Registry::Get("auto_scheduler.distributed_rpc_runner.run")) {
+    Array<MeasureResult> results =
+        (*f)(inputs, build_results, keys, host, port, priority, n_parallel, timeout, number,
+             repeat, min_repeat_ms, cooldown_interval, enable_cpu_cache_flush, max_retries,
+             on_result, verbose);
+    return results;
+  } else {
+    LOG(FATAL) << "auto_scheduler.distributed_rpc_runner.run is not registered. "
+               << "This is a function registered in Python, "
+               << "make sure the TVM Python runtime has been loaded successfully.";
+  }
+  return Array<MeasureResult>();
+}
+
 /********** MeasureCallback **********/
 PythonBasedMeasureCallback::PythonBasedMeasureCallback(PackedFunc callback_func) {
   auto node = make_object<PythonBasedMeasureCallbackNode>();
@@ -670,5 +712,15 @@ TVM_REGISTER_GLOBAL("auto_scheduler.RPCRunner")
                        min_repeat_ms, cooldown_interval, enable_cpu_cache_flush);
     });
 
+TVM_REGISTER_GLOBAL("auto_scheduler.DistributedRPCRunner")
+    .set_body_typed([](const Array<String>& keys, const String& host, int port, int priority,
+                       int n_parallel, int timeout, int number, int repeat, int min_repeat_ms,
+                       double cooldown_interval, bool enable_cpu_cache_flush, int max_retries,
+                       PackedFunc on_result) {
+      return DistributedRPCRunner(keys, host, port, priority, n_parallel, timeout, number, repeat,
+                                  min_repeat_ms, cooldown_interval, enable_cpu_cache_flush,
+                                  max_retries, on_result);
+    });
+
 }  // namespace auto_scheduler
 }  // namespace tvm
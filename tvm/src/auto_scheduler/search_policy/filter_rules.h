@@ -97,6 +97,51 @@ inline std::pair<std::vector<hardware::HwAlignedConfig>, std::vector<State>> Pad
   return std::make_pair(filtered_configs, filtered_states);
 }
 
+// Keep the states that tile the axes tied to the same shape variables (e.g.,
+// the TxT attention scores of `batch_matmul`) symmetrically, i.e., with the
+// same total tile size. Such axes are padded to the same extent, hence share
+// one out-of-bound predicate. All the states are kept if none is symmetric.
+inline std::pair<std::vector<hardware::HwAlignedConfig>, std::vector<State>> SymmetricTileFilter(
+    const SearchTask& task, const std::vector<hardware::HwAlignedConfig>& configs,
+    const std::vector<State>& cand_states) {
+  std::vector<hardware::HwAlignedConfig> filtered_configs;
+  std::vector<State> filtered_states;
+  for (size_t i = 0; i < configs.size(); ++i) {
+    if (!cand_states[i].defined()) {
+      continue;
+    }
+    // the total tile size of every dynamic extent that has been split
+    std::vector<std::pair<PrimExpr, int64_t>> extent_tile_sizes;
+    bool is_symmetric = true;
+    for (const Step& step : cand_states[i]->transform_steps) {
+      const SplitStepNode* const split_step = step.as<SplitStepNode>();
+      if (split_step == nullptr || !split_step->extent.defined() ||
+          split_step->extent.value()->IsInstance<IntImmNode>()) {
+        continue;
+      }
+      int64_t tile_size = 1;
+      for (const Optional<Integer>& len : split_step->lengths) {
+        tile_size *= len.value()->value;
+      }
+      for (const std::pair<PrimExpr, int64_t>& extent_tile_size : extent_tile_sizes) {
+        if (StructuralEqual()(extent_tile_size.first, split_step->extent.value()) &&
+            extent_tile_size.second != tile_size) {
+          is_symmetric = false;
+        }
+      }
+      extent_tile_sizes.emplace_back(split_step->extent.value(), tile_size);
+    }
+    if (is_symmetric) {
+      filtered_configs.push_back(configs[i]);
+      filtered_states.push_back(cand_states[i]);
+    }
+  }
+  if (filtered_states.empty()) {
+    return std::make_pair(configs, cand_states);
+  }
+  return std::make_pair(filtered_configs, filtered_states);
+}
+
 inline std::pair<std::vector<hardware::HwAlignedConfig>, std::vector<State>> OccupancyFilter(
     const SearchTask& task, const std::vector<hardware::HwAlignedConfig>& configs,
     const std::vector<State>& cand_states, const runtime::Array<IntImm> wkl_inst) {
@@ -78,9 +78,9 @@ void SearchPolicyNode::PreloadMeasuredStates(const String& log_file) {
     measured_states = search_task->compute_dag.InferBound(measured_states);
     for (size_t i = 0; i < measured_states.size(); i++) {
       auto& state = measured_states[i];
-      const auto& state_str = state.ToStr();
-      if (!measured_states_set_.count(state_str)) {
-        measured_states_set_.insert(state_str);
+      const StateFingerprint fingerprint = state.Fingerprint();
+      if (!measured_states_set_.count(fingerprint)) {
+        measured_states_set_.insert(fingerprint);
         if (measured_throughputs[i] != 0.0) {
           measured_states_vector_.emplace_back(std::move(state));
           measured_states_throughputs_.emplace_back(measured_throughputs[i]);
@@ -26,12 +26,17 @@
 
 #include "sketch_policy.h"
 
+#include <dmlc/io.h>
+#include <dmlc/json.h>
+#include <dmlc/memory_io.h>
 #include <tvm/runtime/registry.h>
 #include <tvm/support/parallel_for.h>
 
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <cstdio>
+#include <fstream>
 #include <functional>
 #include <iomanip>
 #include <limits>
@@ -40,6 +45,7 @@
 #include <numeric>
 #include <queue>
 #include <set>
+#include <sstream>
 #include <string>
 #include <tuple>
 #include <type_traits>
@@ -48,6 +54,7 @@
 #include <utility>
 #include <vector>
 
+#include "../../runtime/file_utils.h"
 #include "sketch_policy_rules.h"
 #include "tvm/auto_scheduler/loop_state.h"
 #include "tvm/auto_scheduler/measure.h"
@@ -94,6 +101,7 @@ static InitThreadBind init_thread_bind;
 static InitEfficientTileSize init_efficient_tile_size;
 static InitEfficientThreadBind init_efficient_thread_bind;
 static InitEfficientUnroll init_efficient_unroll;
+static InitEfficientRowReduction init_efficient_row_reduction;
 
 /********** Sketch policy **********/
 TVM_REGISTER_NODE_TYPE(SketchPolicyNode);
@@ -193,6 +201,7 @@ SketchPolicy::SketchPolicy(SearchTask task, CostModel program_cost_model,
       node->efficient_init_rules.push_back(&init_efficient_tile_size);
       node->efficient_init_rules.push_back(&init_efficient_thread_bind);
       node->efficient_init_rules.push_back(&init_efficient_unroll);
+      node->efficient_row_reduction_rules.push_back(&init_efficient_row_reduction);
     }
     node->init_rules.push_back(&init_fill_tile_size);
     node->init_rules.push_back(&init_thread_bind);
@@ -229,20 +238,72 @@ void SketchPolicyNode::CalculateInstOptProb(const ProgramMeasurer& measurer) {
 
   LOG(INFO) << "Finished obtaining the measurement results";
 
+  bool all_converged = !inst_converged.empty();
   for (size_t i = 0; i < search_task->wkl_insts.size(); ++i) {
     double flop = EstimateFlopForInst(search_task->compute_dag,
                                       // best_states.at(best_inst_disp_map.at(i))
                                       //   ->transform_steps,
                                       search_task->shape_vars.value(), search_task->wkl_insts[i]);
     CHECK(flop > 0.);
-
-    inst_opt_priority.push_back(flop * search_task->wkl_inst_weights[i]->value /
-                                best_inst_flops[i]);
+    inst_opt_priority.push_back(flop * GetWklInstWeight(search_task, i) / best_inst_flops[i]);
+    all_converged = all_converged && (inst_opt_priority.back() <= 0. || inst_converged[i]);
+  }
+  // Converged instances no longer draw any probability mass, unless all of them have converged
+  // and the search continues anyway (e.g., w/o early stopping).
+  if (!all_converged) {
+    for (size_t i = 0; i < inst_converged.size(); ++i) {
+      if (inst_converged[i]) {
+        inst_opt_priority[i] = 0.;
+      }
+    }
   }
   ComputePrefixSumProb(inst_opt_priority, &curr_inst_opt_prob);
   LOG(INFO) << "curr_inst_opt_prob=" << ArrayToString(curr_inst_opt_prob);
 }
 
+/*! \brief The relative improvement below which the predicted FLOPS is considered plateaued. */
+constexpr double C_INST_PLATEAU_TOLERANCE = 0.01;
+/*! \brief The fraction of the peak FLOPS above which an instance is considered converged. */
+constexpr double C_INST_ROOFLINE_RATIO = 0.9;
+
+bool SketchPolicyNode::UpdateInstConvergence(const ProgramMeasurer& measurer, const int ct,
+                                             const int early_stopping) {
+  CHECK(IsDynTask(search_task));
+  const size_t num_insts = search_task->wkl_insts.size();
+  inst_best_ct.resize(num_insts, 0);
+  inst_tracked_flops.resize(num_insts, 0.);
+  inst_converged.assign(num_insts, false);
+
+  auto best_inst_flops_it = measurer->best_inst_flops.find(search_task->workload_key);
+  if (best_inst_flops_it == measurer->best_inst_flops.end() ||
+      best_inst_flops_it->second.size() != num_insts) {
+    return false;
+  }
+  const std::vector<float>& best_inst_flops = best_inst_flops_it->second;
+  const double peak_flops = search_task->hardware_api->peak_flops;
+  bool all_converged = true;
+  size_t num_converged = 0;
+
+  for (size_t i = 0; i < num_insts; ++i) {
+    if (best_inst_flops[i] > inst_tracked_flops[i] * (1. + C_INST_PLATEAU_TOLERANCE)) {
+      inst_best_ct[i] = ct;
+      inst_tracked_flops[i] = best_inst_flops[i];
+    }
+    const bool plateaued = ct - inst_best_ct[i] > early_stopping;
+    // the peak FLOPS of the hardware is in GFLOPS
+    const bool near_roofline =
+        peak_flops > 0 && best_inst_flops[i] >= C_INST_ROOFLINE_RATIO * peak_flops * 1e9;
+    inst_converged[i] = plateaued || near_roofline;
+    if (inst_converged[i]) {
+      ++num_converged;
+    } else if (GetWklInstWeight(search_task, i) > 0) {
+      all_converged = false;
+    }
+  }
+  LOG(INFO) << num_converged << " out of " << num_insts << " workload instances have converged";
+  return all_converged;
+}
+
 // <efficient>
 std::pair<std::vector<std::vector<int>>, std::vector<std::vector<int>>>
 SketchPolicyNode::GetAlignedTile(std::vector<int> sbase_tile, std::vector<int> rbase_tile,
@@ -558,7 +619,8 @@ void SketchPolicyNode::ConfigFilter(std::vector<hardware::HwAlignedConfig>* pnex
         this->search_task->hardware_api->reg_cap[0]->value) {
       return;
     }
-    if (GetParallelism(space_tiles, base_config.space_tiles[mem_level]) >= 1024) {
+    if (GetParallelism(space_tiles, base_config.space_tiles[mem_level]) >
+        C_MAX_THREADS_PER_BLOCK) {
       return;
     }
     double k_threshold = ComputeIntensiveThreshold(space_tiles, mem_level);
@@ -748,9 +810,107 @@ std::vector<hardware::HwAlignedConfig> SketchPolicyNode::EmitConfig(int space_di
   return *pnow;
 }
 
+std::vector<hardware::HwAlignedConfig> SketchPolicyNode::EmitRowReductionConfig() {
+  // the widest vectorized memory access of a thread (i.e., 128 bits)
+  constexpr int kMaxVectorBytes = 16;
+  const hardware::HardwareAPI& hardware_api = search_task->hardware_api;
+  const int warp_size =
+      hardware_api->warp_size > 0 ? hardware_api->warp_size : search_task->hardware_params->warp_size;
+  const int max_threads_per_block = search_task->hardware_params->max_threads_per_block;
+  const int dtype_bytes = search_task->compute_dag->tensors.back()->dtype.bytes();
+  const int transaction_bytes = hardware_api->transaction_size.empty()
+                                    ? warp_size * dtype_bytes
+                                    : hardware_api->transaction_size.back()->value;
+
+  std::vector<hardware::HwAlignedConfig> configs;
+  for (int threads_per_row = warp_size; threads_per_row <= max_threads_per_block;
+       threads_per_row *= 2) {
+    for (int vector_width = 1; vector_width * dtype_bytes <= kMaxVectorBytes; vector_width *= 2) {
+      // Every warp should access whole memory transactions.
+      if (warp_size * vector_width * dtype_bytes % transaction_bytes != 0) {
+        continue;
+      }
+      hardware::HwAlignedConfig config;
+      config.space_tiles = {{vector_width}};
+      config.reduce_tiles = {{threads_per_row}};
+      config.single_thread_reg_usage = 0;
+      config.space_production_threshold = 0;
+      config.smem_usage = 0;
+      config.threads_num = threads_per_row;
+      configs.push_back(std::move(config));
+    }
+  }
+  return configs;
+}
+
+std::pair<std::vector<hardware::HwAlignedConfig>, std::vector<State>>
+SketchPolicyNode::EmitRowReductionCandidates() {
+  std::vector<hardware::HwAlignedConfig> cand_configs;
+  std::vector<State> cand_states;
+  // The vector width is unused by the tasks w/o element-wise stages, whose configurations that
+  // only differ in the vector width yield the same state.
+  std::unordered_set<std::string> cand_state_strs;
+  for (const hardware::HwAlignedConfig& config : EmitRowReductionConfig()) {
+    State state;
+    bool valid = true;
+    for (const auto& rule : efficient_row_reduction_rules) {
+      if (rule->Apply(this, &state, config) == EfficientGenerationRule::ResultKind::kInvalid) {
+        valid = false;
+        break;
+      }
+    }
+    if (valid && cand_state_strs.insert(state.ToStr()).second) {
+      cand_configs.push_back(config);
+      cand_states.push_back(state);
+    }
+  }
+  return std::make_pair(cand_configs, cand_states);
+}
+
+std::pair<std::vector<State>, std::unordered_map<size_t, size_t>>
+SketchPolicyNode::EfficientRowReductionSearch(ProgramMeasurer measurer) {
+  Array<MeasureInput> inputs;
+  for (const State& state : EmitRowReductionCandidates().second) {
+    measured_states_vector_.push_back(state);
+    inputs.push_back(MeasureInput(this->search_task, state));
+  }
+  CHECK(!inputs.empty()) << "No valid row reduction configuration has been emitted";
+  Array<MeasureResult> results =
+      measurer->Measure(this->search_task, GetRef<SearchPolicy>(this), inputs);
+  LOG(INFO) << "Completed " << inputs.size() << " trials";
+
+  Array<IntImm> cherry_picked_wkl_inst;
+  double flop_ct;
+  float adaption_penalty;
+  for (size_t input_id = 0; input_id < inputs.size(); ++input_id) {
+    std::tie(cherry_picked_wkl_inst, flop_ct, adaption_penalty) =
+        search_task->compute_dag.CherryPickAlignHardwareWorkloadInstance(inputs[input_id]->state,
+                                                                         search_task);
+    measured_states_throughputs_.push_back(flop_ct / adaption_penalty /
+                                           FloatArrayMean(results[input_id]->costs));
+  }
+
+  // Dispatch each workload instance to the state with the best adapted throughput.
+  std::vector<State> selected_candidate_states;
+  std::unordered_map<size_t, size_t> inst_id_disp_map;
+  std::unordered_map<size_t, size_t> state_id_to_selected_id;
+  const std::vector<std::pair<size_t, float>> inst_disp =
+      DispatchToAdaptedStates(search_task, measured_states_vector_, measured_states_throughputs_);
+  for (size_t inst_id = 0; inst_id < inst_disp.size(); ++inst_id) {
+    const size_t select_state_id = inst_disp[inst_id].first;
+    if (!state_id_to_selected_id.count(select_state_id)) {
+      state_id_to_selected_id[select_state_id] = selected_candidate_states.size();
+      selected_candidate_states.push_back(measured_states_vector_[select_state_id]);
+    }
+    inst_id_disp_map[inst_id] = state_id_to_selected_id[select_state_id];
+  }
+  LOG(INFO) << MapToString(inst_id_disp_map);
+  return std::make_pair(selected_candidate_states, inst_id_disp_map);
+}
+
 // <efficient>
-std::pair<std::vector<State>, std::unordered_map<size_t, size_t>> SketchPolicyNode::EfficientSearch(
-    ProgramMeasurer measurer) {
+std::pair<std::vector<hardware::HwAlignedConfig>, std::vector<State>>
+SketchPolicyNode::EmitFilteredCandidates() {
   if (sketch_cache_.empty()) {
     sketch_cache_ = GenerateSketches();
   }
@@ -800,6 +960,7 @@ std::pair<std::vector<State>, std::unordered_map<size_t, size_t>> SketchPolicyNo
           cand_states[index] = std::move(tmp_s);
         }
       });
+  std::tie(configs, cand_states) = SymmetricTileFilter(this->search_task, configs, cand_states);
   std::map<hardware::HwAlignedConfig, State> filter_cand_states;
   std::vector<std::vector<hardware::HwAlignedConfig>> inst_map_config;
   std::vector<int> sharedmemory_select_ids, reg_select_ids;
@@ -888,6 +1049,23 @@ std::pair<std::vector<State>, std::unordered_map<size_t, size_t>> SketchPolicyNo
     cand_states.push_back(it.second);
     cand_configs.push_back(it.first);
   }
+  return std::make_pair(cand_configs, cand_states);
+}
+
+// <efficient>
+std::pair<std::vector<State>, std::unordered_map<size_t, size_t>> SketchPolicyNode::EfficientSearch(
+    ProgramMeasurer measurer) {
+  if (params.count(SketchParamKey::checkpoint_file) &&
+      !GetStringParam(params, SketchParamKey::checkpoint_file).empty()) {
+    LOG(WARNING) << "EfficientSearch is not checkpointed, ignoring "
+                 << GetStringParam(params, SketchParamKey::checkpoint_file);
+  }
+  if (IsRowReductionTask(search_task)) {
+    return EfficientRowReductionSearch(measurer);
+  }
+  std::vector<hardware::HwAlignedConfig> cand_configs;
+  std::vector<State> cand_states;
+  std::tie(cand_configs, cand_states) = EmitFilteredCandidates();
   Array<MeasureInput> inputs;
   for (int i = 0; i < cand_states.size(); i++) {
     measured_states_vector_.push_back(cand_states[i]);
@@ -917,12 +1095,9 @@ std::pair<std::vector<State>, std::unordered_map<size_t, size_t>> SketchPolicyNo
   //     }
   //   }
   // }
-  float occupancy_penalty, padding_penalty;
-  occupancy_penalty = 0;
-  padding_penalty = 0;
-  // [num_insts x num_states]
   std::vector<State> selected_candidate_states;
   std::unordered_map<size_t, size_t> inst_id_disp_map;
+  std::vector<float> inst_scores;
   // for (size_t inst_id = 0; inst_id < search_task->wkl_insts.size(); ++inst_id) {
   //   for (int i = 0; i < inst_map_config[inst_id].size(); i++) {
   //     for (size_t state_id = 0; state_id < measured_states_throughputs_.size(); ++state_id) {
@@ -935,42 +1110,452 @@ std::pair<std::vector<State>, std::unordered_map<size_t, size_t>> SketchPolicyNo
   //   }
   //   std::cout << std::endl;
   // }
+  const std::vector<std::pair<size_t, float>> inst_disp =
+      DispatchToAdaptedStates(search_task, measured_states_vector_, measured_states_throughputs_);
+  for (size_t inst_id = 0; inst_id < inst_disp.size(); ++inst_id) {
+    inst_id_disp_map[inst_id] = selected_candidate_states.size();
+    selected_candidate_states.push_back(measured_states_vector_[inst_disp[inst_id].first]);
+    inst_scores.push_back(inst_disp[inst_id].second);
+  }  // for (inst_id ∈ search_task->wkl_insts.size())
+  int hybrid_refine_trials = params.count(SketchParamKey::hybrid_refine_trials)
+                                 ? GetIntParam(params, SketchParamKey::hybrid_refine_trials)
+                                 : 0;
+  if (hybrid_refine_trials > 0 && !inputs.empty()) {
+    HybridRefine(measurer, hybrid_refine_trials, inputs, results, &inst_scores,
+                 &selected_candidate_states, &inst_id_disp_map);
+  }
+  LOG(INFO) << MapToString(inst_id_disp_map);
+  for (int i = 0; i < selected_candidate_states.size(); i++) {
+    LOG(INFO) << selected_candidate_states[i];
+  }
+  return std::make_pair(selected_candidate_states, inst_id_disp_map);
+}
+
+std::pair<std::vector<State>, std::unordered_map<size_t, size_t>>
+SketchPolicyNode::AnalyticalDispatch() {
+  CHECK(IsDynTask(search_task));
+  std::vector<hardware::HwAlignedConfig> cand_configs;
+  std::vector<State> cand_states;
+  std::tie(cand_configs, cand_states) =
+      IsRowReductionTask(search_task) ? EmitRowReductionCandidates() : EmitFilteredCandidates();
+  CHECK(!cand_states.empty()) << "No valid hardware-aligned configuration has been emitted";
+
+  // The analytical base score of a candidate is its compute intensity (i.e., the data reuse
+  // at each memory level). Memory-bound row reductions have no reuse and share the same score,
+  // hence are instead scored by their modeled efficiency on each instance.
+  std::vector<float> cand_scores;
+  for (const hardware::HwAlignedConfig& config : cand_configs) {
+    float score = 1.;
+    for (const double ratio : config.compute_intensive_ratio) {
+      score *= ratio;
+    }
+    cand_scores.push_back(score);
+  }
+  // [num_insts x num_states]
+  std::vector<float> adapted_cand_scores(search_task->wkl_insts.size() * cand_states.size());
+  const bool is_row_reduction = IsRowReductionTask(search_task);
+  support::parallel_for(
+      0, adapted_cand_scores.size(),
+      [this, is_row_reduction, &cand_states, &cand_scores, &adapted_cand_scores](int i) {
+        float occupancy_penalty, padding_penalty;
+        size_t inst_id = i / cand_states.size(), state_id = i % cand_states.size();
+        if (is_row_reduction) {
+          adapted_cand_scores[i] = EstimateRowReductionEfficiency(
+              search_task, cand_states[state_id], search_task->wkl_insts[inst_id]);
+        } else {
+          AlignHWAdaptStateToWorkload(search_task, cand_states[state_id],
+                                      search_task->wkl_insts[inst_id], cand_scores[state_id],
+                                      &occupancy_penalty, &padding_penalty,
+                                      &adapted_cand_scores[i]);
+        }
+      });
+
+  TopKDispatcher dispatcher;
+  std::unordered_map<size_t, size_t> raw_inst_id_disp_map =
+      dispatcher.dispatch(adapted_cand_scores, cand_states.size());
+  std::unordered_map<size_t, size_t> inst_id_disp_map;
+  std::vector<State> selected_cand_states;
+  std::vector<float> selected_cand_scores, inst_predicted_scores;
+  std::tie(inst_id_disp_map, selected_cand_states, selected_cand_scores, inst_predicted_scores) =
+      dispatcher.MapWklInstsToStates(raw_inst_id_disp_map, cand_states, cand_scores,
+                                     search_task->wkl_insts, adapted_cand_scores);
+  StdCout(verbose) << "Analytically dispatched " << search_task->wkl_insts.size()
+                   << " workload instances to " << selected_cand_states.size() << " out of "
+                   << cand_states.size() << " candidate states" << std::endl;
+  return std::make_pair(selected_cand_states, inst_id_disp_map);
+}
+
+bool SketchPolicyNode::DecodeAlignedConfig(const State& state,
+                                           hardware::HwAlignedConfig* config) const {
+  // the inverse of `InitEfficientTileSize`, which only handles two memory levels
+  if (search_task->hardware_api->num_level != 2) {
+    return false;
+  }
+  config->space_tiles.assign(2, std::vector<int>());
+  config->reduce_tiles.assign(2, std::vector<int>());
+  for (const Step& step : state->transform_steps) {
+    const SplitStepNode* ps = step.as<SplitStepNode>();
+    if (ps == nullptr || (ps->lengths.size() != 2 && ps->lengths.size() != 3)) {
+      continue;
+    }
+    for (const Optional<Integer>& length : ps->lengths) {
+      if (!length.defined()) {
+        return false;
+      }
+    }
+    int outer = ps->lengths[0].value()->value * ps->lengths[1].value()->value;
+    if (ps->lengths.size() == 2) {
+      config->reduce_tiles[0].push_back(outer);
+      config->reduce_tiles[1].push_back(ps->lengths[1].value()->value);
+    } else {
+      config->space_tiles[0].push_back(outer);
+      config->space_tiles[1].push_back(ps->lengths[0].value()->value);
+    }
+  }
+  return !config->space_tiles[0].empty();
+}
+
+State SketchPolicyNode::MaterializeAlignedConfig(const hardware::HwAlignedConfig& config) {
+  if (sketch_cache_.empty()) {
+    sketch_cache_ = GenerateSketches();
+  }
+  State state = sketch_cache_[0];
+  for (const auto& rule : efficient_init_rules) {
+    if (rule->Apply(this, &state, config) == EfficientGenerationRule::ResultKind::kInvalid) {
+      return State();
+    }
+  }
+  return state;
+}
+
+void SketchPolicyNode::HybridRefine(ProgramMeasurer measurer, int num_trials,
+                                    const Array<MeasureInput>& seed_inputs,
+                                    const Array<MeasureResult>& seed_results,
+                                    std::vector<float>* inst_scores, std::vector<State>* states,
+                                    std::unordered_map<size_t, size_t>* inst_disp_map) {
+  PrintTitle("Hybrid Refinement", verbose);
+  // 1. Collect the aligned tile lattice from the seeds.
+  Array<State> seeds;
+  hardware::HwAlignedConfig config;
+  aligned_space_lattice.clear();
+  aligned_reduce_lattice.clear();
+  for (const MeasureInput& input : seed_inputs) {
+    if (!DecodeAlignedConfig(input->state, &config)) {
+      continue;
+    }
+    if (aligned_space_lattice.empty()) {
+      aligned_space_lattice.resize(2);
+      aligned_reduce_lattice.resize(2);
+      for (size_t level = 0; level < 2; ++level) {
+        aligned_space_lattice[level].resize(config.space_tiles[level].size());
+        aligned_reduce_lattice[level].resize(config.reduce_tiles[level].size());
+      }
+    }
+    for (size_t level = 0; level < 2; ++level) {
+      for (size_t dim = 0; dim < config.space_tiles[level].size(); ++dim) {
+        aligned_space_lattice[level][dim].push_back(config.space_tiles[level][dim]);
+      }
+      for (size_t dim = 0; dim < config.reduce_tiles[level].size(); ++dim) {
+        aligned_reduce_lattice[level][dim].push_back(config.reduce_tiles[level][dim]);
+      }
+    }
+    seeds.push_back(input->state);
+    measured_states_set_.insert(input->state.Fingerprint());
+  }
+  if (seeds.empty()) {
+    LOG(WARNING) << "No hardware-aligned seed can be decoded, skipping the hybrid refinement";
+    return;
+  }
+  for (auto* lattice : {&aligned_space_lattice, &aligned_reduce_lattice}) {
+    for (std::vector<std::vector<int>>& level_lattice : *lattice) {
+      for (std::vector<int>& dim_lattice : level_lattice) {
+        std::sort(dim_lattice.begin(), dim_lattice.end());
+        dim_lattice.erase(std::unique(dim_lattice.begin(), dim_lattice.end()), dim_lattice.end());
+      }
+    }
+  }
+
+  // 2. Spend the budget on the instances that have the largest gap (in weighted seconds) to the
+  //    roofline. Refining the top quarter keeps the number of trials per instance meaningful.
+  const double peak_flops = search_task->hardware_api->peak_flops;
+  std::vector<std::pair<double, size_t>> inst_gaps;
   for (size_t inst_id = 0; inst_id < search_task->wkl_insts.size(); ++inst_id) {
-    size_t select_state_id = 0;
-    float max_score = 0;
-    for (size_t state_id = 0; state_id < measured_states_throughputs_.size(); ++state_id) {
-      float base_score = 0;
-      // for (int i = 0; i < inst_map_config[inst_id].size(); i++) {
-      //   if (!(inst_map_config[inst_id][i] < cand_configs[state_id]) &&
-      //       !(cand_configs[state_id] < inst_map_config[inst_id][i])) {
-      //     base_score = measured_states_throughputs_[state_id];
-      //     break;
-      //   }
-      // }
-      // if (inst_map_config[inst_id].size() == 0) {
-      //   base_score = measured_states_throughputs_[state_id];
-      // }
-      // if (base_score < 1e-6) {
-      //   continue;
-      // }
-      base_score = measured_states_throughputs_[state_id];
+    double flop = EstimateFlopForInst(search_task->compute_dag, search_task->shape_vars.value(),
+                                      search_task->wkl_insts[inst_id]);
+    double predicted_latency =
+        (*inst_scores)[inst_id] > 0 ? flop / (*inst_scores)[inst_id] : flop;
+    double roofline_latency = peak_flops > 0 ? flop / peak_flops : 0.;
+    inst_gaps.emplace_back(GetWklInstWeight(search_task, inst_id) *
+                               std::max(predicted_latency - roofline_latency, 0.),
+                           inst_id);
+  }
+  std::sort(inst_gaps.begin(), inst_gaps.end(), std::greater<std::pair<double, size_t>>());
+  size_t num_refine_insts = std::max(inst_gaps.size() / 4, static_cast<size_t>(1));
+  refine_wkl_inst_ids.clear();
+  for (size_t i = 0; i < num_refine_insts; ++i) {
+    refine_wkl_inst_ids.push_back(inst_gaps[i].second);
+  }
+  LOG(INFO) << "Refining workload instances " << ArrayToString(refine_wkl_inst_ids)
+            << " w/ " << num_trials << " trials";
+
+  // 3. Evolve the seeds w/ the mutations constrained to the aligned tile lattice.
+  std::vector<std::shared_ptr<PopulationMutationRule>> default_mutation_rules =
+      std::move(mutation_rules);
+  mutation_rules = {std::make_shared<MutateAlignedTileSize>(1.0)};
+  program_cost_model->Update(seed_inputs, seed_results);
+
+  const size_t num_seeds = measured_states_vector_.size();
+  int num_measured = 0;
+  Array<IntImm> cherry_picked_wkl_inst;
+  double flop_ct;
+  float adaption_penalty;
+  while (num_measured < num_trials) {
+    // the same batch size as the default `num_measures_per_round`
+    Array<State> best_states = EvolutionarySearch(seeds, std::min(num_trials - num_measured, 64));
+    if (best_states.empty()) {
+      LOG(INFO) << "The aligned tile lattice has been exhausted";
+      break;
+    }
+    Array<MeasureInput> inputs;
+    for (const State& state : best_states) {
+      inputs.push_back(MeasureInput(search_task, state));
+    }
+    Array<MeasureResult> results =
+        measurer->Measure(search_task, GetRef<SearchPolicy>(this), inputs);
+    program_cost_model->Update(inputs, results);
+    for (size_t input_id = 0; input_id < inputs.size(); ++input_id) {
+      measured_states_set_.insert(inputs[input_id]->state.Fingerprint());
+      measured_states_vector_.push_back(inputs[input_id]->state);
+      std::tie(cherry_picked_wkl_inst, flop_ct, adaption_penalty) =
+          search_task->compute_dag.CherryPickAlignHardwareWorkloadInstance(
+              inputs[input_id]->state, search_task);
+      measured_states_throughputs_.push_back(flop_ct / adaption_penalty /
+                                             FloatArrayMean(results[input_id]->costs));
+      seeds.push_back(inputs[input_id]->state);
+    }
+    num_measured += inputs.size();
+  }
+  mutation_rules = std::move(default_mutation_rules);
+
+  // 4. Re-dispatch the refined instances to the refined states if they adapt better.
+  float occupancy_penalty = 0, padding_penalty = 0;
+  std::unordered_map<size_t, size_t> refined_state_disp_ids;
+  for (size_t inst_id : refine_wkl_inst_ids) {
+    size_t select_state_id = measured_states_vector_.size();
+    float max_score = (*inst_scores)[inst_id];
+    for (size_t state_id = num_seeds; state_id < measured_states_vector_.size(); ++state_id) {
       float state_score = 0;
       AlignHWAdaptStateToWorkload(search_task, measured_states_vector_[state_id],
-                                  search_task->wkl_insts[inst_id], base_score, &occupancy_penalty,
+                                  search_task->wkl_insts[inst_id],
+                                  measured_states_throughputs_[state_id], &occupancy_penalty,
                                   &padding_penalty, &state_score);
       if (state_score > max_score) {
         max_score = state_score;
         select_state_id = state_id;
       }
     }
-    inst_id_disp_map[inst_id] = selected_candidate_states.size();
-    selected_candidate_states.push_back(measured_states_vector_[select_state_id]);
-  }  // for (state_id ∈ candidate_states.size())
-  LOG(INFO) << MapToString(inst_id_disp_map);
-  for (int i = 0; i < selected_candidate_states.size(); i++) {
-    LOG(INFO) << selected_candidate_states[i];
+    if (select_state_id != measured_states_vector_.size()) {
+      if (!refined_state_disp_ids.count(select_state_id)) {
+        refined_state_disp_ids[select_state_id] = states->size();
+        states->push_back(measured_states_vector_[select_state_id]);
+      }
+      (*inst_disp_map)[inst_id] = refined_state_disp_ids[select_state_id];
+      (*inst_scores)[inst_id] = max_score;
+    }
   }
-  return std::make_pair(selected_candidate_states, inst_id_disp_map);
+  refine_wkl_inst_ids.clear();
+}
+
+/*! \brief The magic number of the search checkpoints (the version is in the lowest byte). */
+constexpr uint64_t kSketchPolicyCheckpointMagic = 0x534B434845434B02;
+
+namespace {
+
+/*! \brief Serialize the transform steps of a state in the same format as the measure records. */
+std::string StepsToRecord(const State& state) {
+  std::ostringstream os;
+  dmlc::JSONWriter writer(&os);
+  writer.BeginArray(false);
+  for (const Step& step : state->transform_steps) {
+    writer.WriteArraySeperator();
+    writer.BeginArray(false);
+    step->WriteToRecord(&writer);
+    writer.EndArray();
+  }
+  writer.EndArray();
+  return os.str();
+}
+
+/*! \brief Replay the serialized transform steps on the initial state of the task. */
+State StateFromRecord(const SearchTask& task, const std::string& record) {
+  std::istringstream is(record);
+  dmlc::JSONReader reader(&is);
+  State state = task->compute_dag->init_state;
+  reader.BeginArray();
+  while (reader.NextArrayItem()) {
+    reader.BeginArray();
+    Step step = StepReadFromRecord(&reader);
+    ICHECK(!reader.NextArrayItem());
+    state.CopyOnWrite()->transform_steps.push_back(step);
+    StepApplyToState(step, &state, task->compute_dag);
+  }
+  return task->compute_dag.InferBound(state);
+}
+
+std::vector<std::string> StatesToRecords(const std::vector<State>& states) {
+  std::vector<std::string> records;
+  for (const State& state : states) {
+    records.push_back(StepsToRecord(state));
+  }
+  return records;
+}
+
+std::vector<State> StatesFromRecords(const SearchTask& task,
+                                     const std::vector<std::string>& records) {
+  std::vector<State> states;
+  for (const std::string& record : records) {
+    states.push_back(StateFromRecord(task, record));
+  }
+  return states;
+}
+
+}  // namespace
+
+void SketchPolicyNode::SaveCheckpoint(const std::string& filename, const ProgramMeasurer& measurer,
+                                      int ct) const {
+  // write to a temporary file first so that a preemption never leaves a truncated checkpoint
+  const std::string tmp_filename = filename + ".tmp";
+  std::string blob;
+  {
+    dmlc::MemoryStringStream mstrm(&blob);
+    dmlc::Stream* strm = &mstrm;
+    strm->Write(kSketchPolicyCheckpointMagic);
+    strm->Write(std::string(search_task->workload_key));
+    strm->Write(ct);
+    strm->Write(static_cast<uint64_t>(n_trials));
+    std::ostringstream rand_gen_os;
+    rand_gen_os << rand_gen;
+    strm->Write(rand_gen_os.str());
+
+    // policy
+    // the hashed containers are written in sorted order so that the checkpoints are deterministic
+    std::vector<std::pair<uint64_t, uint64_t>> fingerprints;
+    for (const StateFingerprint& fingerprint : measured_states_set_) {
+      fingerprints.emplace_back(fingerprint.hi, fingerprint.lo);
+    }
+    std::sort(fingerprints.begin(), fingerprints.end());
+    strm->Write(fingerprints);
+    strm->Write(StatesToRecords(measured_states_vector_));
+    strm->Write(measured_states_throughputs_);
+    strm->Write(curr_inst_opt_prob);
+    strm->Write(inst_best_ct);
+    strm->Write(inst_tracked_flops);
+    std::vector<State> history_states;
+    std::vector<std::vector<double>> history_costs;
+    std::vector<int> history_error_nos;
+    for (size_t i = 0; i < measured_inputs_.size(); ++i) {
+      history_states.push_back(measured_inputs_[i]->state);
+      history_costs.emplace_back();
+      for (const PrimExpr& cost : measured_results_[i]->costs) {
+        history_costs.back().push_back(cost.as<tir::FloatImmNode>()->value);
+      }
+      history_error_nos.push_back(measured_results_[i]->error_no);
+    }
+    strm->Write(StatesToRecords(history_states));
+    strm->Write(history_costs);
+    strm->Write(history_error_nos);
+
+    // measurer
+    strm->Write(measurer->ct);
+    strm->Write(measurer->error_ct);
+    strm->Write(std::map<std::string, double>(measurer->best_score.begin(),
+                                              measurer->best_score.end()));
+    std::map<std::string, std::vector<std::string>> best_states;
+    for (const auto& kv : measurer->best_states) {
+      best_states[kv.first] = StatesToRecords(kv.second);
+    }
+    strm->Write(best_states);
+    std::map<std::string, std::map<size_t, size_t>> best_inst_disp_map;
+    for (const auto& kv : measurer->best_inst_disp_map) {
+      best_inst_disp_map[kv.first].insert(kv.second.begin(), kv.second.end());
+    }
+    strm->Write(best_inst_disp_map);
+    strm->Write(std::map<std::string, std::vector<float>>(measurer->best_state_flops.begin(),
+                                                          measurer->best_state_flops.end()));
+    strm->Write(std::map<std::string, std::vector<float>>(measurer->best_inst_flops.begin(),
+                                                          measurer->best_inst_flops.end()));
+    strm->Write(std::map<std::string, int>(measurer->best_ct.begin(), measurer->best_ct.end()));
+    strm->Write(std::set<std::string>(measurer->has_valid.begin(), measurer->has_valid.end()));
+  }
+  runtime::SaveBinaryToFile(tmp_filename, blob);
+  ICHECK_EQ(std::rename(tmp_filename.c_str(), filename.c_str()), 0)
+      << "Failed to move the checkpoint to " << filename;
+  StdCout(verbose) << "Saved the checkpoint of " << ct << " trials to " << filename << std::endl;
+}
+
+int SketchPolicyNode::LoadCheckpoint(const std::string& filename, const ProgramMeasurer& measurer) {
+  if (!std::ifstream(filename, std::ios::binary)) {
+    return -1;
+  }
+  std::string blob;
+  runtime::LoadBinaryFromFile(filename, &blob);
+  dmlc::MemoryStringStream mstrm(&blob);
+  dmlc::Stream* strm = &mstrm;
+  uint64_t magic;
+  std::string workload_key;
+  int ct;
+  uint64_t num_trials;
+  std::string rand_gen_str;
+  ICHECK(strm->Read(&magic) && magic == kSketchPolicyCheckpointMagic)
+      << "Invalid checkpoint file " << filename;
+  ICHECK(strm->Read(&workload_key) && workload_key == search_task->workload_key)
+      << "The checkpoint " << filename << " belongs to a different workload";
+  ICHECK(strm->Read(&ct) && strm->Read(&num_trials) && strm->Read(&rand_gen_str));
+  std::istringstream rand_gen_is(rand_gen_str);
+  rand_gen_is >> rand_gen;
+  n_trials = num_trials;
+
+  // policy
+  std::vector<std::pair<uint64_t, uint64_t>> fingerprints;
+  std::vector<std::string> state_records;
+  ICHECK(strm->Read(&fingerprints) && strm->Read(&state_records) &&
+         strm->Read(&measured_states_throughputs_) && strm->Read(&curr_inst_opt_prob) &&
+         strm->Read(&inst_best_ct) && strm->Read(&inst_tracked_flops));
+  measured_states_set_.clear();
+  for (const std::pair<uint64_t, uint64_t>& fingerprint : fingerprints) {
+    measured_states_set_.insert(StateFingerprint{fingerprint.first, fingerprint.second});
+  }
+  measured_states_vector_ = StatesFromRecords(search_task, state_records);
+  std::vector<std::vector<double>> history_costs;
+  std::vector<int> history_error_nos;
+  ICHECK(strm->Read(&state_records) && strm->Read(&history_costs) &&
+         strm->Read(&history_error_nos));
+  measured_inputs_.clear();
+  measured_results_.clear();
+  for (size_t i = 0; i < state_records.size(); ++i) {
+    measured_inputs_.push_back(
+        MeasureInput(search_task, StateFromRecord(search_task, state_records[i])));
+    Array<PrimExpr> costs;
+    for (const double cost : history_costs[i]) {
+      costs.push_back(FloatImm(DataType::Float(64), cost));
+    }
+    measured_results_.push_back(MeasureResult(costs, history_error_nos[i], "", 0., 0.));
+  }
+
+  // measurer
+  std::unordered_map<std::string, std::vector<std::string>> best_states;
+  ICHECK(strm->Read(&measurer->ct) && strm->Read(&measurer->error_ct) &&
+         strm->Read(&measurer->best_score) && strm->Read(&best_states) &&
+         strm->Read(&measurer->best_inst_disp_map) && strm->Read(&measurer->best_state_flops) &&
+         strm->Read(&measurer->best_inst_flops) && strm->Read(&measurer->best_ct) &&
+         strm->Read(&measurer->has_valid))
+      << "Truncated checkpoint file " << filename;
+  measurer->best_states.clear();
+  for (const auto& kv : best_states) {
+    measurer->best_states[kv.first] = StatesFromRecords(search_task, kv.second);
+  }
+  StdCout(verbose) << "Resumed " << ct << " trials from the checkpoint " << filename << std::endl;
+  return ct;
 }
 
 // <bojian/DietCode>
@@ -983,6 +1568,10 @@ std::pair<std::vector<State>, std::unordered_map<size_t, size_t>> SketchPolicyNo
 
   if (n_trials <= 1) {
     // No measurement is allowed
+    // <efficient> Dispatch dynamic tasks with the analytical pipeline.
+    if (IsDynTask(search_task) && search_task->hardware_api->num_level != 0) {
+      return AnalyticalDispatch();
+    }
     const Array<State>& best_states = SearchOneRound(0);
     ICHECK_GT(best_states.size(), 0);
 
@@ -1004,6 +1593,29 @@ std::pair<std::vector<State>, std::unordered_map<size_t, size_t>> SketchPolicyNo
     Array<State> best_states, random_states;
     Array<MeasureInput> inputs;
     Array<MeasureResult> results;
+
+    const std::string checkpoint_file =
+        params.count(SketchParamKey::checkpoint_file)
+            ? GetStringParam(params, SketchParamKey::checkpoint_file)
+            : "";
+    const int checkpoint_interval = params.count(SketchParamKey::checkpoint_interval)
+                                        ? GetIntParam(params, SketchParamKey::checkpoint_interval)
+                                        : 1;
+    int num_rounds = 0;
+    inst_best_ct.clear();
+    inst_tracked_flops.clear();
+    inst_converged.clear();
+    if (!checkpoint_file.empty()) {
+      int resumed_ct = LoadCheckpoint(checkpoint_file, measurer);
+      if (resumed_ct >= 0) {
+        ct = resumed_ct;
+        // The cost model is not serialized but retrained on the whole measurement history.
+        if (!measured_inputs_.empty()) {
+          PrintTitle("Train cost model", verbose);
+          program_cost_model->Update(measured_inputs_, measured_results_);
+        }
+      }
+    }
     while (ct < n_trials) {
       if (!inputs.empty()) {
         auto t_begin = std::chrono::high_resolution_clock::now();
@@ -1072,16 +1684,21 @@ std::pair<std::vector<State>, std::unordered_map<size_t, size_t>> SketchPolicyNo
       LOG(INFO) << inputs[0]->state;
       results = measurer->Measure(search_task, GetRef<SearchPolicy>(this), inputs);
 
-      // <bojian/DietCode>
-      if (IsDynTask(search_task)) {
-        CalculateInstOptProb(measurer);
-      }
-
       ct += inputs.size();
 
       // Check if reach the early stopping condition
-      if (ct - measurer->best_ct[search_task->workload_key] > early_stopping &&
-          measurer->has_valid.count(search_task->workload_key)) {
+      // <bojian/DietCode> The early stopping of dynamic tasks is tracked per instance, since an
+      //                   improvement on one instance says nothing about the others.
+      if (IsDynTask(search_task)) {
+        if (UpdateInstConvergence(measurer, ct, early_stopping) &&
+            measurer->has_valid.count(search_task->workload_key)) {
+          StdCout(verbose) << "Stop early since all the weighted workload instances have "
+                              "converged.\n";
+          break;
+        }
+        CalculateInstOptProb(measurer);
+      } else if (ct - measurer->best_ct[search_task->workload_key] > early_stopping &&
+                 measurer->has_valid.count(search_task->workload_key)) {
         StdCout(verbose) << "Stop early since no performance improvement in the last "
                          << early_stopping << " measurements trials.\n";
         break;
@@ -1121,6 +1738,15 @@ std::pair<std::vector<State>, std::unordered_map<size_t, size_t>> SketchPolicyNo
         }
       }
 
+      if (!checkpoint_file.empty()) {
+        for (size_t input_id = 0; input_id < inputs.size(); ++input_id) {
+          measured_inputs_.push_back(inputs[input_id]);
+          measured_results_.push_back(results[input_id]);
+        }
+        if (++num_rounds % checkpoint_interval == 0 || ct >= n_trials) {
+          SaveCheckpoint(checkpoint_file, measurer, ct);
+        }
+      }
     }  // while (ct < n_trials)
 
     // <bojian/DietCode>
@@ -1298,11 +1924,13 @@ static double ComputeFlopWeightedLatency(const SearchTask& task,
 // std::pair<Array<MeasureInput>, Array<MeasureResult>>
 std::pair<int, float> SketchPolicyNode::ContinueSearchOneRound(int num_measure,
                                                                ProgramMeasurer measurer) {
+  return MeasureAndUpdate(ProposeMeasureInputs(num_measure), measurer);
+}
+
+Array<MeasureInput> SketchPolicyNode::ProposeMeasureInputs(int num_measure) {
   num_measure_per_iter_ = num_measure;
 
   Array<State> best_states, random_states;
-  Array<MeasureInput> inputs;
-  Array<MeasureResult> results;
   int num_random = static_cast<int>(GetDoubleParam(params, "eps_greedy") * num_measure);
 
   // Search one round to get promising states
@@ -1327,14 +1955,25 @@ std::pair<int, float> SketchPolicyNode::ContinueSearchOneRound(int num_measure,
 
   // Pick `num_measure_per_iter` states to measure, check hash to remove already measured state
   // Also pick some random states to do eps-greedy
-  inputs = PickStatesWithEpsGreedy(best_states, random_states, num_measure);
+  return PickStatesWithEpsGreedy(best_states, random_states, num_measure);
+}
 
+std::pair<int, float> SketchPolicyNode::MeasureAndUpdate(const Array<MeasureInput>& inputs,
+                                                         ProgramMeasurer measurer) {
   // Measure candidate states
   PrintTitle("Measure", verbose);
-  results = measurer->Measure(search_task, GetRef<SearchPolicy>(this), inputs);
+  Array<MeasureResult> results = measurer->Measure(search_task, GetRef<SearchPolicy>(this), inputs);
 
   // <bojian/DietCode>
   if (IsDynTask(search_task)) {
+    n_trials += inputs.size();
+    const int inst_early_stopping =
+        params.count(SketchParamKey::inst_early_stopping)
+            ? GetIntParam(params, SketchParamKey::inst_early_stopping)
+            : -1;
+    all_insts_converged = UpdateInstConvergence(
+        measurer, n_trials,
+        inst_early_stopping < 0 ? std::numeric_limits<int>::max() >> 1 : inst_early_stopping);
     CalculateInstOptProb(measurer);
   }
 
@@ -1527,7 +2166,8 @@ Array<State> SketchPolicyNode::GenerateSketches() {
 }
 
 // <bojian/DietCode>
-bool is_sample_init_population_1st_iter;
+// thread-local as the search phases of several policies can run concurrently
+thread_local bool is_sample_init_population_1st_iter;
 bool is_evolutionary_search;
 bool enable_verbose_logging;
 // constexpr bool simplify_sketch = true;
@@ -1546,7 +2186,7 @@ Array<State> SketchPolicyNode::SampleInitPopulation(const Array<State>& sketches
     rand_gens.push_back(std::mt19937(rand_gen()));
   }
 
-  std::unordered_set<std::string> explored_state_strs;
+  std::unordered_set<StateFingerprint> explored_state_fingerprints;
   size_t iter = 1;
   size_t unchange_cnt = 0;
   while (static_cast<int>(out_states.size()) < sample_init_min_pop_) {
@@ -1646,9 +2286,9 @@ Array<State> SketchPolicyNode::SampleInitPopulation(const Array<State>& sketches
       program_cost_model->Predict(search_task, cand_states, &pop_scores);
 
       for (size_t i = 0; i < cand_states.size(); i++) {
-        const auto state_str = cand_states[i].ToStr();
-        if (pop_scores[i] > -1e10 && explored_state_strs.count(state_str) == 0) {
-          explored_state_strs.insert(state_str);
+        const StateFingerprint fingerprint = cand_states[i].Fingerprint();
+        if (pop_scores[i] > -1e10 && explored_state_fingerprints.count(fingerprint) == 0) {
+          explored_state_fingerprints.insert(fingerprint);
           out_states.push_back(std::move(cand_states[i]));
           unchange_cnt = 0;  // Reset the counter once we found a valid state
         } else {
@@ -1730,7 +2370,7 @@ Array<State> SketchPolicyNode::EvolutionarySearch(const Array<State>& init_popul
     return left.second > right.second;
   };
   std::vector<StateHeapItem> heap;
-  std::unordered_set<std::string> in_heap(measured_states_set_);
+  std::unordered_set<StateFingerprint> in_heap(measured_states_set_);
   heap.reserve(out_size);
 
   // auxiliary global variables
@@ -1779,6 +2419,11 @@ Array<State> SketchPolicyNode::EvolutionarySearch(const Array<State>& init_popul
 
       for (size_t state_id = 0; state_id < pnow->size(); ++state_id) {
         for (size_t wkl_inst_id = 0; wkl_inst_id < search_task->wkl_insts.size(); ++wkl_inst_id) {
+          if (!refine_wkl_inst_ids.empty() &&
+              std::find(refine_wkl_inst_ids.begin(), refine_wkl_inst_ids.end(), wkl_inst_id) ==
+                  refine_wkl_inst_ids.end()) {
+            continue;
+          }
           pop_scores[state_id] =
               std::max(pop_scores[state_id],
                        pop_scores_for_all_wkl_insts[wkl_inst_id * pnow->size() + state_id]);
@@ -1808,7 +2453,7 @@ Array<State> SketchPolicyNode::EvolutionarySearch(const Array<State>& init_popul
 
     for (size_t i = 0; i < pnow->size(); ++i) {
       const State& state = (*pnow)[i];
-      std::string state_str = state.ToStr();
+      const StateFingerprint fingerprint = state.Fingerprint();
 
       //       bool optimal_split_factors_found = false;
       //       Array<Array<Optional<Integer>>> split_factors = state.GetSplitFactors();
@@ -1827,15 +2472,14 @@ Array<State> SketchPolicyNode::EvolutionarySearch(const Array<State>& init_popul
       //         optimal_split_factors_found = true;
       //       }
 
-      if (in_heap.count(state_str) == 0) {
+      if (in_heap.count(fingerprint) == 0) {
         if (static_cast<int>(heap.size()) < out_size) {
           heap.emplace_back((*pnow)[i], pop_scores[i]);
           std::push_heap(heap.begin(), heap.end(), cmp);
-          in_heap.insert(state_str);
+          in_heap.insert(fingerprint);
         } else if (pop_scores[i] > heap.front().second) {
-          std::string old_state_str = heap.front().first.ToStr();
-          in_heap.erase(old_state_str);
-          in_heap.insert(state_str);
+          in_heap.erase(heap.front().first.Fingerprint());
+          in_heap.insert(fingerprint);
 
           std::pop_heap(heap.begin(), heap.end(), cmp);
           heap.back() = StateHeapItem(state, pop_scores[i]);
@@ -1891,7 +2535,17 @@ Array<State> SketchPolicyNode::EvolutionarySearch(const Array<State>& init_popul
       // <bojian/DietCode>
       // PrintTitle("Evolutionary Search (Mutation Rule)", verbose);
 
-      State tmp_s = (*pnow)[RandomChoose(pop_selection_probs, &rand_gen)];
+      const size_t pop_id = RandomChoose(pop_selection_probs, &rand_gen);
+      State tmp_s = (*pnow)[pop_id];
+
+      // <efficient> Expose the adaption penalties of the state to the mutation rules.
+      if (IsDynTask(search_task)) {
+        mutation_inst_adapt_penalty.resize(search_task->wkl_insts.size());
+        for (size_t wkl_inst_id = 0; wkl_inst_id < search_task->wkl_insts.size(); ++wkl_inst_id) {
+          const size_t i = wkl_inst_id * pnow->size() + pop_id;
+          mutation_inst_adapt_penalty[wkl_inst_id] = occupancy_penalty[i] * padding_penalty[i];
+        }
+      }
 
       if (dis(rand_gen) < mutation_prob) {
         const auto& rule = mutation_rules[RandomChoose(rule_selection_probs, &rand_gen)];
@@ -1915,6 +2569,7 @@ Array<State> SketchPolicyNode::EvolutionarySearch(const Array<State>& init_popul
     std::swap(pnext, pnow);
     pnext->clear();
   }
+  mutation_inst_adapt_penalty.clear();
 
   // <bojian/DietCode>
   // State state_copy = heap.begin()->first;
@@ -2027,9 +2682,9 @@ Array<MeasureInput> SketchPolicyNode::PickStatesWithEpsGreedy(const Array<State>
     }
 
     // Check if it has already been measured
-    std::string state_str = state.ToStr();
-    if (!measured_states_set_.count(state_str)) {
-      measured_states_set_.insert(std::move(state_str));
+    const StateFingerprint fingerprint = state.Fingerprint();
+    if (!measured_states_set_.count(fingerprint)) {
+      measured_states_set_.insert(fingerprint);
 
       // <bojian/DietCode>
       measured_states_vector_.push_back(state);
@@ -2088,6 +2743,34 @@ TVM_REGISTER_GLOBAL("auto_scheduler.SketchPolicyEvolutionarySearch")
       return states;
     });
 
+TVM_REGISTER_GLOBAL("auto_scheduler.SketchPolicyProposeMeasureInputs")
+    .set_body_typed([](SketchPolicy policy, int num_measure) {
+      return policy->ProposeMeasureInputs(num_measure);
+    });
+
+TVM_REGISTER_GLOBAL("auto_scheduler.SketchPolicyMeasureAndUpdate")
+    .set_body_typed([](SketchPolicy policy, Array<MeasureInput> inputs, ProgramMeasurer measurer) {
+      int num_measure_inputs;
+      float best_measure_avg_latency;
+      std::tie(num_measure_inputs, best_measure_avg_latency) =
+          policy->MeasureAndUpdate(inputs, measurer);
+      return Array<ObjectRef>{Integer(num_measure_inputs),
+                              FloatImm(DataType::Float(32), best_measure_avg_latency)};
+    });
+
+TVM_REGISTER_GLOBAL("auto_scheduler.SketchPolicyAllInstsConverged")
+    .set_body_typed([](SketchPolicy policy) { return policy->all_insts_converged; });
+
+TVM_REGISTER_GLOBAL("auto_scheduler.SketchPolicySaveCheckpoint")
+    .set_body_typed([](SketchPolicy policy, String filename, ProgramMeasurer measurer, int ct) {
+      policy->SaveCheckpoint(filename, measurer, ct);
+    });
+
+TVM_REGISTER_GLOBAL("auto_scheduler.SketchPolicyLoadCheckpoint")
+    .set_body_typed([](SketchPolicy policy, String filename, ProgramMeasurer measurer) {
+      return policy->LoadCheckpoint(filename, measurer);
+    });
+
 TVM_REGISTER_GLOBAL("auto_scheduler.PrintTitle").set_body_typed([](std::string title) {
   PrintTitle(title, 1);
 });
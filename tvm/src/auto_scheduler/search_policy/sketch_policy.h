@@ -89,6 +89,27 @@ struct SketchParamKey {
   static constexpr const char* max_vectorize_size = "max_vectorize_size";
   /*! \brief Whether disable compute location changing. */
   static constexpr const char* disable_change_compute_location = "disable_change_compute_location";
+  /*!
+   * \brief The number of extra trials that the hybrid mode spends on refining the hardware-aligned
+   *        configurations with the evolutionary search (0 disables the hybrid mode).
+   */
+  static constexpr const char* hybrid_refine_trials = "hybrid_refine_trials";
+  /*!
+   * \brief The binary file that the search state is periodically saved to, and resumed from if it
+   *        already exists when the search starts (empty disables checkpointing). Only `Search`
+   *        is checkpointed: `EfficientSearch` measures its analytically selected candidates in a
+   *        single batch (plus the optional hybrid refinement) and always starts afresh.
+   */
+  static constexpr const char* checkpoint_file = "checkpoint_file";
+  /*! \brief The number of search rounds between two checkpoints. */
+  static constexpr const char* checkpoint_interval = "checkpoint_interval";
+  /*!
+   * \brief The number of trials w/o improvement after which a workload instance of a dynamic
+   *        task is considered converged in `MeasureAndUpdate` (i.e., when tuned by the task
+   *        scheduler). A negative value only checks the roofline. `Search` uses its own
+   *        `early_stopping` argument instead.
+   */
+  static constexpr const char* inst_early_stopping = "inst_early_stopping";
 };
 
 class SketchPolicy;
@@ -110,6 +131,7 @@ class SketchPolicyNode : public SearchPolicyNode {
   std::vector<PopulationGenerationRule*> init_rules;
   // <efficient>
   std::vector<EfficientGenerationRule*> efficient_init_rules;
+  std::vector<EfficientGenerationRule*> efficient_row_reduction_rules;
   /*! \brief The rules to mutate states in the evolutionary search. */
   std::vector<std::shared_ptr<PopulationMutationRule>> mutation_rules;
   /*! \brief Random generator. */
@@ -122,8 +144,46 @@ class SketchPolicyNode : public SearchPolicyNode {
 
   size_t n_trials = 0;
 
+  /*!
+   * \brief The distinct tile sizes, indexed by [memory level][dimension], of the hardware-aligned
+   *        configurations that survive the filters. The hybrid mode only mutates the tile sizes
+   *        within this lattice.
+   */
+  std::vector<std::vector<std::vector<int>>> aligned_space_lattice, aligned_reduce_lattice;
+  /*!
+   * \brief The workload instances that the evolutionary search scores the states on
+   *        (all the instances if empty).
+   */
+  std::vector<size_t> refine_wkl_inst_ids;
+  /*!
+   * \brief The adaption penalties (occupancy penalty * padding penalty) of every workload
+   *        instance on the state that is being mutated, which guide the tile size mutation
+   *        of dynamic tasks (empty if not available).
+   */
+  std::vector<float> mutation_inst_adapt_penalty;
+  /*!
+   * \brief The number of trials at which the predicted FLOPS of each workload instance last
+   *        improved, and the predicted FLOPS at that point (for the per-instance early stopping).
+   */
+  std::vector<int> inst_best_ct;
+  std::vector<float> inst_tracked_flops;
+  /*! \brief Whether each workload instance has converged (i.e., stops receiving trials). */
+  std::vector<bool> inst_converged;
+  /*! \brief Whether all the weighted workload instances had converged after `MeasureAndUpdate`. */
+  bool all_insts_converged = false;
+
  private:
   void CalculateInstOptProb(const ProgramMeasurer& measurer);
+  /*!
+   * \brief Update the convergence of each workload instance of a dynamic task. An instance
+   *        converges if its predicted FLOPS has plateaued (no significant improvement in the last
+   *        `early_stopping` trials) or has approached the roofline of the hardware.
+   * \param measurer The measurer of the search.
+   * \param ct The number of completed trials.
+   * \param early_stopping The per-instance early stopping threshold.
+   * \return Whether all the workload instances w/ non-zero weights have converged.
+   */
+  bool UpdateInstConvergence(const ProgramMeasurer& measurer, int ct, int early_stopping);
 
  public:
   // <efficient>
@@ -152,6 +212,57 @@ class SketchPolicyNode : public SearchPolicyNode {
       ProgramMeasurer measurer) final;
   // <efficient>
   std::vector<hardware::HwAlignedConfig> EmitConfig(int space_dims, int reduce_dims);
+  /*!
+   * \brief Emit the configurations of memory-bound row reductions, i.e., the number of threads
+   *        per row (multiples of the warp size) and the vector width (such that a warp accesses
+   *        whole memory transactions), stored in `reduce_tiles[0][0]` and `space_tiles[0][0]`.
+   */
+  std::vector<hardware::HwAlignedConfig> EmitRowReductionConfig();
+  /*!
+   * \brief Emit the hardware-aligned configurations and materialize them into candidate states,
+   *        keeping the ones that pass the occupancy, launch-bound, padding and compute-intensity
+   *        filters for at least one workload instance (the candidates of `EfficientSearch`).
+   */
+  std::pair<std::vector<hardware::HwAlignedConfig>, std::vector<State>> EmitFilteredCandidates();
+  /*! \brief The counterpart of `EmitFilteredCandidates` for memory-bound row reductions. */
+  std::pair<std::vector<hardware::HwAlignedConfig>, std::vector<State>>
+  EmitRowReductionCandidates();
+  /*!
+   * \brief Dispatch every workload instance of a dynamic task without any measurement: the
+   *        candidates of `EfficientSearch` are scored analytically (compute intensity adapted
+   *        by the occupancy and padding penalties of each instance) and dispatched with the
+   *        `TopKDispatcher`.
+   */
+  std::pair<std::vector<State>, std::unordered_map<size_t, size_t>> AnalyticalDispatch();
+  /*! \brief The counterpart of `EfficientSearch` for memory-bound row reductions. */
+  std::pair<std::vector<State>, std::unordered_map<size_t, size_t>> EfficientRowReductionSearch(
+      ProgramMeasurer measurer);
+  /*!
+   * \brief Recover the hardware-aligned configuration that a state is generated from.
+   * \return false if the state is not generated by `efficient_init_rules`.
+   */
+  bool DecodeAlignedConfig(const State& state, hardware::HwAlignedConfig* config) const;
+  /*!
+   * \brief Apply `efficient_init_rules` on the sketch w/ a hardware-aligned configuration.
+   * \return The generated state, undefined if any of the rules fails.
+   */
+  State MaterializeAlignedConfig(const hardware::HwAlignedConfig& config);
+  /*!
+   * \brief The hybrid mode, which seeds the evolutionary search with the measured
+   *        hardware-aligned states and spends `num_trials` extra trials on the workload
+   *        instances whose dispatched states have the largest predicted gap to the roofline.
+   * \param measurer The measurer of the one-shot search.
+   * \param num_trials The extra trial budget.
+   * \param seed_inputs The measured hardware-aligned states.
+   * \param seed_results The measurement results of `seed_inputs`.
+   * \param inst_scores The adapted throughput of the dispatched state of each instance.
+   * \param states The dispatched states, to which the refined states are appended.
+   * \param inst_disp_map The dispatch map, updated for the refined instances.
+   */
+  void HybridRefine(ProgramMeasurer measurer, int num_trials,
+                    const Array<MeasureInput>& seed_inputs,
+                    const Array<MeasureResult>& seed_results, std::vector<float>* inst_scores,
+                    std::vector<State>* states, std::unordered_map<size_t, size_t>* inst_disp_map);
   // <bojian/DietCode>
   // State
   // Array<ObjectRef>
@@ -163,6 +274,36 @@ class SketchPolicyNode : public SearchPolicyNode {
   // std::pair<Array<MeasureInput>, Array<MeasureResult>>
   std::pair<int, float> ContinueSearchOneRound(int num_measure, ProgramMeasurer measurer) final;
 
+  /*!
+   * \brief The search phase of `ContinueSearchOneRound`, which does not touch the measurer and can
+   *        hence run concurrently with the search phases of other policies.
+   * \param num_measure The number of programs to measure in this round.
+   * \return The states to measure.
+   */
+  Array<MeasureInput> ProposeMeasureInputs(int num_measure);
+  /*!
+   * \brief The measurement phase of `ContinueSearchOneRound`, which measures the proposed states
+   *        and updates the measured states, the instance probabilities and the cost model.
+   * \return The number of measured states and the best (flop-weighted) latency so far.
+   */
+  std::pair<int, float> MeasureAndUpdate(const Array<MeasureInput>& inputs,
+                                         ProgramMeasurer measurer);
+
+  /*!
+   * \brief Save the search state, i.e., the measured states, the random generator, the instance
+   *        optimization probabilities and the measurement history (from which the cost model is
+   *        retrained), together with the per-instance bests of the measurer, to a binary file.
+   * \param filename The checkpoint file, which is replaced atomically.
+   * \param measurer The measurer of the search.
+   * \param ct The number of completed trials.
+   */
+  void SaveCheckpoint(const std::string& filename, const ProgramMeasurer& measurer, int ct) const;
+  /*!
+   * \brief Restore the search state saved by `SaveCheckpoint`.
+   * \return The number of completed trials, -1 if the checkpoint file does not exist.
+   */
+  int LoadCheckpoint(const std::string& filename, const ProgramMeasurer& measurer);
+
   /*!
    * \brief Generate sketches.
    * \return The generated sketches(states).
@@ -218,6 +359,10 @@ class SketchPolicyNode : public SearchPolicyNode {
   /*! \brief The minimul output population of SampleInitPopulation */
   int sample_init_min_pop_;
 
+  /*! \brief The measurement history of `Search`, replayed to the cost model on resume. */
+  Array<MeasureInput> measured_inputs_;
+  Array<MeasureResult> measured_results_;
+
   friend class SketchPolicy;
 };
 
@@ -695,9 +695,63 @@ EfficientGenerationRule::ResultKind InitEfficientUnroll::Apply(
   return ResultKind::kValid;
 }
 
+EfficientGenerationRule::ResultKind InitEfficientRowReduction::Apply(
+    SketchPolicyNode* policy, State* state, hardware::HwAlignedConfig config) const {
+  const SearchTask& task = policy->search_task;
+  const int threads_per_row = config.reduce_tiles[0][0];
+  const int vector_width = config.space_tiles[0][0];
+
+  *state = task->compute_dag->init_state;
+  // Inline the element-wise producers (e.g., the exp of softmax) into their consumers.
+  for (int stage_id = static_cast<int>((*state)->stages.size()) - 1; stage_id >= 0; --stage_id) {
+    if ((*state)->stages[stage_id]->op_type == StageKind::kPlaceholder ||
+        IsOutputOp(task, *state, stage_id)) {
+      continue;
+    }
+    if (IsStrictlyInlineable(task, *state, stage_id)) {
+      state->compute_inline(stage_id);
+    }
+  }
+  *state = task->compute_dag.InferBound(*state);
+
+  for (int stage_id = static_cast<int>((*state)->stages.size()) - 1; stage_id >= 0; --stage_id) {
+    const Stage& stage = (*state)->stages[stage_id];
+    if (stage->compute_at == ComputeAtKind::kInlined || stage->op_type == StageKind::kPlaceholder) {
+      continue;
+    }
+    if (HasReduceIter(stage)) {
+      // one row per thread block, reduced cooperatively by the threads
+      Iterator fused_reduce_iter;
+      Array<Iterator> space_iters, reduce_iters;
+      *state = FuseAllReductionIterators(*state, stage_id, &fused_reduce_iter, &space_iters,
+                                         &reduce_iters);
+      const auto& split_res = state->split(stage_id, fused_reduce_iter, {Integer(threads_per_row)});
+      state->bind(stage_id, split_res[1], IteratorAnnotation::kThreadX);
+      if (!space_iters.empty()) {
+        Iterator fused_space_iter;
+        *state = FuseAllOuterSpaceIterators(*state, stage_id, &fused_space_iter);
+        state->bind(stage_id, fused_space_iter, IteratorAnnotation::kBlockX);
+      }
+    } else {
+      Iterator fused_it;
+      *state = FuseAllOuterSpaceIterators(*state, stage_id, &fused_it);
+      const auto& split_res =
+          state->split(stage_id, fused_it, {Integer(threads_per_row), Integer(vector_width)});
+      state->bind(stage_id, split_res[0], IteratorAnnotation::kBlockX);
+      state->bind(stage_id, split_res[1], IteratorAnnotation::kThreadX);
+      if (vector_width > 1) {
+        state->vectorize(stage_id, split_res[2]);
+      }
+    }
+  }
+  StateNode* pstate = state->CopyOnWrite();
+  pstate->concrete = true;
+  return ResultKind::kValid;
+}
+
 /********** Init Population **********/
 
-extern bool is_sample_init_population_1st_iter;
+extern thread_local bool is_sample_init_population_1st_iter;
 extern bool enable_verbose_logging;
 constexpr bool simplify_sketch = true;
 
@@ -1453,6 +1507,9 @@ static PopulationGenerationRule::ResultKind AdjustUnrollingFactor(State* state)
   return PopulationGenerationRule::ResultKind::kValid;
 }
 
+/*! \brief The probability that a tile size mutation of a dynamic task is guided. */
+constexpr double C_GUIDED_MUTATION_PROB = 0.5;
+
 PopulationGenerationRule::ResultKind MutateInnermostTileSize::Apply(SketchPolicyNode* policy,
                                                                     State* state,
                                                                     std::mt19937* rand_gen) const {
@@ -1507,8 +1564,31 @@ PopulationGenerationRule::ResultKind MutateInnermostTileSize::Apply(SketchPolicy
   // calculated in measure.cc, is based on the formula:
   //
   // flop * freq / thruput
-  Array<IntImm> selected_inst =
-      policy->search_task->wkl_insts[RandomChoose(policy->curr_inst_opt_prob, rand_gen)];
+  //
+  // <efficient> If the adaption penalties of the state are known, favor the
+  // instances that the state serves poorly and mutate toward them.
+  const std::vector<float>& adapt_penalty = policy->mutation_inst_adapt_penalty;
+  const bool do_guided_mutation =
+      adapt_penalty.size() == policy->search_task->wkl_insts.size() &&
+      std::uniform_real_distribution<>(0., 1.)(*rand_gen) < C_GUIDED_MUTATION_PROB;
+  size_t selected_inst_id = RandomChoose(policy->curr_inst_opt_prob, rand_gen);
+
+  if (do_guided_mutation) {
+    std::vector<float> inst_weights;
+    float total_weight = 0.;
+    for (size_t i = 0; i < adapt_penalty.size(); ++i) {
+      const double inst_prob =
+          policy->curr_inst_opt_prob[i] - (i == 0 ? 0. : policy->curr_inst_opt_prob[i - 1]);
+      inst_weights.push_back(inst_prob * std::max(1.f - adapt_penalty[i], 0.f));
+      total_weight += inst_weights.back();
+    }
+    if (total_weight > 0.) {
+      std::vector<double> inst_probs;
+      ComputePrefixSumProb(inst_weights, &inst_probs);
+      selected_inst_id = RandomChoose(inst_probs, rand_gen);
+    }
+  }
+  Array<IntImm> selected_inst = policy->search_task->wkl_insts[selected_inst_id];
 
   // LOG(INFO) << "Selected inst=" << ArrayToString(selected_inst);
 
@@ -1530,8 +1610,11 @@ PopulationGenerationRule::ResultKind MutateInnermostTileSize::Apply(SketchPolicy
 
   StateNode* pstate = state->CopyOnWrite();
   FactorizationScheme mutated_scheme;
-  mutated_scheme = policy->dietcode_split_memo.MutateFactorizationScheme(split_steps_info, rand_gen,
-                                                                         curr_split_factors);
+  if (!do_guided_mutation || !policy->dietcode_split_memo.GuidedMutateFactorizationScheme(
+                                 split_steps_info, rand_gen, curr_split_factors, &mutated_scheme)) {
+    mutated_scheme = policy->dietcode_split_memo.MutateFactorizationScheme(
+        split_steps_info, rand_gen, curr_split_factors);
+  }
   // LOG(INFO) << "Mutated factorization scheme=" << mutated_scheme.toString();
 
   CHECK(mutated_scheme.split_factors.size() == split_step_ids.size());
@@ -1622,6 +1705,78 @@ PopulationGenerationRule::ResultKind MutateInnermostTileSize::Apply(SketchPolicy
   return AdjustUnrollingFactor(state);
 }
 
+PopulationGenerationRule::ResultKind MutateAlignedTileSize::Apply(SketchPolicyNode* policy,
+                                                                  State* state,
+                                                                  std::mt19937* rand_gen) const {
+  hardware::HwAlignedConfig config;
+  if (policy->aligned_space_lattice.empty() || !policy->DecodeAlignedConfig(*state, &config)) {
+    return ResultKind::kInvalid;
+  }
+  // the (tiles, dimension, lattice) of the knobs that have more than one point on the lattice
+  std::vector<std::tuple<std::vector<int>*, size_t, const std::vector<int>*>> knobs;
+  for (size_t level = 0; level < config.space_tiles.size(); ++level) {
+    for (size_t dim = 0; dim < config.space_tiles[level].size(); ++dim) {
+      if (policy->aligned_space_lattice[level][dim].size() > 1) {
+        knobs.emplace_back(&config.space_tiles[level], dim,
+                           &policy->aligned_space_lattice[level][dim]);
+      }
+    }
+    for (size_t dim = 0; dim < config.reduce_tiles[level].size(); ++dim) {
+      if (policy->aligned_reduce_lattice[level][dim].size() > 1) {
+        knobs.emplace_back(&config.reduce_tiles[level], dim,
+                           &policy->aligned_reduce_lattice[level][dim]);
+      }
+    }
+  }
+  if (knobs.empty()) {
+    return ResultKind::kInvalid;
+  }
+  std::vector<int>* tiles;
+  size_t dim;
+  const std::vector<int>* lattice;
+  std::tie(tiles, dim, lattice) = knobs[(*rand_gen)() % knobs.size()];
+  // move to one of the neighbouring points on the lattice
+  std::vector<int> neighbours;
+  auto lower = std::lower_bound(lattice->begin(), lattice->end(), (*tiles)[dim]);
+  auto upper = std::upper_bound(lattice->begin(), lattice->end(), (*tiles)[dim]);
+  if (lower != lattice->begin()) {
+    neighbours.push_back(*(lower - 1));
+  }
+  if (upper != lattice->end()) {
+    neighbours.push_back(*upper);
+  }
+  if (neighbours.empty()) {
+    return ResultKind::kInvalid;
+  }
+  (*tiles)[dim] = neighbours[(*rand_gen)() % neighbours.size()];
+
+  // the outer tiles have to be multiples of the inner ones
+  for (size_t level = 0; level + 1 < config.space_tiles.size(); ++level) {
+    for (size_t i = 0; i < config.space_tiles[level].size(); ++i) {
+      if (config.space_tiles[level][i] % config.space_tiles[level + 1][i] != 0) {
+        return ResultKind::kInvalid;
+      }
+    }
+    for (size_t i = 0; i < config.reduce_tiles[level].size(); ++i) {
+      if (config.reduce_tiles[level][i] % config.reduce_tiles[level + 1][i] != 0) {
+        return ResultKind::kInvalid;
+      }
+    }
+  }
+  // same as the thread constraints of `ConfigFilter` and `ThreadsNumberFilter`
+  const hardware::HardwareAPI& hardware_api = policy->search_task->hardware_api;
+  config.threads_num = GetParallelism(config.space_tiles[0], config.space_tiles[1]);
+  if (!IsValidAlignedThreadsNum(config.threads_num, hardware_api)) {
+    return ResultKind::kInvalid;
+  }
+  State new_state = policy->MaterializeAlignedConfig(config);
+  if (!new_state.defined()) {
+    return ResultKind::kInvalid;
+  }
+  *state = std::move(new_state);
+  return ResultKind::kValid;
+}
+
 PopulationGenerationRule::ResultKind MutateTileSize::Apply(SketchPolicyNode* policy, State* state,
                                                            std::mt19937* rand_gen) const {
   int max_innermost_split_factor =
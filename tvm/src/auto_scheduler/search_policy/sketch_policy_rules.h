@@ -193,6 +193,14 @@ DEFINE_INIT_EFFICIENT_RULE(InitEfficientThreadBind);
 
 DEFINE_INIT_EFFICIENT_RULE(InitEfficientUnroll);
 
+/*!
+ * \brief The rule that schedules memory-bound row reductions (e.g., softmax and layernorm)
+ *        from the initial state: each reduction is a cross-thread reduction with
+ *        `reduce_tiles[0][0]` threads per row and each element-wise stage is split into
+ *        (blocks, threads, `space_tiles[0][0]` vectorized lanes).
+ */
+DEFINE_INIT_EFFICIENT_RULE(InitEfficientRowReduction);
+
 /********** Init Population **********/
 
 /*! \brief The base class for rules used to annotate the sketches to get the initial population. */
@@ -273,6 +281,10 @@ DEFINE_MUTATE_POPULATION_RULE(MutateTileSize);
 DEFINE_MUTATE_POPULATION_RULE(MutateRandomTileSize);
 DEFINE_MUTATE_POPULATION_RULE(MutateInnermostTileSize);
 
+/*! \brief The rule that moves one tile size of a hardware-aligned state to a neighbouring point
+ *         of the aligned tile lattice, used by the hybrid mode. */
+DEFINE_MUTATE_POPULATION_RULE(MutateAlignedTileSize);
+
 
 /*! \brief The rule that mutates the number of fused outer iterators annotated by parallel. */
 DEFINE_MUTATE_POPULATION_RULE(MutateParallel);
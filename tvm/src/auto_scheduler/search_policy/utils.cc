@@ -578,7 +578,7 @@ void PruneInvalidState(const SearchTask& task, Array<State>* states) {
 
 /********** SplitFactorizationMemo **********/
 
-extern bool is_sample_init_population_1st_iter;
+extern thread_local bool is_sample_init_population_1st_iter;
 extern bool enable_verbose_logging;
 
 const Array<Array<Integer>>& SplitFactorizationMemo::GetFactorizationSchemes(
@@ -1316,6 +1316,124 @@ FactorizationScheme DietCodeSplitFactorizationMemo::MutateFactorizationScheme(
   return scheme;
 }
 
+// <efficient>
+float EstimateAdaptPenalty(const std::vector<SplitStepInfo>& split_steps_info,
+                           const std::vector<std::vector<int>>& split_factors,
+                           const size_t num_cores) {
+  float padding_penalty = 1.;
+  size_t grid_size = 1;
+  for (size_t i = 0; i < split_steps_info.size(); ++i) {
+    if (!split_steps_info[i].is_spatial) {
+      continue;
+    }
+    size_t split_length = 1;
+    for (const int f : split_factors[i]) {
+      split_length *= f;
+    }
+    size_t extent = split_steps_info[i].max_extent;
+    padding_penalty *= extent * 1. / floor_by(extent, split_length);
+    grid_size *= floor_div(extent, split_length);
+  }
+  return padding_penalty * grid_size / floor_by(grid_size, num_cores);
+}
+
+bool DietCodeSplitFactorizationMemo::GuidedMutateFactorizationScheme(
+    const std::vector<SplitStepInfo>& split_steps_info, std::mt19937* const rng,
+    const std::vector<std::vector<int>>& curr_split_factors,
+    FactorizationScheme* const scheme) const {
+  static const std::vector<int> C_FACTOR_STEPS = {2, 3};
+
+  size_t last_spatial_iter_id = -1;
+  for (size_t iter_id = 0; iter_id < split_steps_info.size(); ++iter_id) {
+    if (split_steps_info[iter_id].is_spatial) {
+      last_spatial_iter_id = iter_id;
+    }
+  }
+  if (last_spatial_iter_id == -1UL) {
+    return false;
+  }
+  const float curr_penalty =
+      EstimateAdaptPenalty(split_steps_info, curr_split_factors, hardware_params_->num_cores);
+  float best_penalty = curr_penalty;
+  std::vector<std::vector<std::vector<int>>> best_candidates;
+
+  std::vector<std::vector<int>> candidate = curr_split_factors;
+  auto try_candidate = [&](const size_t iter_id, const size_t factor_id, const int new_factor) {
+    const int curr_factor = curr_split_factors[iter_id][factor_id];
+    if (new_factor < 1 || new_factor == curr_factor) {
+      return;
+    }
+    // Follow the limits of the random sampling: the vthread factor of the last
+    // spatial iterator and the innermost factors of the others.
+    if ((factor_id == 0 && new_factor > hardware_params_->max_vthread_extent) ||
+        (factor_id == 3 && max_innermost_factor_ != 0 && new_factor > max_innermost_factor_)) {
+      return;
+    }
+    int64_t curr_split_length = 1;
+    for (const int f : curr_split_factors[iter_id]) {
+      curr_split_length *= f;
+    }
+    int64_t new_split_length = curr_split_length / curr_factor * new_factor;
+    // Do not let the tile grow much beyond the extent of the instance.
+    if (new_split_length > curr_split_length &&
+        new_split_length > static_cast<int64_t>(split_steps_info[iter_id].max_extent * 1.1)) {
+      return;
+    }
+    candidate[iter_id][factor_id] = new_factor;
+    float penalty = EstimateAdaptPenalty(split_steps_info, candidate, hardware_params_->num_cores);
+    if (penalty > best_penalty + 1e-6) {
+      best_penalty = penalty;
+      best_candidates.clear();
+    }
+    if (penalty > curr_penalty + 1e-6 && std::abs(penalty - best_penalty) <= 1e-6) {
+      best_candidates.push_back(candidate);
+    }
+    candidate[iter_id][factor_id] = curr_factor;
+  };
+
+  for (size_t iter_id = 0; iter_id < split_steps_info.size(); ++iter_id) {
+    if (!split_steps_info[iter_id].is_spatial) {
+      continue;
+    }
+    const size_t factor_id = iter_id == last_spatial_iter_id ? 0 : 3;
+    const int curr_factor = curr_split_factors[iter_id][factor_id];
+    int64_t other_factors = 1;
+    for (size_t j = 0; j < curr_split_factors[iter_id].size(); ++j) {
+      if (j != factor_id) {
+        other_factors *= curr_split_factors[iter_id][j];
+      }
+    }
+    // 1. Small steps, which mostly trade the grid size for the tile size.
+    for (const int step : C_FACTOR_STEPS) {
+      try_candidate(iter_id, factor_id, curr_factor * step);
+      if (curr_factor % step == 0) {
+        try_candidate(iter_id, factor_id, curr_factor / step);
+      }
+    }
+    // 2. Tiles that divide the extent of the instance (i.e., no padding).
+    const int64_t extent = split_steps_info[iter_id].max_extent;
+    if (extent % other_factors == 0) {
+      int64_t quotient = extent / other_factors;
+      for (int64_t f = 1; f * f <= quotient; ++f) {
+        if (quotient % f == 0) {
+          try_candidate(iter_id, factor_id, f);
+          try_candidate(iter_id, factor_id, quotient / f);
+        }
+      }
+    }
+  }  // for (iter_id ∈ [0, split_steps_info.size()))
+
+  if (best_candidates.empty()) {
+    return false;
+  }
+  scheme->split_factors = RandomChooseAmong(best_candidates, rng);
+  if (enable_verbose_logging) {
+    LOG(INFO) << "Guided mutation improves the adaption penalty from " << curr_penalty << " to "
+              << best_penalty << ", factorization scheme=" << scheme->toString();
+  }
+  return true;
+}
+
 /********** Utils interface API for ffi **********/
 
 TVM_REGISTER_GLOBAL("auto_scheduler.SearchPolicyUtilsGetConsumers")
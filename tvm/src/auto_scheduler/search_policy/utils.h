@@ -94,6 +94,25 @@ inline int GetParallelism(std::vector<int> large_tile, std::vector<int> small_ti
   return num_threads;
 }
 
+/*! \brief The maximum number of threads that a thread block can launch with. */
+constexpr int C_MAX_THREADS_PER_BLOCK = 1024;
+
+/*!
+ * \brief Return whether a hardware-aligned thread block is launchable, i.e., it has at most
+ *        C_MAX_THREADS_PER_BLOCK threads and fills whole warps on every SM sub-partition.
+ */
+inline bool IsValidAlignedThreadsNum(const int threads_num,
+                                     const hardware::HardwareAPI& hardware_api) {
+  return threads_num <= C_MAX_THREADS_PER_BLOCK &&
+         threads_num % (hardware_api->warp_size * hardware_api->compute_sm_partition[1]->value) ==
+             0;
+}
+
+/*! \brief Return the weight of a workload instance, uniform if the task carries no weights. */
+inline double GetWklInstWeight(const SearchTask& task, const size_t inst_id) {
+  return task->wkl_inst_weights.empty() ? 1. : task->wkl_inst_weights[inst_id]->value;
+}
+
 /*! \brief Return whether the search task is targeting a CPU. */
 inline bool IsCPUTask(const SearchTask& task) {
   return (task)->target->kind->device_type == kDLCPU;
@@ -447,6 +466,27 @@ inline bool HasReduceIter(const Stage& stage) {
   return false;
 }
 
+// <efficient>
+/*!
+ * \brief Return whether the task only consists of memory-bound reductions (e.g., softmax and
+ *        layernorm), which have no data reuse to be tiled by `EmitConfig`.
+ */
+inline bool IsRowReductionTask(const SearchTask& task) {
+  const State& init_state = task->compute_dag->init_state;
+  bool has_reduction = false;
+  for (size_t stage_id = 0; stage_id < init_state->stages.size(); ++stage_id) {
+    const Stage& stage = init_state->stages[stage_id];
+    if (stage->op_type == StageKind::kPlaceholder) {
+      continue;
+    }
+    if (NeedsMultilevelTiling(task, init_state, stage_id)) {
+      return false;
+    }
+    has_reduction |= HasReduceIter(stage);
+  }
+  return has_reduction;
+}
+
 /*! \brief Return whether the stage has specific annotated iterators. */
 inline bool HasAnnotatedIter(const Stage& stage, IteratorAnnotation type) {
   for (const auto& iter : stage->iters) {
@@ -736,7 +776,10 @@ inline Array<State> RandomSampleStates(const Array<State>& in_states, std::mt199
   return out_states;
 }
 
-/*! \brief Compute prefix-sum probabiilty based on the given weights */
+/*!
+ * \brief Compute prefix-sum probabiilty based on the given weights. The probability is uniform if
+ *        none of the weights is positive.
+ */
 inline void ComputePrefixSumProb(const std::vector<float>& weights,
                                  std::vector<double>* prefix_sum_probs) {
   // Compute selection probabilities.
@@ -747,7 +790,7 @@ inline void ComputePrefixSumProb(const std::vector<float>& weights,
     (*prefix_sum_probs)[i] = sum;
   }
   for (size_t i = 0; i < weights.size(); ++i) {
-    (*prefix_sum_probs)[i] /= sum;
+    (*prefix_sum_probs)[i] = sum > 0 ? (*prefix_sum_probs)[i] / sum : (i + 1.) / weights.size();
   }
 }
 
@@ -920,6 +963,16 @@ struct FactorizationScheme {
   // }
 };
 
+// <efficient>
+/*!
+ * \brief Estimate the occupancy and padding penalties of the split factors on
+ *        one workload instance, following the default heuristic of
+ *        AdaptStateToWorkload (1 means no loss, smaller values mean larger losses).
+ */
+float EstimateAdaptPenalty(const std::vector<SplitStepInfo>& split_steps_info,
+                           const std::vector<std::vector<int>>& split_factors,
+                           const size_t num_cores);
+
 enum FactorizationSchemeCheckRetType {
   kValid,    // a valid scheme
   kInvalid,  // not a valid scheme, but can keep expanding
@@ -974,6 +1027,20 @@ class DietCodeSplitFactorizationMemo {
   FactorizationScheme MutateFactorizationScheme(
       const std::vector<SplitStepInfo>& split_steps_info, std::mt19937* const rng,
       const std::vector<std::vector<int>>& curr_split_factors);
+
+  // <efficient>
+  /**
+   * \brief Mutate the factorization scheme toward a better adaption to the
+   *        workload instance whose extents are in split_steps_info, i.e.,
+   *        toward spatial tiles that divide the extents (less padding) and
+   *        toward grids that fill all the cores (less occupancy loss). The
+   *        number of threads per block is left unchanged.
+   * \return Whether a mutation that improves the adaption has been found.
+   */
+  bool GuidedMutateFactorizationScheme(const std::vector<SplitStepInfo>& split_steps_info,
+                                       std::mt19937* const rng,
+                                       const std::vector<std::vector<int>>& curr_split_factors,
+                                       FactorizationScheme* const scheme) const;
 };
 
 /*! \brief Get the indexes of SplitStep that processes on spatial iterator. */
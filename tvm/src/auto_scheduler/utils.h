@@ -768,10 +768,45 @@ class FlopEstimator : public tir::ExprFunctor<double(const PrimExpr& n)> {
 };
 
 // <efficient>
-void AlignHWAdaptStateToWorkload(const SearchTask& task, const State& state,
-                                 const Array<IntImm>& wkl_inst, const float score,
-                                 float* const occupancy_penalty, float* const padding_penalty,
-                                 float* const adapted_score);
+/*!
+ * \brief Get the blockIdx.x extents of the kernels of a row-reduction state (see
+ *        `IsRowReductionTask`), in terms of the shape variables. They do not depend on the
+ *        workload instance, hence can be computed once per state.
+ */
+Array<PrimExpr> GetRowReductionGridExtents(const SearchTask& task, const State& state);
+
+/*!
+ * \brief Adapt the score of a state to a workload instance by its occupancy and padding.
+ * \param row_reduction_grid_extents The grid extents of a row-reduction state (see
+ *        `GetRowReductionGridExtents`), which are computed from the state if not given and the
+ *        task is a row reduction. States of other tasks are multi-level tiled.
+ */
+void AlignHWAdaptStateToWorkload(
+    const SearchTask& task, const State& state, const Array<IntImm>& wkl_inst, const float score,
+    float* const occupancy_penalty, float* const padding_penalty, float* const adapted_score,
+    const Optional<Array<PrimExpr>>& row_reduction_grid_extents = NullOpt);
+
+/*!
+ * \brief Estimate the efficiency of a row-reduction state (see `IsRowReductionTask`) on a
+ *        workload instance, i.e., the ratio between the ideal steps of spreading the data over
+ *        all the memory lanes and the modeled steps of its kernels. The cross-thread reductions
+ *        load the rows in waves and then reduce each of them in log2(threads_per_row) steps,
+ *        and the element-wise stages are vectorized by their vector widths.
+ * \return A value in (0, 1], where a higher value is better.
+ */
+float EstimateRowReductionEfficiency(const SearchTask& task, const State& state,
+                                     const Array<IntImm>& wkl_inst);
+
+/*!
+ * \brief Dispatch every workload instance of the task to the state with the highest adapted
+ *        score. An instance whose grid is too small to fill the device with any of the states
+ *        (i.e., scored -1 by `AlignHWAdaptStateToWorkload`) is dispatched to the state with the
+ *        highest score before that threshold.
+ * \return The index of the state that each workload instance is dispatched to, and its score.
+ */
+std::vector<std::pair<size_t, float>> DispatchToAdaptedStates(const SearchTask& task,
+                                                              const std::vector<State>& states,
+                                                              const std::vector<float>& scores);
 
 void AdaptStateToWorkload(const SearchTask& task, const State& state,
                           const Array<IntImm>& shape_values,
@@ -31,14 +31,22 @@
 #include <tvm/runtime/registry.h>
 
 #include <cctype>
+#include <cerrno>
+#include <cstdlib>
 #include <map>
 #include <string>
+#include <unordered_map>
 
 #include "../runtime/object_internal.h"
 #include "../support/base64.h"
 
 namespace tvm {
 
+/*! \brief Magic number of the binary node format ("TVMNODEB"). */
+constexpr uint64_t kTVMNodeBinaryMagic = 0x4245444F4E4D5654;
+/*! \brief Version of the binary node format. */
+constexpr uint64_t kTVMNodeBinaryVersion = 1;
+
 inline std::string Type2String(const DataType& t) { return runtime::DLDataType2String(t); }
 
 inline DataType String2Type(std::string s) { return DataType(runtime::String2DLDataType(s)); }
@@ -450,6 +458,12 @@ struct JSONGraph {
   std::vector<std::string> b64ndarrays;
   // global attributes
   AttrMap attrs;
+  /*!
+   * \brief raw (not base64-encoded) bytes of the arrays.
+   * NOTE: This is an auxiliary data structure for the binary format, and it won't be serialized
+   * to json.
+   */
+  std::vector<std::string> raw_ndarrays;
 
   void Save(dmlc::JSONWriter* writer) const {
     writer->BeginObject();
@@ -472,7 +486,7 @@ struct JSONGraph {
     helper.ReadAllFields(reader);
   }
 
-  static JSONGraph Create(const ObjectRef& root) {
+  static JSONGraph Create(const ObjectRef& root, bool b64_ndarrays = true) {
     JSONGraph g;
     NodeIndexer indexer;
     indexer.MakeIndex(const_cast<Object*>(root.get()));
@@ -491,6 +505,11 @@ struct JSONGraph {
     for (DLTensor* tensor : indexer.tensor_list_) {
       std::string blob;
       dmlc::MemoryStringStream mstrm(&blob);
+      if (!b64_ndarrays) {
+        runtime::SaveDLTensor(&mstrm, tensor);
+        g.raw_ndarrays.emplace_back(std::move(blob));
+        continue;
+      }
       support::Base64OutStream b64strm(&mstrm);
       runtime::SaveDLTensor(&b64strm, tensor);
       b64strm.Finish();
@@ -543,28 +562,17 @@ std::string SaveJSON(const ObjectRef& n) {
   return os.str();
 }
 
-ObjectRef LoadJSON(std::string json_str) {
+/*!
+ * \brief Reconstruct the objects of a graph that has been loaded from json or binary.
+ * \param jgraph_ptr The loaded graph.
+ * \param tensors The arrays that the graph refers to.
+ * \return The root object.
+ */
+static ObjectRef CreateFromGraph(JSONGraph* jgraph_ptr,
+                                 const std::vector<runtime::NDArray>& tensors) {
   ReflectionVTable* reflection = ReflectionVTable::Global();
-  JSONGraph jgraph;
-  {
-    // load in json graph.
-    std::istringstream is(json_str);
-    dmlc::JSONReader reader(&is);
-    jgraph.Load(&reader);
-  }
+  JSONGraph& jgraph = *jgraph_ptr;
   size_t n_nodes = jgraph.nodes.size();
-  std::vector<runtime::NDArray> tensors;
-  {
-    // load in tensors
-    for (const std::string& blob : jgraph.b64ndarrays) {
-      dmlc::MemoryStringStream mstrm(const_cast<std::string*>(&blob));
-      support::Base64InStream b64strm(&mstrm);
-      b64strm.InitPosition();
-      runtime::NDArray temp;
-      ICHECK(temp.Load(&b64strm));
-      tensors.emplace_back(std::move(temp));
-    }
-  }
   // Pass 1: create all non-container objects
   std::vector<ObjectPtr<Object>> nodes(n_nodes, nullptr);
   for (size_t i = 0; i < n_nodes; ++i) {
@@ -594,7 +602,266 @@ ObjectRef LoadJSON(std::string json_str) {
   return ObjectRef(nodes.at(jgraph.root));
 }
 
+ObjectRef LoadJSON(std::string json_str) {
+  JSONGraph jgraph;
+  {
+    // load in json graph.
+    std::istringstream is(json_str);
+    dmlc::JSONReader reader(&is);
+    jgraph.Load(&reader);
+  }
+  std::vector<runtime::NDArray> tensors;
+  {
+    // load in tensors
+    for (const std::string& blob : jgraph.b64ndarrays) {
+      dmlc::MemoryStringStream mstrm(const_cast<std::string*>(&blob));
+      support::Base64InStream b64strm(&mstrm);
+      b64strm.InitPosition();
+      runtime::NDArray temp;
+      ICHECK(temp.Load(&b64strm));
+      tensors.emplace_back(std::move(temp));
+    }
+  }
+  return CreateFromGraph(&jgraph, tensors);
+}
+
+// <efficient>
+/*!
+ * \brief Writer of the binary node format.
+ *
+ *  The format encodes the same graph as the json format:
+ *
+ *  - magic (8 bytes), version (varint)
+ *  - string table: count, then (length, bytes) of each string
+ *  - root, nodes, arrays and global attributes, where every string is an index
+ *    into the string table and every integer is a varint.
+ *
+ *  Attribute values that are canonical decimal integers (e.g., indices of
+ *  child nodes) are stored as zigzag varints rather than as strings.
+ */
+class BinaryGraphWriter {
+ public:
+  /*! \brief Tags of the attribute value encodings. */
+  enum AttrTag : char { kStrAttr = 0, kIntAttr = 1 };
+
+  std::string Write(const JSONGraph& g) {
+    WriteVarint(g.root);
+    WriteVarint(g.nodes.size());
+    for (const JSONNode& jnode : g.nodes) {
+      WriteVarint(Intern(jnode.type_key));
+      WriteVarint(Intern(jnode.repr_bytes));
+      WriteVarint(jnode.attrs.size());
+      for (const auto& kv : jnode.attrs) {
+        WriteVarint(Intern(kv.first));
+        WriteAttrValue(kv.second);
+      }
+      WriteVarint(jnode.keys.size());
+      for (const std::string& key : jnode.keys) {
+        WriteVarint(Intern(key));
+      }
+      WriteVarint(jnode.data.size());
+      for (size_t index : jnode.data) {
+        WriteVarint(index);
+      }
+    }
+    WriteVarint(g.raw_ndarrays.size());
+    for (const std::string& blob : g.raw_ndarrays) {
+      WriteVarint(blob.size());
+      body_.append(blob);
+    }
+    WriteVarint(g.attrs.size());
+    for (const auto& kv : g.attrs) {
+      WriteVarint(Intern(kv.first));
+      WriteVarint(Intern(kv.second));
+    }
+    // Prepend the header and the string table to the body.
+    std::string body = std::move(body_);
+    body_.clear();
+    for (int i = 0; i < 8; ++i) {
+      body_.push_back(static_cast<char>((kTVMNodeBinaryMagic >> (8 * i)) & 0xFF));
+    }
+    WriteVarint(kTVMNodeBinaryVersion);
+    WriteVarint(strings_.size());
+    for (const std::string* str : strings_) {
+      WriteVarint(str->size());
+      body_.append(*str);
+    }
+    body_.append(body);
+    return std::move(body_);
+  }
+
+ private:
+  void WriteVarint(uint64_t value) {
+    while (value >= 0x80) {
+      body_.push_back(static_cast<char>((value & 0x7F) | 0x80));
+      value >>= 7;
+    }
+    body_.push_back(static_cast<char>(value));
+  }
+
+  size_t Intern(const std::string& str) {
+    auto it = string_index_.find(str);
+    if (it != string_index_.end()) {
+      return it->second;
+    }
+    size_t index = strings_.size();
+    it = string_index_.emplace(str, index).first;
+    strings_.push_back(&it->first);
+    return index;
+  }
+
+  void WriteAttrValue(const std::string& value) {
+    int64_t ivalue;
+    if (ParseCanonicalInt(value, &ivalue)) {
+      body_.push_back(kIntAttr);
+      WriteVarint((static_cast<uint64_t>(ivalue) << 1) ^ static_cast<uint64_t>(ivalue >> 63));
+    } else {
+      body_.push_back(kStrAttr);
+      WriteVarint(Intern(value));
+    }
+  }
+
+  static bool ParseCanonicalInt(const std::string& str, int64_t* value) {
+    if (str.empty() || str.size() > 20) return false;
+    size_t i = str[0] == '-' ? 1 : 0;
+    if (i == str.size()) return false;
+    for (size_t j = i; j < str.size(); ++j) {
+      if (!std::isdigit(static_cast<unsigned char>(str[j]))) return false;
+    }
+    errno = 0;
+    *value = std::strtoll(str.c_str(), nullptr, 10);
+    // reject out-of-range values and non-canonical spellings (e.g., "007", "-0")
+    return errno == 0 && std::to_string(*value) == str;
+  }
+
+  std::string body_;
+  std::unordered_map<std::string, size_t> string_index_;
+  std::vector<const std::string*> strings_;
+};
+
+/*! \brief Reader of the binary node format written by BinaryGraphWriter. */
+class BinaryGraphReader {
+ public:
+  explicit BinaryGraphReader(const std::string& bytes)
+      : ptr_(bytes.data()), end_(bytes.data() + bytes.size()) {}
+
+  JSONGraph Read() {
+    ICHECK_GE(end_ - ptr_, 8) << "LoadBinary: truncated header";
+    uint64_t magic = 0;
+    for (int i = 0; i < 8; ++i) {
+      magic |= static_cast<uint64_t>(static_cast<uint8_t>(ptr_[i])) << (8 * i);
+    }
+    ptr_ += 8;
+    ICHECK_EQ(magic, kTVMNodeBinaryMagic) << "LoadBinary: invalid magic number";
+    uint64_t version = ReadVarint();
+    ICHECK_EQ(version, kTVMNodeBinaryVersion) << "LoadBinary: unsupported version " << version;
+    strings_.resize(ReadVarint());
+    for (std::string& str : strings_) {
+      str = ReadBytes(ReadVarint());
+    }
+
+    JSONGraph g;
+    g.root = ReadVarint();
+    g.nodes.resize(ReadVarint());
+    for (JSONNode& jnode : g.nodes) {
+      jnode.type_key = ReadString();
+      jnode.repr_bytes = ReadString();
+      for (size_t n_attrs = ReadVarint(); n_attrs != 0; --n_attrs) {
+        std::string key = ReadString();
+        jnode.attrs[key] = ReadAttrValue();
+      }
+      jnode.keys.resize(ReadVarint());
+      for (std::string& key : jnode.keys) {
+        key = ReadString();
+      }
+      jnode.data.resize(ReadVarint());
+      for (size_t& index : jnode.data) {
+        index = ReadVarint();
+      }
+    }
+    g.raw_ndarrays.resize(ReadVarint());
+    for (std::string& blob : g.raw_ndarrays) {
+      blob = ReadBytes(ReadVarint());
+    }
+    for (size_t n_attrs = ReadVarint(); n_attrs != 0; --n_attrs) {
+      std::string key = ReadString();
+      g.attrs[key] = ReadString();
+    }
+    ICHECK(ptr_ == end_) << "LoadBinary: trailing bytes";
+    return g;
+  }
+
+ private:
+  uint64_t ReadVarint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      ICHECK(ptr_ < end_) << "LoadBinary: truncated varint";
+      uint8_t byte = static_cast<uint8_t>(*ptr_++);
+      value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      if (!(byte & 0x80)) return value;
+    }
+    LOG(FATAL) << "LoadBinary: malformed varint";
+    return 0;
+  }
+
+  std::string ReadBytes(uint64_t size) {
+    ICHECK_LE(size, static_cast<uint64_t>(end_ - ptr_)) << "LoadBinary: truncated bytes";
+    std::string bytes(ptr_, size);
+    ptr_ += size;
+    return bytes;
+  }
+
+  const std::string& ReadString() {
+    uint64_t index = ReadVarint();
+    ICHECK_LT(index, strings_.size()) << "LoadBinary: invalid string index";
+    return strings_[index];
+  }
+
+  std::string ReadAttrValue() {
+    ICHECK(ptr_ < end_) << "LoadBinary: truncated attribute";
+    char tag = *ptr_++;
+    if (tag == BinaryGraphWriter::kIntAttr) {
+      uint64_t zigzag = ReadVarint();
+      return std::to_string(static_cast<int64_t>((zigzag >> 1) ^ (~(zigzag & 1) + 1)));
+    }
+    ICHECK(tag == BinaryGraphWriter::kStrAttr) << "LoadBinary: invalid attribute tag";
+    return ReadString();
+  }
+
+  const char* ptr_;
+  const char* end_;
+  std::vector<std::string> strings_;
+};
+
+std::string SaveBinary(const ObjectRef& n) {
+  return BinaryGraphWriter().Write(JSONGraph::Create(n, /*b64_ndarrays=*/false));
+}
+
+ObjectRef LoadBinary(const std::string& bytes) {
+  JSONGraph jgraph = BinaryGraphReader(bytes).Read();
+  std::vector<runtime::NDArray> tensors;
+  for (std::string& blob : jgraph.raw_ndarrays) {
+    dmlc::MemoryStringStream mstrm(&blob);
+    runtime::NDArray temp;
+    ICHECK(temp.Load(&mstrm));
+    tensors.emplace_back(std::move(temp));
+  }
+  return CreateFromGraph(&jgraph, tensors);
+}
+
 TVM_REGISTER_GLOBAL("node.SaveJSON").set_body_typed(SaveJSON);
 
 TVM_REGISTER_GLOBAL("node.LoadJSON").set_body_typed(LoadJSON);
+
+TVM_REGISTER_GLOBAL("node.SaveBinary").set_body([](TVMArgs args, TVMRetValue* rv) {
+  std::string bytes = SaveBinary(args[0]);
+  TVMByteArray arr;
+  arr.data = bytes.c_str();
+  arr.size = bytes.length();
+  *rv = arr;
+});
+
+TVM_REGISTER_GLOBAL("node.LoadBinary").set_body_typed([](std::string bytes) {
+  return LoadBinary(bytes);
+});
 }  // namespace tvm
@@ -23,6 +23,7 @@
 #include <tvm/node/node.h>
 #include <tvm/node/reflection.h>
 #include <tvm/node/structural_equal.h>
+#include <tvm/node/structural_hash.h>
 #include <tvm/runtime/registry.h>
 
 #include <unordered_map>
@@ -231,4 +232,15 @@ bool StructuralEqual::operator()(const ObjectRef& lhs, const ObjectRef& rhs) con
   return RemapVarSEqualHandler(false).Equal(lhs, rhs, false);
 }
 
+// <efficient>
+bool MemoizedStructuralEqual::operator()(const ObjectRef& lhs, const ObjectRef& rhs) const {
+  if (lhs.same_as(rhs)) return true;
+  // Structurally equal objects always have equal structural hash values.
+  if (lhs.defined() && rhs.defined() &&
+      MemoizedStructuralHash()(lhs) != MemoizedStructuralHash()(rhs)) {
+    return false;
+  }
+  return RemapVarSEqualHandler(false).Equal(lhs, rhs, false);
+}
+
 }  // namespace tvm
@@ -19,6 +19,7 @@
 /*!
  * \file src/node/structural_hash.cc
  */
+#include <tvm/ir/function.h>
 #include <tvm/node/functor.h>
 #include <tvm/node/node.h>
 #include <tvm/node/reflection.h>
@@ -263,6 +264,20 @@ size_t StructuralHash::operator()(const ObjectRef& object) const {
   return VarCountingSHashHandler().Hash(object, false);
 }
 
+// <efficient>
+size_t MemoizedStructuralHash::operator()(const ObjectRef& object) const {
+  const auto* func = object.as<BaseFuncNode>();
+  if (func == nullptr) {
+    return StructuralHash()(object);
+  }
+  size_t hashed_value;
+  if (!func->shash_cache_.Get(&hashed_value)) {
+    hashed_value = StructuralHash()(object);
+    func->shash_cache_.Set(hashed_value);
+  }
+  return hashed_value;
+}
+
 // SEQualReduce traits for runtime containers.
 struct StringObjTrait {
   static constexpr const std::nullptr_t VisitAttrs = nullptr;
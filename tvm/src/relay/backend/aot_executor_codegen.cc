@@ -158,11 +158,11 @@ class AOTOnDemandAllocator : public ExprVisitor {
   size_t GetMemorySizeBytes(const TensorTypeNode* ttype) {
     ICHECK(ttype != nullptr);
     size_t size = 1;
-    for (IndexExpr dim : ttype->shape) {
-      const int64_t* pval = tir::as_const_int(dim);
-      ICHECK(pval != nullptr) << "Cannot allocate memory symbolic tensor shape " << ttype->shape;
-      ICHECK_GE(*pval, 0) << "Cannot allocate memory for tensor with negative shape" << *pval;
-      size *= static_cast<size_t>(pval[0]);
+    // <bojian/DietCode> the symbolic dimensions are planned at their upper bounds, as in the
+    //                   graph memory planner
+    for (int64_t dim : GetShapeUpperBound(ttype->shape)) {
+      ICHECK_GE(dim, 0) << "Cannot allocate memory for tensor with negative shape" << dim;
+      size *= static_cast<size_t>(dim);
     }
     size *= DivRoundUp(ttype->dtype.bits() * ttype->dtype.lanes(), 8);
     return size;
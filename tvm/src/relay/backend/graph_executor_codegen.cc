@@ -282,12 +282,9 @@ class GraphExecutorCodegen : public backend::MemoizedExprTranslator<std::vector<
    * \return std::vector<int64_t>
    */
   std::vector<int64_t> _ShapeToJSON(tvm::Array<IndexExpr> shape) {
-    std::vector<int64_t> ret;
-    for (IndexExpr dim : shape) {
-      const int64_t* pval = tir::as_const_int(dim);
-      ret.push_back(*pval);
-    }
-    return ret;
+    // <bojian/DietCode> the symbolic dimensions are emitted at their upper bounds, which the
+    //                   memory planner has allocated the storage for
+    return backend::GetShapeUpperBound(shape);
   }
 
   /*!
@@ -307,6 +304,9 @@ class GraphExecutorCodegen : public backend::MemoizedExprTranslator<std::vector<
       storage_ids.push_back(v);
     }
     node->attrs_["storage_id"] = std::move(storage_ids);
+    if (!storage_info->storage_offsets_in_bytes.empty()) {
+      node->attrs_["storage_offset"] = storage_info->storage_offsets_in_bytes;
+    }
     // type
     std::vector<int64_t> device_types;
     for (auto v : storage_info->device_types) {
@@ -391,6 +391,10 @@ class GraphExecutorCodegen : public backend::MemoizedExprTranslator<std::vector<
     StorageInfo rit = GetStorageInfo(rhs);
     int64_t lhs_storage_id = lit->storage_ids[0];
     int64_t rhs_storage_id = rit->storage_ids[0];
+    if (!lit->storage_offsets_in_bytes.empty() && !rit->storage_offsets_in_bytes.empty() &&
+        lit->storage_offsets_in_bytes[0] != rit->storage_offsets_in_bytes[0]) {
+      return false;
+    }
     return lhs_storage_id == rhs_storage_id;
   }
 
@@ -513,6 +517,7 @@ class GraphExecutorCodegen : public backend::MemoizedExprTranslator<std::vector<
     size_t num_entry = 0;
     ShapeVector shapes;
     std::vector<size_t> storage_ids;
+    std::vector<size_t> storage_offsets;
     std::vector<size_t> device_types;
     std::vector<std::string> dltypes;
     std::vector<size_t> node_row_ptr{0};
@@ -527,6 +532,10 @@ class GraphExecutorCodegen : public backend::MemoizedExprTranslator<std::vector<
       shapes.insert(shapes.end(), shape_vec.begin(), shape_vec.end());
       dltypes.insert(dltypes.end(), dtype_vec.begin(), dtype_vec.end());
       storage_ids.insert(storage_ids.end(), storage_id.begin(), storage_id.end());
+      if (node->attrs_.count("storage_offset")) {
+        const auto& offsets = dmlc::get<std::vector<int64_t>>(node->attrs_["storage_offset"]);
+        storage_offsets.insert(storage_offsets.end(), offsets.begin(), offsets.end());
+      }
       if (node->attrs_.count("device_index")) {
         const auto& dev_types = dmlc::get<std::vector<int64_t>>(node->attrs_["device_index"]);
         device_types.insert(device_types.end(), dev_types.begin(), dev_types.end());
@@ -542,6 +551,12 @@ class GraphExecutorCodegen : public backend::MemoizedExprTranslator<std::vector<
     attrs["shape"].emplace_back(shapes);
     attrs["storage_id"].emplace_back(std::string("list_int"));
     attrs["storage_id"].emplace_back(storage_ids);
+    if (storage_offsets.size()) {
+      ICHECK_EQ(storage_offsets.size(), storage_ids.size())
+          << "Either all or none of the node entries are expected to have storage offsets";
+      attrs["storage_offset"].emplace_back(std::string("list_int"));
+      attrs["storage_offset"].emplace_back(storage_offsets);
+    }
     if (device_types.size()) {
       attrs["device_index"].emplace_back(std::string("list_int"));
       attrs["device_index"].emplace_back(device_types);
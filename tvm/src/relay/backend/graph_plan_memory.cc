@@ -27,8 +27,12 @@
 #include <tvm/relay/expr.h>
 #include <tvm/relay/expr_functor.h>
 #include <tvm/relay/transform.h>
+#include <tvm/runtime/device_api.h>
 #include <tvm/tir/op.h>
 
+#include <algorithm>
+#include <limits>
+
 #include "../../support/arena.h"
 #include "./utils.h"
 
@@ -51,6 +55,13 @@ struct StorageToken {
   int device_type{0};
   /*! \brief The storage id */
   int64_t storage_id{-1};
+  /*! \brief The steps at which the token is allocated and released (interval packing only). */
+  size_t alloc_step{0};
+  size_t release_step{std::numeric_limits<size_t>::max()};
+  /*! \brief Whether the token is packed into the arena of its device (interval packing only). */
+  bool in_arena{false};
+  /*! \brief The byte offset within the arena (interval packing only). */
+  int64_t offset{0};
 };
 
 std::ostream& operator<<(std::ostream& os, StorageToken tok) {
@@ -216,8 +227,18 @@ class StorageAllocator : public StorageAllocaBaseVisitor {
 
   // Run storage allocation for a function.
   StaticMemoryPlan Plan(const Function& func) {
+    String planner = transform::PassContext::Current()
+                         ->GetConfig<String>(kPlanner, String(kGreedyPlanner))
+                         .value();
+    ICHECK(planner == kGreedyPlanner || planner == kIntervalPackingPlanner)
+        << "Unknown memory planner " << planner << ", expected " << kGreedyPlanner << " or "
+        << kIntervalPackingPlanner;
+    interval_packing_ = planner == kIntervalPackingPlanner;
     prototype_ = StorageAllocaInit(&arena_).GetInitTokenMap(func);
     this->Run(func);
+    if (interval_packing_) {
+      PackIntervals();
+    }
 
     // The value of smap contains two integer arrays where the first array
     // contains the planned storage ids and the second holds the device types.
@@ -229,6 +250,7 @@ class StorageAllocator : public StorageAllocaBaseVisitor {
       std::vector<int64_t> storage_ids;
       std::vector<DLDeviceType> device_types;
       std::vector<int64_t> sid_sizes_byte;
+      std::vector<int64_t> sid_offsets_byte;
 
       for (StorageToken* tok : kv.second) {
         if (tok->device_type) {
@@ -238,8 +260,12 @@ class StorageAllocator : public StorageAllocaBaseVisitor {
         storage_ids.push_back(tok->storage_id);
         device_types.push_back(static_cast<DLDeviceType>(tok->device_type));
         sid_sizes_byte.push_back(GetMemorySize(tok));
+        if (interval_packing_) {
+          sid_offsets_byte.push_back(tok->offset);
+        }
       }
-      auto storage_info = backend::StorageInfo(storage_ids, device_types, sid_sizes_byte);
+      auto storage_info =
+          backend::StorageInfo(storage_ids, device_types, sid_sizes_byte, sid_offsets_byte);
       smap.Set(GetRef<Expr>(kv.first), storage_info);
     }
     // Either all or none of the nodes should be annotated.
@@ -270,6 +296,7 @@ class StorageAllocator : public StorageAllocaBaseVisitor {
         allocated_tok->device_type = tok->device_type;
         // ensure it never get de-allocated.
         allocated_tok->ref_counter += 1;
+        allocated_tok->in_arena = false;
         tokens.push_back(allocated_tok);
       }
     }
@@ -309,6 +336,7 @@ class StorageAllocator : public StorageAllocaBaseVisitor {
     //
     // TODO(tvm-team) Update checks of flat memory enablement when we support
     // opaque-nd memory planning to skip this path.
+    ++num_steps_;
     if (IsReshape(op)) {
       // TODO(@electriclilies, jroesch): This check is failing because the size of args is 3
       // I can't figure out where the extra args are coming from, I assume it must be related
@@ -367,11 +395,10 @@ class StorageAllocator : public StorageAllocaBaseVisitor {
     const TensorTypeNode* ttype = prototype->ttype;
     ICHECK(ttype != nullptr);
     size_t size = 1;
-    for (IndexExpr dim : ttype->shape) {
-      const int64_t* pval = tir::as_const_int(dim);
-      ICHECK(pval != nullptr) << "Cannot allocate memory symbolic tensor shape " << ttype->shape;
-      ICHECK_GE(*pval, 0) << "Cannot allocate memory for tensor with negative shape" << *pval;
-      size *= static_cast<size_t>(pval[0]);
+    // <bojian/DietCode> the symbolic dimensions are planned at their upper bounds
+    for (int64_t dim : backend::GetShapeUpperBound(ttype->shape)) {
+      ICHECK_GE(dim, 0) << "Cannot allocate memory for tensor with negative shape" << dim;
+      size *= static_cast<size_t>(dim);
     }
     size *= DivRoundUp(ttype->dtype.bits() * ttype->dtype.lanes(), 8);
     return size;
@@ -384,6 +411,13 @@ class StorageAllocator : public StorageAllocaBaseVisitor {
   StorageToken* Request(StorageToken* prototype) {
     // calculate the size;
     size_t size = GetMemorySize(prototype);
+    // the interval packing assigns the offsets once all the lifetimes are known
+    if (interval_packing_) {
+      StorageToken* tok = this->Alloc(prototype, size);
+      tok->alloc_step = num_steps_;
+      tok->in_arena = true;
+      return tok;
+    }
     // search memory block in [size / match_range_, size * match_range_)
     if (match_range_ == 0) {
       return this->Alloc(prototype, size);
@@ -438,7 +472,100 @@ class StorageAllocator : public StorageAllocaBaseVisitor {
     ICHECK_GE(tok->storage_id, 0);
     ICHECK_GE(tok->ref_counter, 0);
     if (tok->ref_counter == 0) {
-      free_.insert({tok->max_bytes, tok});
+      if (interval_packing_) {
+        tok->release_step = num_steps_;
+      } else {
+        free_.insert({tok->max_bytes, tok});
+      }
+    }
+  }
+  /*!
+   * \brief Pack the tokens into one arena per device by their lifetime intervals, using best-fit
+   *        by decreasing size: each token takes the smallest gap between the tokens that it
+   *        overlaps in lifetime and that have been placed, or goes past all of them. The tokens
+   *        that are never released (e.g., the parameters) keep their own storage.
+   */
+  void PackIntervals() {
+    std::unordered_map<int, std::vector<StorageToken*>> device_tokens;
+    for (StorageToken* tok : data_) {
+      if (tok->in_arena) {
+        device_tokens[tok->device_type].push_back(tok);
+      }
+    }
+    auto aligned_bytes = [](const StorageToken* tok) -> int64_t {
+      return static_cast<int64_t>(DivRoundUp(tok->max_bytes, runtime::kAllocAlignment) *
+                                  runtime::kAllocAlignment);
+    };
+    auto overlap = [](const StorageToken* lhs, const StorageToken* rhs) {
+      return lhs->alloc_step <= rhs->release_step && rhs->alloc_step <= lhs->release_step;
+    };
+    // the arenas come after the storage ids of the tokens that are not packed
+    std::vector<StorageToken*> unpacked;
+    for (StorageToken* tok : data_) {
+      if (!tok->in_arena) {
+        tok->storage_id = static_cast<int64_t>(unpacked.size());
+        unpacked.push_back(tok);
+      }
+    }
+    data_ = std::move(unpacked);
+    int64_t num_arena_sid = static_cast<int64_t>(data_.size());
+
+    for (auto& kv : device_tokens) {
+      std::vector<StorageToken*>& tokens = kv.second;
+      std::stable_sort(tokens.begin(), tokens.end(),
+                       [](const StorageToken* lhs, const StorageToken* rhs) {
+                         return lhs->max_bytes > rhs->max_bytes;
+                       });
+      std::vector<StorageToken*> placed;
+      int64_t arena_bytes = 0;
+      for (StorageToken* tok : tokens) {
+        std::vector<StorageToken*> conflicts;
+        for (StorageToken* other : placed) {
+          if (overlap(tok, other)) {
+            conflicts.push_back(other);
+          }
+        }
+        std::sort(conflicts.begin(), conflicts.end(),
+                  [](const StorageToken* lhs, const StorageToken* rhs) {
+                    return lhs->offset < rhs->offset;
+                  });
+        const int64_t bytes = aligned_bytes(tok);
+        int64_t prev_end = 0, best_offset = -1,
+                best_gap = std::numeric_limits<int64_t>::max();
+        for (const StorageToken* other : conflicts) {
+          const int64_t gap = other->offset - prev_end;
+          if (gap >= bytes && gap < best_gap) {
+            best_offset = prev_end;
+            best_gap = gap;
+          }
+          prev_end = std::max(prev_end, other->offset + aligned_bytes(other));
+        }
+        tok->offset = best_offset >= 0 ? best_offset : prev_end;
+        arena_bytes = std::max(arena_bytes, tok->offset + bytes);
+        placed.push_back(tok);
+      }
+      // the liveness lower bound is the peak of the total size of the live tokens
+      std::vector<std::pair<size_t, int64_t>> events;
+      for (const StorageToken* tok : tokens) {
+        events.emplace_back(tok->alloc_step, aligned_bytes(tok));
+        if (tok->release_step != std::numeric_limits<size_t>::max()) {
+          events.emplace_back(tok->release_step + 1, -aligned_bytes(tok));
+        }
+      }
+      std::sort(events.begin(), events.end());
+      int64_t live_bytes = 0, lower_bound = 0;
+      for (const std::pair<size_t, int64_t>& event : events) {
+        live_bytes += event.second;
+        lower_bound = std::max(lower_bound, live_bytes);
+      }
+      // one storage per arena, which the executor sizes by the largest offset + bytes
+      for (StorageToken* tok : tokens) {
+        tok->storage_id = num_arena_sid;
+      }
+      ++num_arena_sid;
+      LOG(INFO) << "Interval packing planned " << tokens.size() << " tensors on device type "
+                << kv.first << " into an arena of " << arena_bytes << " bytes, the liveness "
+                << "lower bound is " << lower_bound << " bytes";
     }
   }
 
@@ -453,10 +580,25 @@ class StorageAllocator : public StorageAllocaBaseVisitor {
   std::vector<StorageToken*> data_;
   /*! \brief internal prototype token map */
   std::unordered_map<const ExprNode*, std::vector<StorageToken*> > prototype_;
+  /*! \brief whether to plan w/ the interval packing rather than the greedy token reuse */
+  bool interval_packing_{false};
+  /*! \brief the number of calls that have been planned, which time the token lifetimes */
+  size_t num_steps_{0};
+
+ public:
+  /*!
+   * \brief The pass config option that selects the memory planner, either "greedy" (reusing
+   *        whole storage tokens) or "interval_packing" (assigning offsets within an arena).
+   */
+  static constexpr const char* kPlanner = "relay.GraphPlanMemory.planner";
+  static constexpr const char* kGreedyPlanner = "greedy";
+  static constexpr const char* kIntervalPackingPlanner = "interval_packing";
 };
 
 StaticMemoryPlan GraphPlanMemory(const Function& func) { return StorageAllocator().Plan(func); }
 
+TVM_REGISTER_PASS_CONFIG_OPTION("relay.GraphPlanMemory.planner", String);
+
 TVM_REGISTER_GLOBAL("relay.backend.GraphPlanMemory").set_body_typed(GraphPlanMemory);
 
 }  // namespace relay
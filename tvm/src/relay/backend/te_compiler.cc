@@ -677,8 +677,14 @@ backend::FunctionInfo UpdateMainWorkspaceSize(const IRModule& mod, TargetMap tar
       // Here we record the largest size of the tensor
       // that share the same storage id, because storage_id will
       // be shared between multiple tensors that are not live simultaneously.
-      if (size_bytes > sid_workspace[devices[i]][storage_ids[i]]) {
-        sid_workspace[devices[i]][storage_ids[i]] = size_bytes;
+      // With the interval packing, a storage is an arena that ends at the largest offset + size.
+      int64_t sid_size_bytes =
+          storage_info->storage_offsets_in_bytes.empty()
+              ? size_bytes
+              : storage_info->storage_offsets_in_bytes[i] +
+                    storage_info->storage_sizes_in_bytes[i];
+      if (sid_size_bytes > sid_workspace[devices[i]][storage_ids[i]]) {
+        sid_workspace[devices[i]][storage_ids[i]] = sid_size_bytes;
       }
     }
   }
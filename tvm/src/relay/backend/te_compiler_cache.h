@@ -238,7 +238,7 @@ std::string GetUniqueName(std::string name, std::unordered_map<std::string, int>
 inline size_t CCacheKeyNode::Hash() const {
   if (hash_ != 0) return hash_;
   // do structral hash, avoid 0.
-  hash_ = tvm::StructuralHash()(this->source_func);
+  hash_ = tvm::MemoizedStructuralHash()(this->source_func);
   hash_ = dmlc::HashCombine(hash_, std::hash<std::string>()(target->str()));
   if (hash_ == 0) hash_ = 1;
   return hash_;
@@ -24,7 +24,9 @@
 
 #include "utils.h"
 
+#include <tvm/arith/analyzer.h>
 #include <tvm/relay/qnn/transform.h>
+#include <tvm/tir/stmt_functor.h>
 
 namespace tvm {
 namespace relay {
@@ -33,11 +35,13 @@ namespace backend {
 TVM_REGISTER_NODE_TYPE(StorageInfoNode);
 
 StorageInfo::StorageInfo(std::vector<int64_t> storage_ids, std::vector<DLDeviceType> device_types,
-                         std::vector<int64_t> storage_sizes_in_bytes) {
+                         std::vector<int64_t> storage_sizes_in_bytes,
+                         std::vector<int64_t> storage_offsets_in_bytes) {
   auto n = make_object<StorageInfoNode>();
   n->storage_ids = std::move(storage_ids);
   n->device_types = std::move(device_types);
   n->storage_sizes_in_bytes = std::move(storage_sizes_in_bytes);
+  n->storage_offsets_in_bytes = std::move(storage_offsets_in_bytes);
   data_ = std::move(n);
 }
 
@@ -65,6 +69,14 @@ TVM_REGISTER_GLOBAL("relay.ir.StorageInfoStorageSizes").set_body_typed([](Storag
   return storage_sizes_in_bytes;
 });
 
+TVM_REGISTER_GLOBAL("relay.ir.StorageInfoStorageOffsets").set_body_typed([](StorageInfo si) {
+  Array<tvm::Integer> storage_offsets_in_bytes;
+  for (auto offset : si->storage_offsets_in_bytes) {
+    storage_offsets_in_bytes.push_back(offset);
+  }
+  return storage_offsets_in_bytes;
+});
+
 TVM_REGISTER_NODE_TYPE(StaticMemoryPlanNode);
 
 StaticMemoryPlan::StaticMemoryPlan(Map<Expr, StorageInfo> expr_to_storage_info) {
@@ -73,6 +85,46 @@ StaticMemoryPlan::StaticMemoryPlan(Map<Expr, StorageInfo> expr_to_storage_info)
   data_ = std::move(n);
 }
 
+TVM_REGISTER_NODE_TYPE(DynShapeConfigNode);
+TVM_REGISTER_PASS_CONFIG_OPTION("relay.backend.DynShape", DynShapeConfig);
+
+std::vector<int64_t> GetShapeUpperBound(const Array<IndexExpr>& shape) {
+  Map<String, Integer> shape_var_upper_bounds =
+      transform::PassContext::Current()
+          ->GetConfig<DynShapeConfig>("relay.backend.DynShape",
+                                      AttrsWithDefaultValues<DynShapeConfig>())
+          .value()
+          ->shape_var_upper_bounds;
+  std::vector<int64_t> ret;
+  for (const IndexExpr& dim : shape) {
+    if (const int64_t* pval = tir::as_const_int(dim)) {
+      ret.push_back(*pval);
+      continue;
+    }
+    // bind every shape variable to [0, upper bound] and take the bound of the whole dimension,
+    // which holds regardless of whether the dimension is monotonic in the variables
+    arith::Analyzer analyzer;
+    tir::PostOrderVisit(dim, [&](const ObjectRef& node) {
+      if (const tir::VarNode* var = node.as<tir::VarNode>()) {
+        auto it = shape_var_upper_bounds.find(var->name_hint);
+        ICHECK(it != shape_var_upper_bounds.end())
+            << "Cannot allocate memory symbolic tensor shape " << shape << ", the upper bound of "
+            << var->name_hint << " is not given by relay.backend.DynShape";
+        analyzer.Bind(GetRef<tir::Var>(var),
+                      Range::FromMinExtent(tir::make_const(var->dtype, 0),
+                                           tir::make_const(var->dtype, (*it).second->value + 1)),
+                      /*allow_override=*/true);
+      }
+    });
+    int64_t max_value = analyzer.const_int_bound(dim)->max_value;
+    ICHECK(max_value != arith::ConstIntBound::kPosInf)
+        << "Cannot allocate memory symbolic tensor shape " << shape << ", " << dim
+        << " is not bounded by the upper bounds of the shape variables";
+    ret.push_back(max_value);
+  }
+  return ret;
+}
+
 int64_t CalculateRelayExprSizeBytes(const Type& expr_type) {
   if (expr_type->IsInstance<TupleTypeNode>()) {
     auto tuple_type = Downcast<TupleType>(expr_type);
@@ -62,6 +62,11 @@ class StorageInfoNode : public Object {
   std::vector<DLDeviceType> device_types;
   /* \brief The sizes of each storage element. */
   std::vector<int64_t> storage_sizes_in_bytes;
+  /*
+   * \brief The byte offsets of each storage element within its storage (empty if every storage
+   *        element owns its storage), which are planned by the interval packing.
+   */
+  std::vector<int64_t> storage_offsets_in_bytes;
 
   // TODO(@jroesch): expose the fields
   void VisitAttrs(AttrVisitor* v) {}
@@ -74,7 +79,8 @@ class StorageInfoNode : public Object {
 class StorageInfo : public ObjectRef {
  public:
   StorageInfo(std::vector<int64_t> storage_ids, std::vector<DLDeviceType> device_types,
-              std::vector<int64_t> storage_sizes_in_bytes);
+              std::vector<int64_t> storage_sizes_in_bytes,
+              std::vector<int64_t> storage_offsets_in_bytes = {});
   TVM_DEFINE_OBJECT_REF_METHODS(StorageInfo, ObjectRef, StorageInfoNode);
 };
 
@@ -126,6 +132,35 @@ class FunctionInfo : public ObjectRef {
   TVM_DEFINE_MUTABLE_OBJECT_REF_METHODS(FunctionInfo, ObjectRef, FunctionInfoNode);
 };
 
+/*!
+ * \brief <bojian/DietCode> The config of the tensors w/ dynamic shapes, under which the executor
+ *        codegens statically plan those tensors at the upper bounds of their shapes.
+ */
+struct DynShapeConfigNode : public tvm::AttrsNode<DynShapeConfigNode> {
+  Map<String, Integer> shape_var_upper_bounds;
+
+  TVM_DECLARE_ATTRS(DynShapeConfigNode, "relay.backend.DynShapeConfig") {
+    TVM_ATTR_FIELD(shape_var_upper_bounds)
+        .describe("The upper bounds of the dynamic shape variables, indexed by their names.")
+        .set_default(Map<String, Integer>());
+  }
+};
+
+class DynShapeConfig : public Attrs {
+ public:
+  TVM_DEFINE_NOTNULLABLE_OBJECT_REF_METHODS(DynShapeConfig, Attrs, DynShapeConfigNode);
+};
+
+/*!
+ * \brief Get the upper bound of every dimension of a tensor shape, where the dynamic shape
+ *        variables range over [0, upper bound] as given by the "relay.backend.DynShape" pass
+ *        config option.
+ *
+ * \param shape The tensor shape.
+ * \return The upper bounds of the dimensions.
+ */
+std::vector<int64_t> GetShapeUpperBound(const Array<IndexExpr>& shape);
+
 /*!
  * \brief Calculate the storage required to store the type of relay.Expr
  *
@@ -493,6 +493,8 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
 
     // Extract functions attrs
     op_attrs[op_index] = func->attrs->dict;
+    // Mark the shape function, so that the VM can memoize its outputs.
+    op_attrs[op_index].Set(Executable::kShapeFuncAttr, String("1"));
 
     Emit(Instruction::InvokePacked(op_index, argument_registers.size(), outputs.size(),
                                    argument_registers));
@@ -84,6 +84,12 @@ constexpr uint32_t kMaxFusedOps = 256;
 static const Op& stop_fusion_op = Op::Get("annotation.stop_fusion");
 
 TVM_REGISTER_PASS_CONFIG_OPTION("relay.FuseOps.max_depth", Integer);
+/*!
+ * \brief The name of the global function that decides whether to fuse an OutEWiseFusable op with
+ *  its elementwise tail, in place of the fixed rules. The function takes the fused candidate, the
+ *  anchor op alone and the tail alone (as primitive functions), and returns whether to fuse them.
+ */
+TVM_REGISTER_PASS_CONFIG_OPTION("relay.FuseOps.fusion_policy", String);
 
 /*!
  * \brief Indexed data flow graph in forward direction.
@@ -502,13 +508,52 @@ DominatorTree DominatorTree::PostDom(support::Arena* arena, const IndexedForward
   return tree;
 }
 
+/*!
+ * \brief Extract a set of nodes of the graph into a primitive function, whose parameters are the
+ *  values that flow into the set from the outside.
+ */
+class FusionCandidateExtractor : private ExprMutator {
+ public:
+  explicit FusionCandidateExtractor(const std::unordered_set<const tvm::Object*>& members)
+      : members_(members) {}
+
+  Function Extract(const Expr& output) {
+    Expr body = this->Mutate(output);
+    Function func(params_, body, output->checked_type_, {});
+    return WithAttr(std::move(func), attr::kPrimitive, tvm::Integer(1));
+  }
+
+ private:
+  Expr VisitExpr(const Expr& expr) final {
+    if (members_.count(expr.get()) || expr.as<ConstantNode>() || expr.as<OpNode>()) {
+      return ExprMutator::VisitExpr(expr);
+    }
+    auto it = inputs_.find(expr.get());
+    if (it != inputs_.end()) {
+      return it->second;
+    }
+    Var param("p" + std::to_string(params_.size()), expr->checked_type_);
+    params_.push_back(param);
+    inputs_.emplace(expr.get(), param);
+    return std::move(param);
+  }
+
+  const std::unordered_set<const tvm::Object*>& members_;
+  std::unordered_map<const tvm::Object*, Var> inputs_;
+  Array<Var> params_;
+};
+
 /*!
  * \brief A partition of the graph marked by union find data structure.
  */
 class GraphPartitioner {
  public:
-  explicit GraphPartitioner(support::Arena* arena, int opt_level, size_t max_fuse_depth)
-      : arena_(arena), opt_level_(opt_level), max_fuse_depth_(max_fuse_depth) {}
+  explicit GraphPartitioner(support::Arena* arena, int opt_level, size_t max_fuse_depth,
+                            runtime::PackedFunc fusion_policy = nullptr)
+      : arena_(arena),
+        opt_level_(opt_level),
+        max_fuse_depth_(max_fuse_depth),
+        fusion_policy_(fusion_policy) {}
   /*!
    * \brief Group as a union find data structure.
    */
@@ -562,6 +607,8 @@ class GraphPartitioner {
   int opt_level_;
   /*! \brief The maximum number of operations in one fused function */
   size_t max_fuse_depth_;
+  /*! \brief The policy that decides the fusion of the OutEWiseFusable ops, if any. */
+  runtime::PackedFunc fusion_policy_;
   /*! \brief The internal groups. */
   std::vector<Group*> groups_;
   /*! \brief internal field used for deduplication */
@@ -656,6 +703,39 @@ class GraphPartitioner {
     CommitFuse_(src, sink, target);
   }
 
+  // Collect the nodes on the paths from src (exclusive) to sink (inclusive).
+  void CollectPath_(IndexedForwardGraph::Node* src, IndexedForwardGraph::Node* sink,
+                    std::unordered_set<const tvm::Object*>* path) {
+    for (auto link = src->outputs.head; link != nullptr; link = link->next) {
+      IndexedForwardGraph::Node* node = link->value.node;
+      if (visited_.count(node)) continue;
+      visited_.insert(node);
+      path->insert(node->ref);
+      if (node != sink) {
+        CollectPath_(node, sink, path);
+      }
+    }
+  }
+
+  /*!
+   * \brief Ask the fusion policy whether to fuse src with the nodes up to its post-dominator sink,
+   *  by comparing the fused candidate against the unfused src and tail.
+   */
+  bool AcceptFusion(IndexedForwardGraph::Node* src, IndexedForwardGraph::Node* sink) {
+    if (fusion_policy_ == nullptr) return true;
+    std::unordered_set<const tvm::Object*> tail;
+    visited_.clear();
+    CollectPath_(src, sink, &tail);
+    std::unordered_set<const tvm::Object*> anchor{src->ref};
+    std::unordered_set<const tvm::Object*> fused(tail);
+    fused.insert(src->ref);
+    Expr src_expr = GetRef<Expr>(static_cast<const ExprNode*>(src->ref));
+    Expr sink_expr = GetRef<Expr>(static_cast<const ExprNode*>(sink->ref));
+    return fusion_policy_(FusionCandidateExtractor(fused).Extract(sink_expr),
+                          FusionCandidateExtractor(anchor).Extract(src_expr),
+                          FusionCandidateExtractor(tail).Extract(sink_expr));
+  }
+
   size_t CountNodesUptoSink_(IndexedForwardGraph::Node* src, IndexedForwardGraph::Node* sink) {
     if (src == sink || visited_.count(src)) return 0;
     visited_.insert(src);
@@ -752,7 +832,8 @@ class GraphPartitioner {
           ICHECK(dom_node->parent->gnode != nullptr);
           // The fuse can be executed if all the intermediate ops are still broadcast.
           auto fcond = [](OpPatternKind kind, bool is_sink) { return kind <= kBroadcast; };
-          if (CheckPath(graph_node, dom_node->parent->gnode, fcond)) {
+          if (CheckPath(graph_node, dom_node->parent->gnode, fcond) &&
+              AcceptFusion(graph_node, dom_node->parent->gnode)) {
             CommitFuse(graph_node, dom_node->parent->gnode);
           }
         }
@@ -809,10 +890,12 @@ std::vector<GraphPartitioner::Group*> GraphPartitioner::Partition(
 class FuseMutator : private MixedModeMutator {
  public:
   // Run the transform
-  Expr Transform(const Expr& body, int fuse_opt_level, size_t max_fuse_depth) {
+  Expr Transform(const Expr& body, int fuse_opt_level, size_t max_fuse_depth,
+                 runtime::PackedFunc fusion_policy = nullptr) {
     // setup the group map.
     auto graph = IndexedForwardGraph::Create(&arena_, body);
-    auto groups = GraphPartitioner(&arena_, fuse_opt_level, max_fuse_depth).Partition(graph);
+    auto groups = GraphPartitioner(&arena_, fuse_opt_level, max_fuse_depth, fusion_policy)
+                      .Partition(graph);
     for (size_t nid = 0; nid < graph.post_dfs_order.size(); ++nid) {
       ICHECK(graph.post_dfs_order[nid]->ref != nullptr);
       gmap_[graph.post_dfs_order[nid]->ref] = groups[nid];
@@ -1026,7 +1109,15 @@ Pass FuseOps(int fuse_opt_level) {
       [=](Function f, IRModule m, PassContext pc) {
         int opt_level = fuse_opt_level == -1 ? pc->opt_level : fuse_opt_level;
         auto max_fuse_depth = pc->GetConfig("relay.FuseOps.max_depth", Integer(kMaxFusedOps));
-        return Downcast<Function>(FuseOps(f, opt_level, max_fuse_depth.value(), m));
+        String policy_name =
+            pc->GetConfig<String>("relay.FuseOps.fusion_policy", String("")).value();
+        if (policy_name.empty()) {
+          return Downcast<Function>(FuseOps(f, opt_level, max_fuse_depth.value(), m));
+        }
+        const runtime::PackedFunc* fusion_policy = runtime::Registry::Get(policy_name);
+        ICHECK(fusion_policy != nullptr) << "Cannot find the fusion policy " << policy_name;
+        return Downcast<Function>(
+            FuseMutator().Transform(f, opt_level, max_fuse_depth.value(), *fusion_policy));
       };
   return CreateFunctionPass(pass_func, 1, "FuseOps", {"InferType"});
 }
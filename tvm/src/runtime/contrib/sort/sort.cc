@@ -23,9 +23,13 @@
 
 #include <builtin_fp16.h>
 #include <dlpack/dlpack.h>
+#include <tvm/runtime/c_backend_api.h>
 #include <tvm/runtime/registry.h>
 
 #include <algorithm>
+#include <cstring>
+#include <functional>
+#include <utility>
 #include <vector>
 
 namespace tvm {
@@ -33,16 +37,6 @@ namespace contrib {
 
 using namespace runtime;
 
-template <typename DType>
-bool CompareAscend(const std::pair<int64_t, DType>& lhs, const std::pair<int64_t, DType>& rhs) {
-  return lhs.second < rhs.second;
-}
-
-template <typename DType>
-bool CompareDescend(const std::pair<int64_t, DType>& lhs, const std::pair<int64_t, DType>& rhs) {
-  return lhs.second > rhs.second;
-}
-
 struct float16 {
   uint16_t bits;
   float to_float() const {
@@ -50,15 +44,190 @@ struct float16 {
   }
 };
 
+/*!
+ * \brief The order-preserving unsigned encoding of the sort keys, which is computed once per
+ *  element (e.g., the float16 keys are converted to float only once), so that the rows are sorted
+ *  by plain integer comparisons or by radix sort. The negative zeros are encoded as positive ones
+ *  so that they compare equal.
+ */
+template <typename DataType>
+struct SortKey;
+
+template <>
+struct SortKey<float> {
+  using Type = uint32_t;
+  static Type Encode(float value) {
+    uint32_t bits;
+    value = value == 0.0f ? 0.0f : value;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+  }
+};
+
 template <>
-bool CompareAscend(const std::pair<int64_t, float16>& lhs, const std::pair<int64_t, float16>& rhs) {
-  return lhs.second.to_float() < rhs.second.to_float();
-}
+struct SortKey<double> {
+  using Type = uint64_t;
+  static Type Encode(double value) {
+    uint64_t bits;
+    value = value == 0.0 ? 0.0 : value;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return (bits & 0x8000000000000000ull) ? ~bits : (bits | 0x8000000000000000ull);
+  }
+};
+
+template <>
+struct SortKey<int32_t> {
+  using Type = uint32_t;
+  static Type Encode(int32_t value) { return static_cast<uint32_t>(value) ^ 0x80000000u; }
+};
+
+template <>
+struct SortKey<int64_t> {
+  using Type = uint64_t;
+  static Type Encode(int64_t value) {
+    return static_cast<uint64_t>(value) ^ 0x8000000000000000ull;
+  }
+};
+
+template <>
+struct SortKey<float16> {
+  using Type = uint32_t;
+  static Type Encode(float16 value) { return SortKey<float>::Encode(value.to_float()); }
+};
 
+#if (__ARM_FEATURE_FP16_SCALAR_ARITHMETIC == 1)
 template <>
-bool CompareDescend(const std::pair<int64_t, float16>& lhs,
-                    const std::pair<int64_t, float16>& rhs) {
-  return lhs.second.to_float() > rhs.second.to_float();
+struct SortKey<__fp16> {
+  using Type = uint32_t;
+  static Type Encode(__fp16 value) { return SortKey<float>::Encode(static_cast<float>(value)); }
+};
+#endif
+
+/*! \brief The rows with at least this many elements are radix sorted. */
+constexpr int64_t kRadixSortMinSize = 1024;
+/*! \brief The rows with this many times more elements than requested are partially sorted. */
+constexpr int64_t kPartialSortRatio = 4;
+/*! \brief The tensors with at least this many elements are sorted in parallel over the rows. */
+constexpr int64_t kParallelSortMinSize = 16384;
+
+/*!
+ * \brief Sort the items of a row by their keys with a least-significant-digit radix sort, which
+ *  keeps the order of the items with equal keys.
+ */
+template <typename Key>
+void RadixSort(std::vector<std::pair<Key, int64_t>>* items,
+               std::vector<std::pair<Key, int64_t>>* buffer) {
+  buffer->resize(items->size());
+  std::vector<std::pair<Key, int64_t>>* src = items;
+  std::vector<std::pair<Key, int64_t>>* dst = buffer;
+  for (size_t shift = 0; shift < sizeof(Key) * 8; shift += 8) {
+    size_t offsets[256] = {0};
+    for (const auto& item : *src) {
+      ++offsets[(item.first >> shift) & 0xFF];
+    }
+    // Skip the digits that all the keys share.
+    if (offsets[(src->front().first >> shift) & 0xFF] == src->size()) {
+      continue;
+    }
+    size_t offset = 0;
+    for (size_t& bucket_offset : offsets) {
+      size_t count = bucket_offset;
+      bucket_offset = offset;
+      offset += count;
+    }
+    for (const auto& item : *src) {
+      (*dst)[offsets[(item.first >> shift) & 0xFF]++] = item;
+    }
+    std::swap(src, dst);
+  }
+  if (src != items) {
+    items->swap(*buffer);
+  }
+}
+
+/*!
+ * \brief Sort the (key, index) items of a row, in which the indices are increasing, so that the
+ *  first k items are in the order of a stable sort by the keys.
+ */
+template <typename Key>
+void SortRow(std::vector<std::pair<Key, int64_t>>* items,
+             std::vector<std::pair<Key, int64_t>>* buffer, int64_t k) {
+  int64_t n = static_cast<int64_t>(items->size());
+  // The items are compared by the keys and then by the indices, which is equivalent to a stable
+  // sort by the keys since the indices are distinct.
+  if (k * kPartialSortRatio <= n) {
+    std::partial_sort(items->begin(), items->begin() + k, items->end());
+  } else if (n >= kRadixSortMinSize) {
+    RadixSort(items, buffer);
+  } else {
+    std::sort(items->begin(), items->end());
+  }
+}
+
+/*! \brief Run the function on the ranges of the rows in parallel over the thread pool. */
+void ParallelForRows(int64_t num_rows, int64_t num_elements,
+                     const std::function<void(int64_t, int64_t)>& f) {
+  if (num_rows < 2 || num_elements < kParallelSortMinSize) {
+    f(0, num_rows);
+    return;
+  }
+  struct Closure {
+    const std::function<void(int64_t, int64_t)>* f;
+    int64_t num_rows;
+  } closure{&f, num_rows};
+  auto task = [](int task_id, TVMParallelGroupEnv* penv, void* cdata) -> int {
+    const Closure* closure = static_cast<const Closure*>(cdata);
+    int64_t begin = closure->num_rows * task_id / penv->num_task;
+    int64_t end = closure->num_rows * (task_id + 1) / penv->num_task;
+    if (begin < end) {
+      (*closure->f)(begin, end);
+    }
+    return 0;
+  };
+  ICHECK_EQ(TVMBackendParallelLaunch(task, &closure, 0), 0);
+}
+
+/*!
+ * \brief Sort the rows of a tensor along an axis.
+ * \param input The tensor.
+ * \param axis The axis to sort along.
+ * \param is_ascend Whether to sort in ascending order.
+ * \param k The maximum number of leading elements of each row that have to be sorted.
+ * \param num_sort The number of elements of a row (given its index) to sort.
+ * \param epilogue The function that takes the index of a row, the offset of its first element
+ *  and its first min(k, num_sort(row)) sorted (key, index) items.
+ */
+template <typename DataType, typename FNumSort, typename FEpilogue>
+void SortRows(DLTensor* input, int32_t axis, bool is_ascend, int64_t k, FNumSort num_sort,
+              FEpilogue epilogue) {
+  using Key = typename SortKey<DataType>::Type;
+  const DataType* data_ptr = static_cast<const DataType*>(input->data);
+  int64_t axis_mul_before = 1;
+  int64_t axis_mul_after = 1;
+  for (int i = 0; i < input->ndim; ++i) {
+    if (i < axis) {
+      axis_mul_before *= input->shape[i];
+    } else if (i > axis) {
+      axis_mul_after *= input->shape[i];
+    }
+  }
+  int64_t axis_len = input->shape[axis];
+  int64_t num_rows = axis_mul_before * axis_mul_after;
+  ParallelForRows(num_rows, num_rows * axis_len, [&](int64_t begin, int64_t end) {
+    std::vector<std::pair<Key, int64_t>> items, buffer;
+    for (int64_t row = begin; row < end; ++row) {
+      int64_t base_idx = row / axis_mul_after * axis_len * axis_mul_after + row % axis_mul_after;
+      int64_t n = num_sort(row);
+      items.clear();
+      for (int64_t kk = 0; kk < n; ++kk) {
+        Key key = SortKey<DataType>::Encode(data_ptr[base_idx + kk * axis_mul_after]);
+        // Flipping the keys sorts in descending order while keeping the ties in order.
+        items.emplace_back(is_ascend ? key : static_cast<Key>(~key), kk);
+      }
+      SortRow(&items, &buffer, std::min(k, n));
+      epilogue(row, base_idx, items);
+    }
+  });
 }
 
 // Argsort implemented C library sort for nms.
@@ -76,11 +245,7 @@ TVM_REGISTER_GLOBAL("tvm.contrib.sort.argsort_nms").set_body([](TVMArgs args, TV
   bool is_ascend = args[4];
 
   auto dtype = input->dtype;
-  auto data_ptr = static_cast<float*>(input->data);
   auto sort_num_ptr = static_cast<int32_t*>(sort_num->data);
-  std::vector<std::pair<int32_t, float>> sorter;
-  int64_t axis_mul_before = 1;
-  int64_t axis_mul_after = 1;
 
   if (axis < 0) {
     axis = input->ndim + axis;
@@ -97,105 +262,64 @@ TVM_REGISTER_GLOBAL("tvm.contrib.sort.argsort_nms").set_body([](TVMArgs args, TV
                                   "input ndim "
                                << input->ndim;
 
-  for (int i = 0; i < input->ndim; ++i) {
-    if (i < axis) {
-      axis_mul_before *= input->shape[i];
-    } else if (i > axis) {
-      axis_mul_after *= input->shape[i];
-    }
+  int64_t axis_len = input->shape[axis];
+  int64_t axis_mul_after = 1;
+  for (int i = axis + 1; i < input->ndim; ++i) {
+    axis_mul_after *= input->shape[i];
   }
-
-  for (int64_t i = 0; i < axis_mul_before; ++i) {
-    for (int64_t j = 0; j < axis_mul_after; ++j) {
-      sorter.clear();
-      int32_t current_sort_num = *(sort_num_ptr + i * axis_mul_after + j);
-      int64_t base_idx = i * input->shape[axis] * axis_mul_after + j;
-      for (int64_t k = 0; k < current_sort_num; ++k) {
-        int64_t full_idx = base_idx + k * axis_mul_after;
-        sorter.emplace_back(std::make_pair(k, *(data_ptr + full_idx)));
-      }
-      if (is_ascend) {
-#if (__ARM_FEATURE_FP16_SCALAR_ARITHMETIC == 1)
-        if (dtype.bits == 16) {
-          std::stable_sort(sorter.begin(), sorter.end(), CompareAscend<__fp16>);
-        } else {
-#endif
-          std::stable_sort(sorter.begin(), sorter.end(), CompareAscend<float>);
-#if (__ARM_FEATURE_FP16_SCALAR_ARITHMETIC == 1)
-        }
-#endif
-      } else {
-#if (__ARM_FEATURE_FP16_SCALAR_ARITHMETIC == 1)
-        if (dtype.bits == 16) {
-          std::stable_sort(sorter.begin(), sorter.end(), CompareDescend<__fp16>);
-        } else {
-#endif
-          std::stable_sort(sorter.begin(), sorter.end(), CompareDescend<float>);
-#if (__ARM_FEATURE_FP16_SCALAR_ARITHMETIC == 1)
-        }
-#endif
-      }
-      for (int32_t k = 0; k < input->shape[axis]; ++k) {
-        *(static_cast<int32_t*>(output->data) + base_idx + k * axis_mul_after) =
-            k < static_cast<int32_t>(sorter.size()) ? sorter[k].first : k;
-      }
+  auto num_sort = [&](int64_t row) {
+    return std::min<int64_t>(std::max<int32_t>(sort_num_ptr[row], 0), axis_len);
+  };
+  auto epilogue = [&](int64_t row, int64_t base_idx, const auto& sorter) {
+    int64_t num_sorted = num_sort(row);
+    int32_t* out_ptr = static_cast<int32_t*>(output->data);
+    for (int64_t k = 0; k < axis_len; ++k) {
+      out_ptr[base_idx + k * axis_mul_after] =
+          static_cast<int32_t>(k < num_sorted ? sorter[k].second : k);
     }
+  };
+#if (__ARM_FEATURE_FP16_SCALAR_ARITHMETIC == 1)
+  if (dtype.bits == 16) {
+    SortRows<__fp16>(input, axis, is_ascend, axis_len, num_sort, epilogue);
+    return;
   }
+#endif
+  SortRows<float>(input, axis, is_ascend, axis_len, num_sort, epilogue);
 });
 
-template <typename DataType, typename OutType>
-void sort_impl(
-    DLTensor* input, DLTensor* output, int32_t axis, bool is_ascend,
-    std::function<void(OutType*, size_t, const std::pair<int64_t, DataType>&)> epilogue) {
-  auto data_ptr = static_cast<DataType*>(input->data);
-  auto out_ptr = static_cast<OutType*>(output->data);
-  std::vector<std::pair<int64_t, DataType>> sorter;
-
-  int axis_mul_before = 1;
-  int axis_mul_after = 1;
-  for (int i = 0; i < input->ndim; ++i) {
-    if (i < axis) {
-      axis_mul_before *= input->shape[i];
-    } else if (i > axis) {
-      axis_mul_after *= input->shape[i];
-    }
-  }
-
-  for (int i = 0; i < axis_mul_before; ++i) {
-    for (int j = 0; j < axis_mul_after; ++j) {
-      sorter.clear();
-      int64_t base_idx = i * input->shape[axis] * axis_mul_after + j;
-      for (int64_t k = 0; k < input->shape[axis]; ++k) {
-        int64_t full_idx = base_idx + k * axis_mul_after;
-        sorter.emplace_back(std::make_pair(k, data_ptr[full_idx]));
-      }
-      if (is_ascend) {
-        std::stable_sort(sorter.begin(), sorter.end(), CompareAscend<DataType>);
-      } else {
-        std::stable_sort(sorter.begin(), sorter.end(), CompareDescend<DataType>);
-      }
-      for (int64_t k = 0; k < input->shape[axis]; ++k) {
-        epilogue(out_ptr, base_idx + k * axis_mul_after, sorter[k]);
-      }
-    }
-  }
-}
-
 template <typename DataType, typename OutType>
 void argsort(DLTensor* input, DLTensor* output, int32_t axis, bool is_ascend) {
-  return sort_impl<DataType, OutType>(
-      input, output, axis, is_ascend,
-      [](OutType* out_ptr, size_t index, const std::pair<int64_t, DataType>& sort_pair) {
-        out_ptr[index] = static_cast<OutType>(sort_pair.first);
+  OutType* out_ptr = static_cast<OutType*>(output->data);
+  int64_t axis_len = input->shape[axis];
+  int64_t axis_mul_after = 1;
+  for (int i = axis + 1; i < input->ndim; ++i) {
+    axis_mul_after *= input->shape[i];
+  }
+  SortRows<DataType>(
+      input, axis, is_ascend, axis_len, [axis_len](int64_t) { return axis_len; },
+      [&](int64_t, int64_t base_idx, const auto& sorter) {
+        for (int64_t k = 0; k < axis_len; ++k) {
+          out_ptr[base_idx + k * axis_mul_after] = static_cast<OutType>(sorter[k].second);
+        }
       });
 }
 
 template <typename DataType>
 void sort(DLTensor* input, DLTensor* output, int32_t axis, bool is_ascend) {
-  return sort_impl<DataType, DataType>(
-      input, output, axis, is_ascend,
-      [](DataType* out_ptr, size_t index, const std::pair<int64_t, DataType>& sort_pair) {
-        out_ptr[index] = sort_pair.second;
+  const DataType* data_ptr = static_cast<const DataType*>(input->data);
+  DataType* out_ptr = static_cast<DataType*>(output->data);
+  int64_t axis_len = input->shape[axis];
+  int64_t axis_mul_after = 1;
+  for (int i = axis + 1; i < input->ndim; ++i) {
+    axis_mul_after *= input->shape[i];
+  }
+  SortRows<DataType>(
+      input, axis, is_ascend, axis_len, [axis_len](int64_t) { return axis_len; },
+      [&](int64_t, int64_t base_idx, const auto& sorter) {
+        for (int64_t k = 0; k < axis_len; ++k) {
+          out_ptr[base_idx + k * axis_mul_after] =
+              data_ptr[base_idx + sorter[k].second * axis_mul_after];
+        }
       });
 }
 
@@ -340,52 +464,35 @@ TVM_REGISTER_GLOBAL("tvm.contrib.sort.sort").set_body([](TVMArgs args, TVMRetVal
 template <typename DataType, typename IndicesType>
 void topk(DLTensor* input, DLTensor* out_values, DLTensor* out_indices, int k, int axis,
           bool is_ascend) {
-  DataType* data_ptr = static_cast<DataType*>(input->data);
+  const DataType* data_ptr = static_cast<const DataType*>(input->data);
   DataType* values_ptr =
       (out_values == nullptr) ? nullptr : static_cast<DataType*>(out_values->data);
   IndicesType* indices_ptr =
       (out_indices == nullptr) ? nullptr : static_cast<IndicesType*>(out_indices->data);
-  std::vector<std::pair<int64_t, DataType>> sorter;
 
-  int axis_mul_before = 1;
-  int axis_mul_after = 1;
-  for (int i = 0; i < input->ndim; ++i) {
-    if (i < axis) {
-      axis_mul_before *= input->shape[i];
-    } else if (i > axis) {
-      axis_mul_after *= input->shape[i];
-    }
-  }
-  if (k < 1) {
-    k = input->shape[axis];
+  int64_t axis_len = input->shape[axis];
+  int64_t axis_mul_after = 1;
+  for (int i = axis + 1; i < input->ndim; ++i) {
+    axis_mul_after *= input->shape[i];
   }
-
-  for (int i = 0; i < axis_mul_before; ++i) {
-    for (int j = 0; j < axis_mul_after; ++j) {
-      sorter.clear();
-      int64_t src_base_idx = i * input->shape[axis] * axis_mul_after + j;
-      int64_t dst_base_idx = i * k * axis_mul_after + j;
-      for (int64_t kk = 0; kk < input->shape[axis]; ++kk) {
-        int64_t full_idx = src_base_idx + kk * axis_mul_after;
-        sorter.emplace_back(std::make_pair(kk, data_ptr[full_idx]));
-      }
-      if (is_ascend) {
-        std::stable_sort(sorter.begin(), sorter.end(), CompareAscend<DataType>);
-      } else {
-        std::stable_sort(sorter.begin(), sorter.end(), CompareDescend<DataType>);
-      }
-      int64_t cnt = k > 0 ? k : input->shape[axis];
-      for (int64_t kk = 0; kk < cnt; ++kk) {
-        if (indices_ptr != nullptr) {
-          indices_ptr[dst_base_idx + kk * axis_mul_after] =
-              static_cast<IndicesType>(sorter[kk].first);
+  int64_t cnt = k < 1 ? axis_len : std::min<int64_t>(k, axis_len);
+
+  // Only the first k elements of each row are selected and sorted.
+  SortRows<DataType>(
+      input, axis, is_ascend, cnt, [axis_len](int64_t) { return axis_len; },
+      [&](int64_t row, int64_t src_base_idx, const auto& sorter) {
+        int64_t dst_base_idx = row / axis_mul_after * cnt * axis_mul_after + row % axis_mul_after;
+        for (int64_t kk = 0; kk < cnt; ++kk) {
+          if (indices_ptr != nullptr) {
+            indices_ptr[dst_base_idx + kk * axis_mul_after] =
+                static_cast<IndicesType>(sorter[kk].second);
+          }
+          if (values_ptr != nullptr) {
+            values_ptr[dst_base_idx + kk * axis_mul_after] =
+                data_ptr[src_base_idx + sorter[kk].second * axis_mul_after];
+          }
         }
-        if (values_ptr != nullptr) {
-          values_ptr[dst_base_idx + kk * axis_mul_after] = static_cast<DataType>(sorter[kk].second);
-        }
-      }
-    }
-  }
+      });
 }
 
 // Argsort implemented C library sort.
@@ -299,6 +299,10 @@ void GraphExecutor::SetupStorage() {
     size_t bits = t.bits * t.lanes;
     ICHECK(bits % 8U == 0U || bits == 1U || bits == 4U);
     size_t bytes = ((bits + 7U) / 8U) * size;
+    if (!attrs_.storage_offset.empty()) {
+      // The entries of an arena end at their offsets + sizes.
+      bytes += static_cast<size_t>(attrs_.storage_offset[i]);
+    }
 
     uint32_t sid = static_cast<uint32_t>(storage_id);
     if (sid >= pool_entry.size()) {
@@ -348,13 +352,35 @@ void GraphExecutor::SetupStorage() {
   for (size_t i = 0; i < data_entry_.size(); ++i) {
     int storage_id = attrs_.storage_id[i];
     ICHECK_LT(static_cast<size_t>(storage_id), storage_pool_.size());
-    data_entry_[i] = storage_pool_[storage_id].CreateView(attrs_.shape[i], vtype[i]);
+    if (attrs_.storage_offset.empty() || attrs_.storage_offset[i] == 0) {
+      data_entry_[i] = storage_pool_[storage_id].CreateView(attrs_.shape[i], vtype[i]);
+    } else {
+      data_entry_[i] = CreateOffsetView(storage_pool_[storage_id], attrs_.storage_offset[i],
+                                        attrs_.shape[i], vtype[i]);
+    }
 
     const DLTensor* tmp = data_entry_[i].operator->();
     data_alignment_[i] = details::GetDataAlignment(*tmp);
   }
 }
 
+NDArray GraphExecutor::CreateOffsetView(const NDArray& storage, int64_t offset,
+                                        const std::vector<int64_t>& shape, DLDataType dtype) {
+  // The kernels expect zero byte offsets, hence the offset is applied to the data pointer, which
+  // requires a device w/ flat addressing.
+  DLDeviceType device_type = storage->device.device_type;
+  ICHECK(device_type == kDLCPU || device_type == kDLCUDA || device_type == kDLCUDAHost ||
+         device_type == kDLROCM)
+      << "The storage offsets planned by the interval packing are not supported on device type "
+      << device_type;
+  std::vector<int64_t> storage_shape{
+      static_cast<int64_t>(GetDataSize(*storage.operator->()) - offset)};
+  NDArray view =
+      const_cast<NDArray&>(storage).CreateView(storage_shape, DLDataType{kDLUInt, 8, 1});
+  const_cast<DLTensor*>(view.operator->())->data = static_cast<char*>(storage->data) + offset;
+  return view.CreateView(shape, dtype);
+}
+
 void GraphExecutor::SetupOpExecs() {
   op_execs_.resize(this->GetNumOfNodes());
   input_dltensors_.resize(num_node_entries());
@@ -275,6 +275,8 @@ class TVM_DLL GraphExecutor : public ModuleNode {
   struct GraphAttr {
     size_t storage_num_not_alloctaed{0};
     std::vector<int> storage_id;
+    /*! \brief The byte offsets within the storages, empty if each entry starts its storage. */
+    std::vector<int64_t> storage_offset;
     std::vector<int> device_index;
     std::vector<std::string> dltype;
     std::vector<std::vector<int64_t>> shape;
@@ -311,6 +313,14 @@ class TVM_DLL GraphExecutor : public ModuleNode {
           reader->Read(&shape);
           ICHECK(!reader->NextArrayItem());
           bitmask |= 4;
+        } else if (key == "storage_offset") {
+          reader->BeginArray();
+          ICHECK(reader->NextArrayItem());
+          reader->Read(&type);
+          ICHECK_EQ(type, "list_int");
+          ICHECK(reader->NextArrayItem());
+          reader->Read(&storage_offset);
+          ICHECK(!reader->NextArrayItem());
         } else if (key == "device_index") {
           reader->BeginArray();
           ICHECK(reader->NextArrayItem());
@@ -375,6 +385,16 @@ class TVM_DLL GraphExecutor : public ModuleNode {
   static void LinkedNDArrayDeleter(Object* container);
   /*! \brief Setup the temporal storage */
   void SetupStorage();
+  /*!
+   * \brief Create a view of the given shape and type at a byte offset within a storage.
+   * \param storage The storage.
+   * \param offset The byte offset.
+   * \param shape The shape of the view.
+   * \param dtype The data type of the view.
+   * \return The created view.
+   */
+  static NDArray CreateOffsetView(const NDArray& storage, int64_t offset,
+                                  const std::vector<int64_t>& shape, DLDataType dtype);
   /*! \brief Setup the executors. */
   void SetupOpExecs();
   /*!
@@ -448,6 +448,84 @@ TVM_REGISTER_GLOBAL("tvm.rpc.server.ModuleGetFunction")
       return parent->GetFunction(name, query_imports);
     });
 
+/*!
+ * \brief Measure a module that has been uploaded to the server in a single round trip.
+ *
+ *  Loading the module, preparing its arguments, checking its first run and timing it would
+ *  otherwise take a dozen RPC calls, whose latency dominates the measurement of short kernels
+ *  over real networks. The arguments are allocated and randomly filled on the device, so no
+ *  tensor goes through the channel.
+ *
+ *  The arguments are (file_name, device_type, device_id, number, repeat, min_repeat_ms,
+ *  f_preproc_name), followed by (dtype, ndim, shape[0], ..., shape[ndim - 1]) for each tensor
+ *  argument of the entry function. The return value is the same as the time evaluator's.
+ */
+TVM_REGISTER_GLOBAL("tvm.rpc.server.MeasureModule").set_body([](TVMArgs args, TVMRetValue* rv) {
+  ICHECK_GE(args.size(), 7) << "tvm.rpc.server.MeasureModule expects at least 7 arguments";
+  std::string file_name = args[0];
+  Device dev;
+  dev.device_type = static_cast<DLDeviceType>(args[1].operator int());
+  dev.device_id = args[2];
+  int number = args[3], repeat = args[4], min_repeat_ms = args[5];
+  std::string f_preproc_name = args[6];
+
+  const PackedFunc* fload = runtime::Registry::Get("tvm.rpc.server.load_module");
+  ICHECK(fload != nullptr) << "require tvm.rpc.server.load_module";
+  Module m;
+  try {
+    m = (*fload)(file_name);
+  } catch (const std::exception& e) {
+    LOG(FATAL) << "Cannot load module " << file_name << ": " << e.what();
+  }
+  PackedFunc entry = m.GetFunction(symbol::tvm_module_main, true);
+  ICHECK(entry != nullptr) << "Cannot find the entry function of " << file_name;
+
+  const PackedFunc* frandom_fill = runtime::Registry::Get("tvm.contrib.random.random_fill");
+  ICHECK(frandom_fill != nullptr)
+      << "Please make sure USE_RANDOM is ON in the config.cmake on the remote devices";
+  std::vector<NDArray> tensors;
+  for (int i = 7; i < args.size();) {
+    ICHECK_LT(i + 1, args.size()) << "Missing the rank of argument " << tensors.size();
+    DLDataType dtype = args[i];
+    int ndim = args[i + 1];
+    ICHECK_LE(i + 2 + ndim, args.size()) << "Missing the shape of argument " << tensors.size();
+    std::vector<int64_t> shape;
+    for (int j = 0; j < ndim; ++j) {
+      shape.push_back(args[i + 2 + j].operator int64_t());
+    }
+    tensors.push_back(NDArray::Empty(shape, dtype, dev));
+    (*frandom_fill)(tensors.back());
+    i += 2 + ndim;
+  }
+  std::vector<TVMValue> values(tensors.size());
+  std::vector<int> type_codes(tensors.size());
+  TVMArgsSetter setter(values.data(), type_codes.data());
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    setter(i, const_cast<DLTensor*>(tensors[i].operator->()));
+  }
+  TVMArgs entry_args(values.data(), type_codes.data(), static_cast<int>(tensors.size()));
+
+  // Run once to check that the kernel is correct before timing it.
+  TVMRetValue temp;
+  DeviceAPI::Get(dev)->StreamSync(dev, nullptr);
+  entry.CallPacked(entry_args, &temp);
+  DeviceAPI::Get(dev)->StreamSync(dev, nullptr);
+
+  PackedFunc f_preproc;
+  if (!f_preproc_name.empty()) {
+    auto* pf_preproc = runtime::Registry::Get(f_preproc_name);
+    ICHECK(pf_preproc != nullptr) << "Cannot find " << f_preproc_name << " in the global function";
+    f_preproc = *pf_preproc;
+  }
+  WrapTimeEvaluator(entry, dev, number, repeat, min_repeat_ms, f_preproc)
+      .CallPacked(entry_args, rv);
+
+  if (const PackedFunc* fremove = runtime::Registry::Get("tvm.rpc.server.remove")) {
+    (*fremove)(file_name);
+    (*fremove)(file_name.substr(0, file_name.rfind('.')) + ".so");
+  }
+});
+
 // functions to access an RPC module.
 TVM_REGISTER_GLOBAL("rpc.LoadRemoteModule").set_body_typed([](Module sess, std::string name) {
   std::string tkey = sess->type_key();
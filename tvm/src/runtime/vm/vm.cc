@@ -31,6 +31,9 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
 #include <iostream>
 #include <stdexcept>
 #include <vector>
@@ -113,6 +116,71 @@ std::vector<int64_t> ToShape(NDArray shape_tensor) {
   return shape;
 }
 
+/*! \brief The address of the first element of a tensor. */
+inline const void* TraceAddress(const DLTensor& tensor) {
+  return static_cast<const char*>(tensor.data) + tensor.byte_offset;
+}
+
+/*!
+ * \brief Flatten an argument of a function into its tensor leaves, and append its input-shape
+ *  signature to the key.
+ * \return Whether the argument can be traced, i.e., it only holds host tensors.
+ */
+bool FlattenTraceInput(const ObjectRef& arg, std::vector<NDArray>* leaves, std::string* key) {
+  if (const auto* adt = arg.as<ADTObj>()) {
+    key->push_back('(');
+    key->append(reinterpret_cast<const char*>(&adt->tag), sizeof(adt->tag));
+    for (size_t i = 0; i < adt->size; ++i) {
+      if (!FlattenTraceInput((*adt)[i], leaves, key)) {
+        return false;
+      }
+    }
+    key->push_back(')');
+    return true;
+  }
+  const auto* tensor_obj = arg.as<NDArray::Container>();
+  if (tensor_obj == nullptr || tensor_obj->dl_tensor.device.device_type != kDLCPU) {
+    return false;
+  }
+  const DLTensor& tensor = tensor_obj->dl_tensor;
+  key->append(reinterpret_cast<const char*>(&tensor.dtype), sizeof(tensor.dtype));
+  key->append(reinterpret_cast<const char*>(&tensor.ndim), sizeof(tensor.ndim));
+  key->append(reinterpret_cast<const char*>(tensor.shape), sizeof(int64_t) * tensor.ndim);
+  leaves->push_back(Downcast<NDArray>(arg));
+  return true;
+}
+
+/*! \brief Get the tensor that a trace step operates on, given the inputs of the replay. */
+inline DLTensor* ResolveTraceTensor(TraceTensor* tensor, const std::vector<NDArray>& inputs) {
+  if (tensor->input_leaf < 0) {
+    return const_cast<DLTensor*>(tensor->tensor.operator->());
+  }
+  const DLTensor* input = inputs[tensor->input_leaf].operator->();
+  tensor->rebound.data = const_cast<char*>(static_cast<const char*>(TraceAddress(*input))) +
+                         tensor->input_offset;
+  return &tensor->rebound;
+}
+
+/*!
+ * \brief Copy the recorded return value of a trace into fresh tensors, so that the results of
+ *  the different invocations do not alias each other.
+ */
+ObjectRef CopyTraceOutput(const ObjectRef& obj, ExecutionTrace* trace,
+                          const std::vector<NDArray>& inputs, size_t* leaf) {
+  if (const auto* adt = obj.as<ADTObj>()) {
+    std::vector<ObjectRef> fields;
+    for (size_t i = 0; i < adt->size; ++i) {
+      fields.push_back(CopyTraceOutput((*adt)[i], trace, inputs, leaf));
+    }
+    return ADT(adt->tag, fields);
+  }
+  const DLTensor* src = ResolveTraceTensor(&trace->output_leaves[(*leaf)++], inputs);
+  NDArray dst = NDArray::Empty(std::vector<int64_t>(src->shape, src->shape + src->ndim),
+                               src->dtype, src->device);
+  dst.CopyFrom(src);
+  return dst;
+}
+
 PackedFunc VirtualMachine::GetFunction(const std::string& name,
                                        const ObjectPtr<Object>& sptr_to_self) {
   if (name == "invoke") {
@@ -226,6 +294,13 @@ PackedFunc VirtualMachine::GetFunction(const std::string& name,
       inputs_.erase(func_name);
       inputs_.emplace(func_name, func_args);
     });
+  } else if (name == "set_trace_mode") {
+    return TypedPackedFunc<void(int64_t)>([this](int64_t max_num_signatures) {
+      ICHECK(recording_trace_ == nullptr) << "Cannot change the trace mode while recording";
+      trace_cache_size_ = static_cast<size_t>(std::max<int64_t>(max_num_signatures, 0));
+      traces_.clear();
+      trace_index_.clear();
+    });
   } else {
     LOG(FATAL) << "Unknown packed function: " << name;
     return PackedFunc([sptr_to_self, name](TVMArgs args, TVMRetValue* rv) {});
@@ -273,8 +348,22 @@ void VirtualMachine::InvokeGlobal(const VMFunction& func, const std::vector<Obje
 ObjectRef VirtualMachine::Invoke(const VMFunction& func, const std::vector<ObjectRef>& args) {
   DLOG(INFO) << "Executing Function: " << std::endl << func;
 
+  if (trace_cache_size_ > 0 && frames_.empty() && packed_call_depth_ == 0) {
+    ObjectRef output;
+    if (InvokeTraced(func, args, &output)) {
+      return_register_ = output;
+      return output;
+    }
+  }
+  // A packed function that calls back into the VM resumes the outer function at the instruction
+  // that invoked it, rather than at the return address of the nested frame.
+  bool is_reentrant = !frames_.empty();
+  Index caller_pc = pc_;
   InvokeGlobal(func, args);
   RunLoop();
+  if (is_reentrant) {
+    pc_ = caller_pc;
+  }
   return return_register_;
 }
 
@@ -287,6 +376,234 @@ ObjectRef VirtualMachine::Invoke(const std::string& name, const std::vector<Obje
   return Invoke(exec_->functions[func_index_], args);
 }
 
+bool VirtualMachine::InvokeTraced(const VMFunction& func, const std::vector<ObjectRef>& args,
+                                  ObjectRef* output) {
+  // The traces are limited to the host, where the kernels complete before they return.
+  for (const Device& dev : devices_) {
+    if (dev.device_type != 0 && dev.device_type != kDLCPU) {
+      return false;
+    }
+  }
+  std::string key = func.name;
+  key.push_back('\0');
+  std::vector<NDArray> inputs;
+  for (const ObjectRef& arg : args) {
+    if (!FlattenTraceInput(arg, &inputs, &key)) {
+      return false;
+    }
+  }
+
+  auto it = trace_index_.find(key);
+  if (it != trace_index_.end()) {
+    traces_.splice(traces_.begin(), traces_, it->second);
+    ExecutionTrace& trace = it->second->second;
+    if (!trace.valid) {
+      return false;
+    }
+    if (!ReplayTrace(&trace, inputs)) {
+      // The control flow or the allocations depend on the values of the inputs, hence the
+      // signature is interpreted from now on.
+      DLOG(INFO) << "The execution trace of " << func.name << " is invalidated by a guard";
+      trace = ExecutionTrace();
+      trace.valid = false;
+      return false;
+    }
+    size_t leaf = 0;
+    *output = CopyTraceOutput(trace.output, &trace, inputs, &leaf);
+    return true;
+  }
+
+  // Each tensor must alias at most one of the input leaves.
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    for (size_t j = i + 1; j < inputs.size(); ++j) {
+      const char* begin_i = static_cast<const char*>(TraceAddress(*inputs[i].operator->()));
+      const char* begin_j = static_cast<const char*>(TraceAddress(*inputs[j].operator->()));
+      if (begin_i < begin_j + GetDataSize(*inputs[j].operator->()) &&
+          begin_j < begin_i + GetDataSize(*inputs[i].operator->())) {
+        return false;
+      }
+    }
+  }
+
+  traces_.emplace_front(key, ExecutionTrace());
+  trace_index_[key] = traces_.begin();
+  if (traces_.size() > trace_cache_size_) {
+    trace_index_.erase(traces_.back().first);
+    traces_.pop_back();
+  }
+  ExecutionTrace& trace = traces_.front().second;
+  recording_trace_ = &trace;
+  trace_inputs_ = inputs;
+  trace_written_.clear();
+  try {
+    InvokeGlobal(func, args);
+    RunLoop();
+  } catch (...) {
+    recording_trace_ = nullptr;
+    trace_inputs_.clear();
+    trace_written_.clear();
+    traces_.erase(trace_index_[key]);
+    trace_index_.erase(key);
+    throw;
+  }
+  recording_trace_ = nullptr;
+  trace_written_.clear();
+
+  std::function<bool(const ObjectRef&)> bind_output = [&](const ObjectRef& obj) {
+    if (const auto* adt = obj.as<ADTObj>()) {
+      for (size_t i = 0; i < adt->size; ++i) {
+        if (!bind_output((*adt)[i])) {
+          return false;
+        }
+      }
+      return true;
+    }
+    if (!obj.defined() || !obj->IsInstance<NDArray::ContainerType>()) {
+      return false;
+    }
+    trace.output_leaves.push_back(BindTraceTensor(Downcast<NDArray>(obj)));
+    return true;
+  };
+  trace.valid = trace.valid && bind_output(return_register_);
+  trace_inputs_.clear();
+  if (!trace.valid) {
+    DLOG(INFO) << "The execution of " << func.name << " cannot be traced";
+    trace = ExecutionTrace();
+    trace.valid = false;
+    *output = return_register_;
+    return true;
+  }
+  DLOG(INFO) << "Recorded the execution trace of " << func.name << " with "
+             << trace.steps.size() << " steps";
+  trace.output = return_register_;
+  size_t leaf = 0;
+  *output = CopyTraceOutput(trace.output, &trace, inputs, &leaf);
+  return true;
+}
+
+bool VirtualMachine::ReplayTrace(ExecutionTrace* trace, const std::vector<NDArray>& inputs) {
+  for (TraceStep& step : trace->steps) {
+    switch (step.kind) {
+      case TraceStep::kCall: {
+        for (size_t i = 0; i < step.tensors.size(); ++i) {
+          step.values[i].v_handle = ResolveTraceTensor(&step.tensors[i], inputs);
+        }
+        TVMRetValue rv;
+        GetPackedFunc(step.packed_index)
+            .CallPacked(TVMArgs(step.values.data(), step.codes.data(),
+                                static_cast<int>(step.values.size())),
+                        &rv);
+        break;
+      }
+      case TraceStep::kCopy: {
+        NDArray::CopyFromTo(ResolveTraceTensor(&step.tensors[0], inputs),
+                            ResolveTraceTensor(&step.tensors[1], inputs));
+        break;
+      }
+      case TraceStep::kGuard: {
+        const DLTensor* tensor = ResolveTraceTensor(&step.tensors[0], inputs);
+        if (std::memcmp(TraceAddress(*tensor), step.expected.data(), step.expected.size()) != 0) {
+          return false;
+        }
+        break;
+      }
+    }
+  }
+  return true;
+}
+
+TraceTensor VirtualMachine::BindTraceTensor(const NDArray& tensor) const {
+  TraceTensor bound;
+  bound.tensor = tensor;
+  const char* address = static_cast<const char*>(TraceAddress(*tensor.operator->()));
+  for (size_t i = 0; i < trace_inputs_.size(); ++i) {
+    const DLTensor& input = *trace_inputs_[i].operator->();
+    const char* begin = static_cast<const char*>(TraceAddress(input));
+    if (address >= begin && address < begin + GetDataSize(input)) {
+      bound.input_leaf = static_cast<int>(i);
+      bound.input_offset = address - begin;
+      bound.rebound = *tensor.operator->();
+      bound.rebound.byte_offset = 0;
+      break;
+    }
+  }
+  return bound;
+}
+
+void VirtualMachine::RecordTraceCall(Index packed_index, Index arg_count, Index output_size,
+                                     const std::vector<ObjectRef>& args) {
+  if (recording_trace_ == nullptr || !recording_trace_->valid || packed_call_depth_ != 0) {
+    return;
+  }
+  TraceStep step;
+  step.kind = TraceStep::kCall;
+  step.packed_index = packed_index;
+  for (Index i = 0; i < arg_count; ++i) {
+    bool is_output = i >= arg_count - output_size;
+    auto record = [&](const ObjectRef& obj) {
+      NDArray tensor = Downcast<NDArray>(obj);
+      if (tensor->device.device_type != kDLCPU) {
+        recording_trace_->valid = false;
+      }
+      if (is_output) {
+        trace_written_.insert(TraceAddress(*tensor.operator->()));
+      }
+      step.tensors.push_back(BindTraceTensor(tensor));
+    };
+    if (const auto* adt = args[i].as<ADTObj>()) {
+      for (size_t fi = 0; fi < adt->size; ++fi) {
+        record((*adt)[fi]);
+      }
+    } else {
+      record(args[i]);
+    }
+  }
+  step.values.resize(step.tensors.size());
+  step.codes.assign(step.tensors.size(), kTVMDLTensorHandle);
+  recording_trace_->steps.push_back(std::move(step));
+}
+
+void VirtualMachine::RecordTraceCopy(const NDArray& src, const NDArray& dst) {
+  if (recording_trace_ == nullptr || !recording_trace_->valid) {
+    return;
+  }
+  if (src->device.device_type != kDLCPU || dst->device.device_type != kDLCPU) {
+    recording_trace_->valid = false;
+    return;
+  }
+  TraceStep step;
+  step.kind = TraceStep::kCopy;
+  step.tensors.push_back(BindTraceTensor(src));
+  step.tensors.push_back(BindTraceTensor(dst));
+  trace_written_.insert(TraceAddress(*dst.operator->()));
+  recording_trace_->steps.push_back(std::move(step));
+}
+
+void VirtualMachine::RecordTraceGuard(RegName reg) {
+  if (recording_trace_ == nullptr || !recording_trace_->valid) {
+    return;
+  }
+  ObjectRef obj = ReadRegister(reg);
+  const auto* tensor_obj = obj.as<NDArray::Container>();
+  if (tensor_obj == nullptr || tensor_obj->dl_tensor.device.device_type != kDLCPU ||
+      !IsContiguous(tensor_obj->dl_tensor)) {
+    recording_trace_->valid = false;
+    return;
+  }
+  NDArray tensor = Downcast<NDArray>(obj);
+  TraceTensor bound = BindTraceTensor(tensor);
+  const void* address = TraceAddress(tensor_obj->dl_tensor);
+  // The values that no recorded step writes stay the same across the replays.
+  if (bound.input_leaf < 0 && !trace_written_.count(address)) {
+    return;
+  }
+  TraceStep step;
+  step.kind = TraceStep::kGuard;
+  step.expected.assign(static_cast<const char*>(address), GetDataSize(tensor_obj->dl_tensor));
+  step.tensors.push_back(std::move(bound));
+  recording_trace_->steps.push_back(std::move(step));
+}
+
 void VirtualMachine::InvokePacked(Index packed_index, const PackedFunc& func, Index arg_count,
                                   Index output_size, const std::vector<ObjectRef>& args) {
   size_t arity = 0;
@@ -298,37 +615,117 @@ void VirtualMachine::InvokePacked(Index packed_index, const PackedFunc& func, In
     }
   }
 
-  std::vector<TVMValue> values(arity);
-  std::vector<int> codes(arity);
+  // The argument buffers are reused across the calls, unless a packed function calls back into
+  // the VM while the outer call is still using them.
+  std::vector<TVMValue> local_values;
+  std::vector<int> local_codes;
+  std::vector<TVMValue>& values = packed_call_depth_ == 0 ? packed_arg_values_ : local_values;
+  std::vector<int>& codes = packed_call_depth_ == 0 ? packed_arg_codes_ : local_codes;
+  if (values.size() < arity) {
+    values.resize(arity);
+    codes.resize(arity);
+  }
   runtime::TVMArgsSetter setter(values.data(), codes.data());
+  auto set_nd_array = [&setter](int idx, const ObjectRef& obj) {
+    ICHECK(obj->IsInstance<NDArray::ContainerType>())
+        << "Expect the arguments of a packed function to be NDArrays, but got "
+        << obj->GetTypeKey();
+    setter(idx, obj);
+  };
   int idx = 0;
   bool is_empty_output = false;
   for (Index i = 0; i < arg_count; i++) {
     if (const auto* dt_cell = args[i].as<ADTObj>()) {
       for (size_t fi = 0; fi < dt_cell->size; ++fi) {
-        auto obj = (*dt_cell)[fi];
-        auto nd_array = Downcast<NDArray>(obj);
-        setter(idx++, nd_array);
+        set_nd_array(idx++, (*dt_cell)[fi]);
       }
     } else {
-      auto nd_array = Downcast<NDArray>(args[i]);
+      set_nd_array(idx++, args[i]);
       // We can safely skip CallPacked if there is only one
       // output and it is empty.
       if (i == arg_count - 1 && output_size == 1) {
-        for (const auto& dim : nd_array.Shape()) {
-          if (!dim) {
+        const DLTensor& tensor = static_cast<const NDArray::Container*>(args[i].get())->dl_tensor;
+        for (int dim = 0; dim < tensor.ndim; ++dim) {
+          if (!tensor.shape[dim]) {
             is_empty_output = true;
             break;
           }
         }
       }
-      setter(idx++, nd_array);
     }
   }
 
   if (!is_empty_output) {
+    RecordTraceCall(packed_index, arg_count, output_size, args);
     TVMRetValue rv;
-    func.CallPacked(TVMArgs(values.data(), codes.data(), arity), &rv);
+    ++packed_call_depth_;
+    try {
+      func.CallPacked(TVMArgs(values.data(), codes.data(), arity), &rv);
+    } catch (...) {
+      --packed_call_depth_;
+      throw;
+    }
+    --packed_call_depth_;
+  }
+}
+
+void VirtualMachine::InvokeShapeFunc(Index packed_index, const PackedFunc& func, Index arg_count,
+                                     Index output_size, const std::vector<ObjectRef>& args) {
+  // The shape functions run on the host, hence their inputs are keyed by value. Inputs that are
+  // not plain host tensors (e.g., tuples) or that are too large to hash cheaply bypass the cache.
+  constexpr size_t kMaxKeyBytes = 4096;
+  std::string key;
+  bool cacheable = shape_func_cache_size_ > 0;
+  for (Index i = 0; i < arg_count && cacheable; ++i) {
+    const auto* tensor_obj = args[i].as<NDArray::Container>();
+    if (tensor_obj == nullptr || tensor_obj->dl_tensor.device.device_type != kDLCPU ||
+        !IsContiguous(tensor_obj->dl_tensor)) {
+      cacheable = false;
+      break;
+    }
+    if (i >= arg_count - output_size) {
+      continue;
+    }
+    const DLTensor& tensor = tensor_obj->dl_tensor;
+    size_t nbytes = GetDataSize(tensor);
+    if (key.size() + nbytes > kMaxKeyBytes) {
+      cacheable = false;
+      break;
+    }
+    key.append(reinterpret_cast<const char*>(&tensor.dtype), sizeof(tensor.dtype));
+    key.append(reinterpret_cast<const char*>(&tensor.ndim), sizeof(tensor.ndim));
+    key.append(reinterpret_cast<const char*>(tensor.shape), sizeof(int64_t) * tensor.ndim);
+    key.append(static_cast<const char*>(tensor.data) + tensor.byte_offset, nbytes);
+  }
+  if (!cacheable) {
+    InvokePacked(packed_index, func, arg_count, output_size, args);
+    return;
+  }
+
+  ShapeFuncCache& cache = shape_func_caches_[packed_index];
+  auto it = cache.index.find(key);
+  if (it != cache.index.end()) {
+    cache.entries.splice(cache.entries.begin(), cache.entries, it->second);
+    const std::vector<NDArray>& outputs = it->second->second;
+    for (Index i = 0; i < output_size; ++i) {
+      NDArray dst = Downcast<NDArray>(args[arg_count - output_size + i]);
+      ICHECK_EQ(GetDataSize(*dst.operator->()), GetDataSize(*outputs[i].operator->()));
+      dst.CopyFrom(outputs[i]);
+    }
+    return;
+  }
+
+  InvokePacked(packed_index, func, arg_count, output_size, args);
+  std::vector<NDArray> outputs;
+  for (Index i = 0; i < output_size; ++i) {
+    NDArray output = Downcast<NDArray>(args[arg_count - output_size + i]);
+    outputs.push_back(output.CopyTo(output->device));
+  }
+  cache.entries.emplace_front(key, std::move(outputs));
+  cache.index[key] = cache.entries.begin();
+  if (cache.entries.size() > shape_func_cache_size_) {
+    cache.index.erase(cache.entries.back().first);
+    cache.entries.pop_back();
   }
 }
 
@@ -342,19 +739,59 @@ void VirtualMachine::LoadExecutable(const Executable* exec) {
       << "If the executable has declared primitive functions, the"
       << "generated kernel library must non-be null.";
 
+  // The packed functions are resolved lazily in GetPackedFunc.
+  packed_funcs_.clear();
+  packed_func_names_.clear();
   for (const auto& it : exec_->primitive_map) {
     const auto& packed_name = it.first;
     auto packed_index = static_cast<size_t>(it.second);
-    if (packed_funcs_.size() <= packed_index) {
-      packed_funcs_.resize(packed_index + 1);
+    if (packed_func_names_.size() <= packed_index) {
+      packed_func_names_.resize(packed_index + 1);
     }
-    tvm::runtime::PackedFunc pf = lib.GetFunction(packed_name, true);
-    ICHECK(pf != nullptr) << "Cannot find function in module: " << packed_name;
-    packed_funcs_[packed_index] = pf;
+    packed_func_names_[packed_index] = packed_name;
   }
-  for (size_t i = 0; i < packed_funcs_.size(); ++i) {
-    ICHECK(packed_funcs_[i] != nullptr) << "Packed function " << i << " is not initialized";
+  for (size_t i = 0; i < packed_func_names_.size(); ++i) {
+    ICHECK(!packed_func_names_[i].empty()) << "Packed function " << i << " is not initialized";
   }
+  packed_funcs_.resize(packed_func_names_.size());
+
+  is_shape_func_.assign(packed_funcs_.size(), false);
+  for (const auto& it : exec_->op_attrs) {
+    if (static_cast<size_t>(it.first) < is_shape_func_.size() &&
+        it.second.count(Executable::kShapeFuncAttr)) {
+      is_shape_func_[it.first] = true;
+    }
+  }
+  shape_func_caches_.clear();
+  shape_func_caches_.resize(packed_funcs_.size());
+  if (const char* cache_size = std::getenv("TVM_VM_SHAPE_FUNC_CACHE_SIZE")) {
+    shape_func_cache_size_ = static_cast<size_t>(std::max(std::atoi(cache_size), 0));
+  }
+
+  // Reserve the argument buffers of the packed functions for the largest instruction arity, so
+  // that the dispatch loop does not allocate (the tuples may still grow them on the first run).
+  size_t max_packed_arity = 0;
+  for (const VMFunction& vm_func : exec_->functions) {
+    for (const Instruction& instr : vm_func.instructions) {
+      if (instr.op == Opcode::InvokePacked) {
+        max_packed_arity = std::max(max_packed_arity, static_cast<size_t>(instr.arity));
+      }
+    }
+  }
+  packed_args_.reserve(max_packed_arity);
+  packed_arg_values_.resize(std::max(packed_arg_values_.size(), max_packed_arity));
+  packed_arg_codes_.resize(std::max(packed_arg_codes_.size(), max_packed_arity));
+}
+
+const PackedFunc& VirtualMachine::GetPackedFunc(Index packed_index) {
+  ICHECK_LT(static_cast<size_t>(packed_index), packed_funcs_.size());
+  PackedFunc& func = packed_funcs_[packed_index];
+  if (func == nullptr) {
+    const std::string& packed_name = packed_func_names_[packed_index];
+    func = exec_->GetLib().GetFunction(packed_name, true);
+    ICHECK(func != nullptr) << "Cannot find function in module: " << packed_name;
+  }
+  return func;
 }
 
 void VirtualMachine::Init(const std::vector<Device>& devs,
@@ -469,19 +906,26 @@ void VirtualMachine::RunLoop() {
       }
       case Opcode::InvokePacked: {
         DLOG(INFO) << "InvokedPacked " << instr.packed_index << " arity=" << instr.arity;
-        ICHECK_LE(instr.packed_index, packed_funcs_.size());
-        const auto& func = packed_funcs_[instr.packed_index];
+        const auto& func = GetPackedFunc(instr.packed_index);
         const auto& arity = instr.arity;
-        std::vector<ObjectRef> args;
+        std::vector<ObjectRef> local_args;
+        std::vector<ObjectRef>& args = packed_call_depth_ == 0 ? packed_args_ : local_args;
+        args.clear();
         for (Index i = 0; i < arity; ++i) {
           DLOG(INFO) << "arg" << i << " $" << instr.packed_args[i];
-          auto arg = ReadRegister(instr.packed_args[i]);
-          args.push_back(arg);
+          args.push_back(ReadRegister(instr.packed_args[i]));
         }
 
         // We no longer need to write the registers back, we write directly
-        // through the registers mutably.
-        InvokePacked(instr.packed_index, func, arity, instr.output_size, args);
+        // through the registers mutably. The shape functions are called while recording a trace,
+        // so that the trace computes the shapes that it is guarded on.
+        if (is_shape_func_[instr.packed_index] && recording_trace_ == nullptr) {
+          InvokeShapeFunc(instr.packed_index, func, arity, instr.output_size, args);
+        } else {
+          InvokePacked(instr.packed_index, func, arity, instr.output_size, args);
+        }
+        // drop the references so that the buffer does not extend the lifetime of the arguments
+        args.clear();
         pc_++;
         goto main_loop;
       }
@@ -523,6 +967,8 @@ void VirtualMachine::RunLoop() {
         goto main_loop;
       }
       case Opcode::If: {
+        RecordTraceGuard(instr.if_op.test);
+        RecordTraceGuard(instr.if_op.target);
         int32_t test_val = LoadScalarInt(instr.if_op.test);
         int32_t target_val = LoadScalarInt(instr.if_op.target);
 
@@ -544,6 +990,7 @@ void VirtualMachine::RunLoop() {
         }
 
         auto storage_obj = ReadRegister(instr.alloc_tensor.storage);
+        RecordTraceGuard(instr.alloc_tensor.offset);
         auto offset = LoadScalarInt(instr.alloc_tensor.offset);
         auto storage = Downcast<Storage>(storage_obj);
         auto obj = storage->AllocNDArray(offset, shape, instr.alloc_tensor.dtype);
@@ -554,6 +1001,8 @@ void VirtualMachine::RunLoop() {
       }
       case Opcode::AllocTensorReg: {
         Device cpu_dev = GetDevice(static_cast<Index>(kDLCPU));
+        RecordTraceGuard(instr.alloc_tensor_reg.shape_register);
+        RecordTraceGuard(instr.alloc_tensor.offset);
         auto shape_obj = ReadRegister(instr.alloc_tensor_reg.shape_register);
         NDArray shape_tensor = Downcast<NDArray>(CopyTo(shape_obj, cpu_dev));
         auto shape = ToShape(shape_tensor);
@@ -586,6 +1035,7 @@ void VirtualMachine::RunLoop() {
         goto main_loop;
       }
       case Opcode::AllocStorage: {
+        RecordTraceGuard(instr.alloc_storage.allocation_size);
         auto size = LoadScalarInt(instr.alloc_storage.allocation_size);
         auto alignment = instr.alloc_storage.alignment;
 
@@ -637,6 +1087,7 @@ void VirtualMachine::RunLoop() {
         auto tensor_obj = ReadRegister(instr.reshape_tensor.tensor);
         NDArray tensor_arr = Downcast<NDArray>(tensor_obj);
         // Read the shape from shape tensor
+        RecordTraceGuard(instr.reshape_tensor.newshape);
         auto shape_obj = ReadRegister(instr.reshape_tensor.newshape);
         NDArray shape_tensor = Downcast<NDArray>(CopyTo(shape_obj, cpu_dev));
         const DLTensor* dl_tensor = shape_tensor.operator->();
@@ -662,6 +1113,7 @@ void VirtualMachine::RunLoop() {
         dst_dev.device_id = 0;
 
         NDArray dst_data = src_data.CopyTo(dst_dev);
+        RecordTraceCopy(src_data, dst_data);
         WriteRegister(instr.dst, dst_data);
         pc_++;
         goto main_loop;
@@ -22,10 +22,13 @@
 #include <tvm/auto_scheduler/compute_dag.h>
 #include <tvm/runtime/container/array.h>
 #include <tvm/te/operation.h>
+#include <tvm/tir/dyn_shape_var.h>
 #include <tvm/topi/nn.h>
 
 #include <unordered_set>
 
+#include "../../src/auto_scheduler/search_policy/filter_rules.h"
+
 // Compute declaration for test
 tvm::Array<tvm::te::Tensor> conv2d_nchw_bn_relu_func(int N, int H, int W, int CI, int CO,
                                                      int kernel_size, int strides, int padding,
@@ -171,6 +174,169 @@ TEST(ComputeDAG, AccessAnalyzer) {
   }
 }
 
+// Test that the axes tied to the same shape variable are tiled symmetrically
+TEST(FilterRules, SymmetricTileFilter) {
+  using namespace tvm;
+  using namespace tvm::te;
+
+  // the TxT attention scores of batch_matmul
+  tir::DynShapeVar T("T");
+  Tensor query = placeholder({T, 64}, DataType::Float(32), "Q");
+  Tensor key = placeholder({T, 64}, DataType::Float(32), "K");
+  IterVar k = reduce_axis(Range(0, 64), "k");
+  Tensor scores = compute(
+      {T, T}, [&](Var i, Var j) { return sum(query[i][k->var] * key[j][k->var], {k}); }, "S");
+  const auto& dag = ComputeDAG({query, key, scores});
+
+  auto make_state = [&dag](int i_tile, int j_tile) {
+    State state = dag->init_state;
+    const Iterator i = state->stages[2]->iters[0], j = state->stages[2]->iters[1];
+    state.split(2, i, {Integer(i_tile)});
+    state.split(2, j, {Integer(j_tile)});
+    return state;
+  };
+  std::vector<hardware::HwAlignedConfig> configs(3);
+  std::vector<State> states = {make_state(4, 8), make_state(8, 8), make_state(16, 4)};
+  std::vector<State> filtered_states;
+  std::tie(configs, filtered_states) = SymmetricTileFilter(SearchTask(), configs, states);
+  ICHECK_EQ(filtered_states.size(), 1);
+  ICHECK(filtered_states[0].same_as(states[1]));
+
+  // all the states are kept if none of them is symmetric
+  configs.resize(2);
+  states = {make_state(4, 8), make_state(16, 4)};
+  std::tie(configs, filtered_states) = SymmetricTileFilter(SearchTask(), configs, states);
+  ICHECK_EQ(filtered_states.size(), 2);
+}
+
+// Test the thread constraints of the hardware-aligned configurations
+TEST(SearchPolicyUtils, AlignedThreadsNum) {
+  using namespace tvm;
+
+  auto hardware_api_node = make_object<hardware::HardwareAPINode>();
+  hardware_api_node->warp_size = 32;
+  hardware_api_node->compute_sm_partition = {IntImm(DataType::Int(32), 1),
+                                             IntImm(DataType::Int(32), 4)};
+  const hardware::HardwareAPI hardware_api(hardware_api_node);
+
+  // a full thread block of 1024 threads is launchable
+  ICHECK(IsValidAlignedThreadsNum(128, hardware_api));
+  ICHECK(IsValidAlignedThreadsNum(1024, hardware_api));
+  // but not beyond it, or w/ partially filled warps
+  ICHECK(!IsValidAlignedThreadsNum(1152, hardware_api));
+  ICHECK(!IsValidAlignedThreadsNum(2048, hardware_api));
+  ICHECK(!IsValidAlignedThreadsNum(96, hardware_api));
+}
+
+// Test that the workload instances are weighted uniformly if the task carries no weights
+TEST(SearchPolicyUtils, WklInstWeight) {
+  using namespace tvm;
+
+  auto task_node = make_object<SearchTaskNode>();
+  task_node->wkl_insts = {{IntImm(DataType::Int(32), 16)}, {IntImm(DataType::Int(32), 32)}};
+  SearchTask task(task_node);
+  ICHECK_EQ(GetWklInstWeight(task, 0), 1.);
+  ICHECK_EQ(GetWklInstWeight(task, 1), 1.);
+
+  task.CopyOnWrite()->wkl_inst_weights = {FloatImm(DataType::Float(32), 0.25),
+                                          FloatImm(DataType::Float(32), 0.75)};
+  ICHECK_EQ(GetWklInstWeight(task, 0), 0.25);
+  ICHECK_EQ(GetWklInstWeight(task, 1), 0.75);
+}
+
+// Test that the selection probabilities stay valid if none of the weights is positive
+TEST(SearchPolicyUtils, PrefixSumProb) {
+  std::vector<double> prefix_sum_probs;
+  ComputePrefixSumProb({1., 0., 3.}, &prefix_sum_probs);
+  ICHECK(prefix_sum_probs == std::vector<double>({0.25, 0.25, 1.}));
+
+  ComputePrefixSumProb({0., 0., 0., 0.}, &prefix_sum_probs);
+  ICHECK(prefix_sum_probs == std::vector<double>({0.25, 0.5, 0.75, 1.}));
+}
+
+// Test that the guided mutation moves to the valid factorizations w/ the smallest adaption losses
+TEST(SearchPolicyUtils, GuidedMutateFactorizationScheme) {
+  using namespace tvm;
+
+  const HardwareParams hardware_params(4, 64, 64, 49152, 2147483647, 1024, 8, 32);
+  // i (extent 64) is padded to 72 and spread over 3 blocks (out of 4 cores), whereas j is
+  // the last spatial iterator (whose vthread factor gets mutated) and the k is a reduction
+  const std::vector<SplitStepInfo> split_steps_info = {{true, 64}, {true, 32}, {false, 64}};
+  const std::vector<std::vector<int>> curr_split_factors = {{1, 1, 8, 3}, {1, 1, 8, 4}, {4, 16}};
+  const float curr_penalty = EstimateAdaptPenalty(split_steps_info, curr_split_factors, 4);
+  ICHECK_LT(curr_penalty, 1.);
+
+  for (const int max_innermost_factor : {64, 1}) {
+    DietCodeSplitFactorizationMemo memo(hardware_params, max_innermost_factor);
+    std::set<int> innermost_factors;
+    for (unsigned seed = 0; seed < 16; ++seed) {
+      std::mt19937 rng(seed);
+      FactorizationScheme scheme;
+      ICHECK(memo.GuidedMutateFactorizationScheme(split_steps_info, &rng, curr_split_factors,
+                                                   &scheme));
+      // only the innermost factor of i is changed, to a tile that neither pads nor leaves
+      // any core idle, and within the limits of the random sampling
+      ICHECK_EQ(EstimateAdaptPenalty(split_steps_info, scheme.split_factors, 4), 1.);
+      ICHECK(scheme.split_factors[1] == curr_split_factors[1]);
+      ICHECK(scheme.split_factors[2] == curr_split_factors[2]);
+      ICHECK_EQ(scheme.split_factors[0].size(), 4);
+      for (size_t i = 0; i < 3; ++i) {
+        ICHECK_EQ(scheme.split_factors[0][i], curr_split_factors[0][i]);
+      }
+      ICHECK_LE(scheme.split_factors[0][3], max_innermost_factor);
+      innermost_factors.insert(scheme.split_factors[0][3]);
+    }
+    // the ties (i.e., 8 and 16 rows per block) are broken at random
+    ICHECK(innermost_factors == (max_innermost_factor == 1 ? std::set<int>{1}
+                                                             : std::set<int>{1, 2}));
+  }
+
+  // a factorization that adapts w/o any loss is left unchanged
+  DietCodeSplitFactorizationMemo memo(hardware_params, 64);
+  std::mt19937 rng(0);
+  FactorizationScheme scheme;
+  ICHECK(!memo.GuidedMutateFactorizationScheme(
+      split_steps_info, &rng, {{1, 1, 8, 2}, {1, 1, 8, 4}, {4, 16}}, &scheme));
+  ICHECK(scheme.split_factors.empty());
+}
+
+// Test that the fingerprints are extended incrementally and identify the transform steps
+TEST(State, Fingerprint) {
+  const auto& tensors = conv2d_nchw_bn_relu_func(1, 224, 224, 3, 64, 7, 2, 3);
+  const auto& dag = ComputeDAG(tensors);
+  const int conv = 3;
+
+  auto make_state = [&dag, conv](int tile) {
+    State state = dag->init_state;
+    state.split(conv, state->stages[conv]->iters[1], {tvm::Integer(tile)});
+    state.split(conv, state->stages[conv]->iters[0], {tvm::Integer(1)});
+    return state;
+  };
+
+  // the fingerprints are equal iff the steps are
+  ICHECK(make_state(8).Fingerprint() == make_state(8).Fingerprint());
+  ICHECK(make_state(8).Fingerprint() != make_state(16).Fingerprint());
+  ICHECK(dag->init_state.Fingerprint() != make_state(8).Fingerprint());
+
+  // extending the fingerprint of the parent state gives the same fingerprint as computing it
+  // from scratch, including after the parent has been fingerprinted in between
+  State state = dag->init_state;
+  state.split(conv, state->stages[conv]->iters[1], {tvm::Integer(8)});
+  const StateFingerprint parent_fingerprint = state.Fingerprint();
+  State child = state;
+  child.split(conv, child->stages[conv]->iters[0], {tvm::Integer(1)});
+  ICHECK(child->fingerprint_cache == state->fingerprint_cache);
+  ICHECK(child.Fingerprint() == make_state(8).Fingerprint());
+  ICHECK_EQ(child->fingerprint_cache->steps.size(), 2);
+  ICHECK(state.Fingerprint() == parent_fingerprint);
+
+  // a step that is replaced in the middle invalidates the cached suffix
+  State mutated = child;
+  mutated.CopyOnWrite()->transform_steps.Set(0, make_state(16)->transform_steps[0]);
+  ICHECK(mutated.Fingerprint() == make_state(16).Fingerprint());
+  ICHECK(child.Fingerprint() == make_state(8).Fingerprint());
+}
+
 int main(int argc, char** argv) {
   testing::InitGoogleTest(&argc, argv);
   testing::FLAGS_gtest_death_test_style = "threadsafe";
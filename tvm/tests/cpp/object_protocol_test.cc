@@ -22,6 +22,8 @@
 #include <tvm/runtime/memory.h>
 #include <tvm/runtime/object.h>
 
+#include <vector>
+
 namespace tvm {
 namespace test {
 
@@ -96,6 +98,29 @@ TEST(ObjectHierachy, Basic) {
   ICHECK(refB.as<ObjB>() != nullptr);
 }
 
+TEST(ObjectArena, EscapeScope) {
+  using namespace tvm::runtime;
+  using namespace tvm::test;
+
+  std::vector<ObjectRef> escaped;
+  {
+    ObjectArenaScope arena_scope;
+    for (int i = 0; i < 10000; ++i) {
+      ObjectRef ref = i % 2 == 0 ? ObjectRef(make_object<ObjA>()) : ObjectRef(make_object<ObjB>());
+      if (i % 1000 == 0) {
+        escaped.push_back(ref);
+      }
+    }
+    ICHECK(ArenaObjAllocator::ThreadLocal() != nullptr);
+  }
+  ICHECK(ArenaObjAllocator::ThreadLocal() == nullptr);
+  // the nodes that escape the scope remain valid
+  for (const ObjectRef& ref : escaped) {
+    ICHECK(ref.as<ObjA>() != nullptr);
+    ICHECK_EQ(ref->type_index(), ObjA::RuntimeTypeIndex());
+  }
+}
+
 int main(int argc, char** argv) {
   testing::InitGoogleTest(&argc, argv);
   testing::FLAGS_gtest_death_test_style = "threadsafe";
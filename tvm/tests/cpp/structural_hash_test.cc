@@ -0,0 +1,87 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <dmlc/logging.h>
+#include <gtest/gtest.h>
+#include <tvm/node/structural_equal.h>
+#include <tvm/node/structural_hash.h>
+#include <tvm/tir/function.h>
+#include <tvm/tir/op.h>
+#include <tvm/tir/stmt.h>
+
+TEST(MemoizedStructuralHash, CacheHit) {
+  using namespace tvm;
+  using namespace tvm::tir;
+  Var x("x");
+  PrimFunc func({x}, Evaluate(x + 1));
+
+  size_t cached_value;
+  ICHECK(!func->shash_cache_.Get(&cached_value));
+  const size_t hashed_value = MemoizedStructuralHash()(func);
+  ICHECK_EQ(hashed_value, StructuralHash()(func));
+  ICHECK(func->shash_cache_.Get(&cached_value));
+  ICHECK_EQ(cached_value, hashed_value);
+
+  // the later calls return the cached value w/o hashing again
+  func->shash_cache_.Set(hashed_value + 1);
+  ICHECK_EQ(MemoizedStructuralHash()(func), hashed_value + 1);
+  func->shash_cache_.Set(hashed_value);
+
+  // the objects other than the functions are hashed afresh
+  PrimExpr expr = x + 1;
+  ICHECK_EQ(MemoizedStructuralHash()(expr), StructuralHash()(expr));
+  ICHECK(MemoizedStructuralEqual()(func, PrimFunc({x}, Evaluate(x + 1))));
+  ICHECK(!MemoizedStructuralEqual()(func, PrimFunc({x}, Evaluate(x + 2))));
+}
+
+TEST(MemoizedStructuralHash, Invalidation) {
+  using namespace tvm;
+  using namespace tvm::tir;
+  Var x("x");
+  PrimFunc func({x}, Evaluate(x + 1));
+  const size_t hashed_value = MemoizedStructuralHash()(func);
+  size_t cached_value;
+
+  // mutating the only reference in place drops the cached value
+  func.CopyOnWrite()->body = Evaluate(x + 2);
+  ICHECK(!func->shash_cache_.Get(&cached_value));
+  ICHECK_EQ(MemoizedStructuralHash()(func), StructuralHash()(func));
+  ICHECK_NE(MemoizedStructuralHash()(func), hashed_value);
+
+  // mutating a shared reference copies the function, w/o the cached value
+  PrimFunc shared_func = func;
+  shared_func.CopyOnWrite()->body = Evaluate(x + 1);
+  ICHECK(!shared_func.same_as(func));
+  ICHECK(!shared_func->shash_cache_.Get(&cached_value));
+  ICHECK_EQ(MemoizedStructuralHash()(shared_func), hashed_value);
+  ICHECK(func->shash_cache_.Get(&cached_value));
+  ICHECK_EQ(MemoizedStructuralHash()(func), StructuralHash()(func));
+
+  // so do the helpers that are built on top of CopyOnWrite
+  PrimFunc attr_func = WithAttr(std::move(shared_func), "global_symbol", String("main"));
+  ICHECK(!attr_func->shash_cache_.Get(&cached_value));
+  ICHECK_EQ(MemoizedStructuralHash()(attr_func), StructuralHash()(attr_func));
+  ICHECK_NE(MemoizedStructuralHash()(attr_func), hashed_value);
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  testing::FLAGS_gtest_death_test_style = "threadsafe";
+  return RUN_ALL_TESTS();
+}
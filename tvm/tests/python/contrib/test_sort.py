@@ -91,6 +91,34 @@ def test_sort_np():
     tvm.testing.assert_allclose(c.numpy(), np_out, rtol=1e-5)
 
 
+def test_sort_large_rows():
+    # the large rows are radix sorted in parallel, and topk selects partially,
+    # all of which must match a stable sort (with many ties)
+    dev = tvm.cpu(0)
+    argsort = tvm.get_global_func("tvm.contrib.sort.argsort")
+    sort = tvm.get_global_func("tvm.contrib.sort.sort")
+    topk = tvm.get_global_func("tvm.contrib.sort.topk")
+    for dtype in ["float32", "float64", "int32", "int64", "float16"]:
+        np_data = np.random.randint(-50, 50, size=(16, 3000)).astype(dtype)
+        a = tvm.nd.array(np_data, dev)
+        for is_ascend in [True, False]:
+            ref = np.argsort(np_data if is_ascend else -np_data, axis=1, kind="stable")
+            out = tvm.nd.array(np.zeros(np_data.shape, dtype="int32"), dev)
+            argsort(a, out, 1, is_ascend)
+            tvm.testing.assert_allclose(out.numpy(), ref)
+            out = tvm.nd.array(np.zeros(np_data.shape, dtype=dtype), dev)
+            sort(a, out, 1, is_ascend)
+            tvm.testing.assert_allclose(out.numpy(), np.take_along_axis(np_data, ref, axis=1))
+            k = 10
+            values = tvm.nd.array(np.zeros((16, k), dtype=dtype), dev)
+            indices = tvm.nd.array(np.zeros((16, k), dtype="int64"), dev)
+            topk(a, values, indices, k, 1, "both", is_ascend)
+            tvm.testing.assert_allclose(indices.numpy(), ref[:, :k])
+            tvm.testing.assert_allclose(
+                values.numpy(), np.take_along_axis(np_data, ref[:, :k], axis=1)
+            )
+
+
 def test_sort_by_key_gpu():
     size = 6
     keys = te.placeholder((size,), name="keys", dtype="int32")
@@ -126,4 +154,5 @@ def test_sort_by_key_gpu():
 if __name__ == "__main__":
     test_sort()
     test_sort_np()
+    test_sort_large_rows()
     test_sort_by_key_gpu()
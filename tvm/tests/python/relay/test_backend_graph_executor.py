@@ -182,6 +182,72 @@ def test_plan_memory():
     )
 
 
+def test_plan_memory_interval_packing():
+    # a large and a small intermediate tensor that are alive at the same time
+    x = relay.var("x", shape=(64, 64))
+    a = relay.exp(x)
+    b = relay.sum(a, axis=1)
+    c = relay.add(a, relay.expand_dims(b, axis=1))
+    d = relay.sqrt(relay.abs(c))
+    e = relay.sum(d, axis=0)
+    func = relay.Function([x], relay.Tuple([d, e]))
+    mod = tvm.IRModule.from_expr(func)
+    x_data = np.random.rand(64, 64).astype("float32")
+
+    def _build_and_run(planner):
+        with tvm.transform.PassContext(
+            opt_level=0, config={"relay.GraphPlanMemory.planner": planner}
+        ):
+            lib = relay.build(mod, "llvm")
+        gmod = graph_executor.GraphModule(lib["default"](tvm.cpu(0)))
+        gmod.set_input("x", x_data)
+        gmod.run()
+        return json.loads(lib.get_graph_json()), [gmod.get_output(i).numpy() for i in range(2)]
+
+    greedy_graph, greedy_outputs = _build_and_run("greedy")
+    packed_graph, packed_outputs = _build_and_run("interval_packing")
+    assert "storage_offset" not in greedy_graph["attrs"]
+    storage_ids = packed_graph["attrs"]["storage_id"][1]
+    storage_offsets = packed_graph["attrs"]["storage_offset"][1]
+    assert len(storage_offsets) == len(storage_ids)
+    # the input owns its storage, and the intermediate tensors share a single arena
+    assert len(set(storage_ids)) == 2
+    assert all([offset % 128 == 0 for offset in storage_offsets])
+    for greedy_output, packed_output in zip(greedy_outputs, packed_outputs):
+        tvm.testing.assert_allclose(greedy_output, packed_output, rtol=1e-5)
+    tvm.testing.assert_allclose(
+        packed_outputs[1],
+        np.sum(np.sqrt(np.abs(np.exp(x_data) + np.sum(np.exp(x_data), axis=1, keepdims=True))), 0),
+        rtol=1e-5,
+    )
+
+
+def test_plan_memory_dyn_shape():
+    # the dynamic dimensions are planned and emitted at the upper bounds of the shape variables
+    T = tvm.tir.DynShapeVar("T")
+    x = relay.var("x", shape=(T, 64))
+    y = relay.exp(relay.nn.relu(x) + relay.const(1.0))
+    z = relay.concatenate([y, y * relay.const(2.0)], axis=0)
+    mod = tvm.IRModule.from_expr(relay.Function([x], z))
+    x_data = np.random.rand(16, 64).astype("float32")
+
+    with pytest.raises(tvm.TVMError):
+        relay.build(mod, "llvm")
+    with tvm.transform.PassContext(
+        opt_level=3, config={"relay.backend.DynShape": {"shape_var_upper_bounds": {"T": 16}}}
+    ):
+        lib = relay.build(mod, "llvm")
+    graph = json.loads(lib.get_graph_json())
+    assert graph["attrs"]["shape"][1] == [[16, 64], [32, 64]]
+    gmod = graph_executor.GraphModule(lib["default"](tvm.cpu(0)))
+    gmod.set_input("x", x_data)
+    gmod.run()
+    y_data = np.exp(np.maximum(x_data, 0) + 1)
+    tvm.testing.assert_allclose(
+        gmod.get_output(0).numpy(), np.concatenate([y_data, y_data * 2], axis=0), rtol=1e-5
+    )
+
+
 def test_reshape_nop():
     # test that reshape can be turned into nop
     x = relay.var("x", shape=(10, 4))
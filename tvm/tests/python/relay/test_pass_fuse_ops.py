@@ -623,6 +623,45 @@ def test_fuse_max():
     assert tvm.ir.structural_equal(zz, after)
 
 
+def test_fuse_policy():
+    """Test the fusion policy that overrides the fusion of the OutEWiseFusable ops."""
+
+    def before():
+        x = relay.var("x", shape=(16, 32))
+        w = relay.var("w", shape=(64, 32))
+        b = relay.var("b", shape=(64,))
+        y = relay.add(relay.nn.dense(x, w), b)
+        return relay.Function([x, w, b], relay.nn.relu(y))
+
+    def num_primitive_funcs(func):
+        funcs = []
+        relay.analysis.post_order_visit(
+            func,
+            lambda expr: funcs.append(expr)
+            if isinstance(expr, relay.Function) and expr.attrs and "Primitive" in expr.attrs.keys()
+            else None,
+        )
+        return len(funcs)
+
+    candidates = []
+
+    @tvm.register_func("relay.test.reject_fusion_policy", override=True)
+    def reject_fusion(fused, anchor, tail):
+        candidates.append((fused, anchor, tail))
+        return False
+
+    config = {"relay.FuseOps.fusion_policy": "relay.test.reject_fusion_policy"}
+    with tvm.transform.PassContext(config=config):
+        zz = run_opt_pass(before(), transform.FuseOps())
+    assert num_primitive_funcs(zz) == 2
+    assert len(candidates) == 1
+    fused, anchor, tail = candidates[0]
+    assert len(fused.params) == 3 and len(anchor.params) == 2 and len(tail.params) == 2
+
+    zz = run_opt_pass(before(), transform.FuseOps())
+    assert num_primitive_funcs(zz) == 1
+
+
 def test_fuse_take():
     """Test fusion case involving concat and take"""
 
@@ -800,6 +839,7 @@ if __name__ == "__main__":
     test_immutable()
     test_split()
     test_fuse_max()
+    test_fuse_policy()
     test_fuse_take()
     test_fuse_gather_nd()
     test_fuse_bcast_reduce_scalar()
@@ -729,6 +729,53 @@ def test_vm_optimize_dynamic():
     assert "shape_func" in opt_mod.astext(False)
 
 
+def test_vm_shape_func_cache():
+    # the shape function outputs are memoized by the input shapes, which must
+    # not mix up the outputs of repeated and alternating shapes
+    x = relay.var("x", shape=(relay.Any(), 4), dtype="float32")
+    y = relay.concatenate([x, x], axis=0)
+    mod = tvm.IRModule()
+    mod["main"] = relay.Function([x], relay.nn.relu(y))
+    exe = relay.vm.compile(mod, target="llvm")
+    vm_exec = runtime.vm.VirtualMachine(exe, tvm.cpu())
+    for num_rows in [3, 5, 3, 3, 7, 5]:
+        x_data = np.random.uniform(-1, 1, size=(num_rows, 4)).astype("float32")
+        out = vm_exec.invoke("main", x_data).numpy()
+        assert out.shape == (2 * num_rows, 4)
+        tvm.testing.assert_allclose(out, np.maximum(np.concatenate([x_data, x_data]), 0))
+
+
+def test_vm_trace_mode():
+    # the traces are keyed by the input shapes, and the outputs of the replays
+    # must not alias each other
+    x = relay.var("x", shape=(relay.Any(), 4), dtype="float32")
+    y = relay.concatenate([x, x], axis=0)
+    mod = tvm.IRModule()
+    mod["main"] = relay.Function([x], relay.nn.relu(y))
+    exe = relay.vm.compile(mod, target="llvm")
+    vm_exec = runtime.vm.VirtualMachine(exe, tvm.cpu())
+    vm_exec.set_trace_mode(2)
+    outs = []
+    for num_rows in [3, 5, 3, 3, 7, 5, 3]:
+        x_data = np.random.uniform(-1, 1, size=(num_rows, 4)).astype("float32")
+        outs.append((x_data, vm_exec.invoke("main", x_data)))
+    for x_data, out in outs:
+        tvm.testing.assert_allclose(out.numpy(), np.maximum(np.concatenate([x_data, x_data]), 0))
+
+    # the branches that depend on the input values invalidate the traces
+    x = relay.var("x", shape=(relay.Any(),), dtype="float32")
+    cond = relay.greater(relay.sum(x), relay.const(0.0))
+    mod = tvm.IRModule()
+    mod["main"] = relay.Function([x], relay.If(cond, x * relay.const(2.0), -x))
+    exe = relay.vm.compile(mod, target="llvm")
+    vm_exec = runtime.vm.VirtualMachine(exe, tvm.cpu())
+    vm_exec.set_trace_mode(4)
+    for sign in [1, 1, -1, 1, -1]:
+        x_data = sign * np.random.uniform(0.1, 1, size=(6,)).astype("float32")
+        out = vm_exec.invoke("main", x_data).numpy()
+        tvm.testing.assert_allclose(out, x_data * 2 if sign > 0 else -x_data)
+
+
 def test_vm_optimize():
     mod, params = testing.synthetic.get_workload()
     comp = relay.vm.VMCompiler()
@@ -954,5 +1001,43 @@ def test_get_input_index():
     assert vm_factory.get_input_index("invalid") == -1
 
 
+
+def test_vm_reentrant_packed_call():
+    # a kernel that calls back into the VM while the outer packed call is in flight
+    x = relay.var("x", shape=(10,))
+    y = relay.var("y", shape=(10,))
+    mod = IRModule()
+    inner = relay.GlobalVar("inner")
+    mod[inner] = relay.Function([x, y], x * y + x, ret_type=relay.TensorType((10,), "float32"))
+    x = relay.var("x", shape=(10,))
+    y = relay.var("y", shape=(10,))
+    mod["main"] = relay.Function(
+        [x, y], relay.Tuple([relay.argsort(x), relay.Call(inner, [x, y]) + y])
+    )
+    vm_exec = vm.compile(mod, target="llvm")
+    vm_factory = runtime.vm.VirtualMachine(vm_exec, tvm.cpu())
+
+    x_data = np.random.rand(10).astype("float32")
+    y_data = np.random.rand(10).astype("float32")
+    argsort = tvm.get_global_func("tvm.contrib.sort.argsort")
+    nested_results = []
+
+    def reentrant_argsort(data, out, axis, is_ascend):
+        nested_results.append(vm_factory.invoke("inner", x_data, y_data).numpy())
+        argsort(data, out, axis, is_ascend)
+
+    tvm.register_func("tvm.contrib.sort.argsort", reentrant_argsort, override=True)
+    try:
+        outputs = vm_factory.invoke("main", x_data, y_data)
+    finally:
+        tvm.register_func("tvm.contrib.sort.argsort", argsort, override=True)
+    assert len(nested_results) == 1
+    np.testing.assert_allclose(nested_results[0], x_data * y_data + x_data, rtol=1e-5)
+    np.testing.assert_equal(outputs[0].numpy(), np.argsort(x_data))
+    np.testing.assert_allclose(outputs[1].numpy(), x_data * y_data + x_data + y_data, rtol=1e-5)
+    # the VM remains usable once the nested call has returned
+    outputs = vm_factory.invoke("main", y_data, x_data)
+    np.testing.assert_equal(outputs[0].numpy(), np.argsort(y_data))
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -0,0 +1,569 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""Test the dispatching of dynamic-shape workloads (DietCode)"""
+
+import itertools
+import logging
+import random
+import time
+
+import numpy as np
+import pytest
+
+import tvm
+import tvm.testing
+from tvm import auto_scheduler, te, tir, topi
+from tvm.auto_scheduler import relay_integration
+from tvm.auto_scheduler.relay_integration import RelayIntegration_DenseAdd
+from tvm.hardware import HardwareAPI, Arch, RTX3090
+
+
+def _make_dense_add_task(M_values, target="llvm", hardware_params=None):
+    M = tir.DynShapeVar("M")
+    return auto_scheduler.SearchTask(
+        func=RelayIntegration_DenseAdd,
+        args=(M, 64, 128),
+        shape_vars=(M,),
+        wkl_insts=[(v,) for v in M_values],
+        wkl_inst_weights=[1.0 * (i + 1) for i in range(len(M_values))],
+        target=target,
+        hardware_params=hardware_params,
+    )
+
+
+def _get_op(task, name):
+    return [op for op in task.compute_dag.ops if op.name == name][0]
+
+
+def _get_inner_extents(task, state, op):
+    """Get the extents of the inner iterators produced by the splits of op."""
+    state = task.compute_dag.infer_bound_from_state(state)
+    return [
+        int(it.range.extent)
+        for it in state[op].iters
+        if it.name.endswith(".1") and "@" not in it.name
+    ]
+
+
+def test_unify_layout_free_tiles():
+    task = _make_dense_add_task([16, 32])
+    dense, add = _get_op(task, "T_matmul_NT"), _get_op(task, "T_add")
+
+    def make_state(i_factor, j_factor, k_factor, add_factor):
+        state = task.compute_dag.get_init_state()
+        i, j, k = state[dense].iters
+        state.split(dense, i, [i_factor])
+        state.split(dense, j, [j_factor])
+        state.split(dense, k, [k_factor])
+        state.split(add, state[add].iters[1], [add_factor])
+        return state
+
+    # the second instance weighs more and hence decides the packed layout
+    dispatcher = auto_scheduler.DynWklDispatcher(
+        task, [make_state(2, 8, 4, 16), make_state(4, 16, 2, 32)], {0: 0, 1: 1}
+    )
+    unified_dispatcher, is_unified = dispatcher.unify_layout_free_tiles()
+    assert is_unified
+    unified_states = list(unified_dispatcher.states)
+    # only the (static) axes of the weight take the tiles of the packing state,
+    # the dynamic axis and the axes of other stages keep their own tiles
+    assert _get_inner_extents(task, unified_states[0], dense) == [2, 16, 2]
+    assert _get_inner_extents(task, unified_states[0], add) == [16]
+    assert _get_inner_extents(task, unified_states[1], dense) == [4, 16, 2]
+    assert _get_inner_extents(task, unified_states[1], add) == [32]
+
+
+def test_unify_layout_free_tiles_hardware_limits():
+    hardware_params = auto_scheduler.HardwareParams(
+        num_cores=-1,
+        vector_unit_bytes=16,
+        cache_line_bytes=64,
+        max_shared_memory_per_block=49152,
+        max_local_memory_per_block=2147483647,
+        max_threads_per_block=256,
+        max_vthread_extent=8,
+        warp_size=32,
+    )
+    task = _make_dense_add_task([16, 32], target="cuda", hardware_params=hardware_params)
+    dense = _get_op(task, "T_matmul_NT")
+
+    def make_state(i_factor, j_factor):
+        state = task.compute_dag.get_init_state()
+        i, j, k = state[dense].iters
+        io, ii = state.split(dense, i, [i_factor])
+        jo, ji = state.split(dense, j, [j_factor])
+        state.reorder(dense, [io, jo, ii, ji, k])
+        state.bind(dense, state.fuse(dense, [ii, ji]), "threadIdx.x")
+        return state
+
+    # 32x4 threads are valid, but 32x16 threads with the tiles of the packing
+    # state exceed the limit of 256 threads per block
+    dispatcher = auto_scheduler.DynWklDispatcher(
+        task, [make_state(32, 4), make_state(4, 16)], {0: 0, 1: 1}
+    )
+    unified_dispatcher, is_unified = dispatcher.unify_layout_free_tiles()
+    assert not is_unified
+    state = task.compute_dag.infer_bound_from_state(unified_dispatcher.states[0])
+    assert [int(it.range.extent) for it in state[dense].iters if "@" in it.name] == [128]
+
+
+def test_tune_parallel_dense(monkeypatch, caplog):
+    tuned_wkl_insts = []
+
+    def tune(task, tuning_options, search_policy=None):
+        tuned_wkl_insts.append([tuple(int(v) for v in wkl_inst) for wkl_inst in task.wkl_insts])
+        return auto_scheduler.DynWklDispatcher(
+            task, [task.compute_dag.get_init_state()], {i: 0 for i in range(len(task.wkl_insts))}
+        )
+
+    monkeypatch.setattr(auto_scheduler.SearchTask, "tune", tune)
+    monkeypatch.setattr(relay_integration, "PARALLEL_DENSE_DISPATCHER_REGISTRY", {})
+    combine, dispatcher = auto_scheduler.tune_parallel_dense(
+        [16, 32], [1.0, 1.0], 64, [32, 32, 32], "llvm", HardwareAPI(Arch()), None, with_bias=False
+    )
+    # the joint task is tuned only once, over the (M, N) instances of both
+    # forms, with K kept static
+    assert tuned_wkl_insts == [[(16, 32), (16, 96), (32, 32), (32, 96)]]
+    assert len(dispatcher.search_task.shape_vars) == 2
+    N = 96 if combine else 32
+    assert relay_integration.PARALLEL_DENSE_DISPATCHER_REGISTRY == {(False, 64, N): dispatcher}
+
+    def query(M):
+        io_tensors = [
+            te.placeholder((M, 64), name="X"),
+            te.placeholder((N, 64), name="W"),
+            te.placeholder((M, N), name="Y"),
+        ]
+        return relay_integration._query_parallel_dense_dispatcher(
+            "tvmgen_default_fused_nn_dense", io_tensors
+        )
+
+    assert query(32) == (dispatcher, (32, N))
+    # untuned values of M are rounded up to the next bucket
+    assert query(20) == (dispatcher, (32, N))
+    with caplog.at_level(logging.WARNING, logger="auto_scheduler"):
+        assert query(64) == (None, None)
+    assert "exceeds all the tuned buckets" in caplog.text
+
+
+def test_select_buckets():
+    def waste(value_freqs, buckets, degree):
+        return sum(
+            freq * (min([b for b in buckets if b >= v]) ** degree - v ** degree)
+            for v, freq in value_freqs.items()
+        )
+
+    rng = random.Random(0)
+    for _ in range(20):
+        values = rng.sample(range(1, 128), rng.randint(1, 8))
+        value_freqs = {v: rng.randint(1, 10) for v in values}
+        for num_buckets, degree in itertools.product([1, 2, 3, 5], [1, 2]):
+            buckets = auto_scheduler.select_buckets(value_freqs, num_buckets, degree)
+            assert max(values) in buckets and len(buckets) <= num_buckets
+            # brute force over all the bucket sets that cover the largest value
+            min_waste = min(
+                waste(value_freqs, set(others) | {max(values)}, degree)
+                for n in range(min(num_buckets, len(values)))
+                for others in itertools.combinations(sorted(values)[:-1], n)
+            )
+            assert waste(value_freqs, buckets, degree) == min_waste
+
+
+@auto_scheduler.register_workload
+def dietcode_batch_matmul_nt(B, M, K, N):
+    X = te.placeholder((B, M, K), name="X")
+    W = te.placeholder((B, N, K), name="W")
+    return [X, W, topi.nn.batch_matmul(X, W, transpose_b=True)]
+
+
+def test_generate_wkl_insts():
+    T = tir.DynShapeVar("T")
+    value_freqs = {8: 4, 16: 4, 60: 1, 64: 1, 120: 1, 128: 1}
+    wkl_insts, wkl_inst_weights = auto_scheduler.generate_wkl_insts(
+        dietcode_batch_matmul_nt, (12, T, 64, T), (T,), [value_freqs], 3
+    )
+    # T is tied to both the M and N axes, hence padding T wastes quadratically
+    # and the large values get the finer buckets
+    assert wkl_insts == [(16,), (64,), (128,)]
+    assert wkl_inst_weights == [8 / 12, 2 / 12, 2 / 12]
+
+
+def test_dispatch_to_state_round_up(caplog):
+    task = _make_dense_add_task([16, 32])
+    states = [task.compute_dag.get_init_state(), task.compute_dag.get_init_state()]
+    dispatcher = auto_scheduler.DynWklDispatcher(task, states, {0: 0, 1: 1})
+    with caplog.at_level(logging.INFO, logger="auto_scheduler"):
+        dispatcher.dispatch_to_state((16,))
+        assert "has not been tuned" not in caplog.text
+        dispatcher.dispatch_to_state((20,))
+    assert "(20,) has not been tuned and is dispatched to the bucket (32,)" in caplog.text
+
+
+@auto_scheduler.register_workload
+def dietcode_row_sum(T, N):
+    X = te.placeholder((T, N), name="X")
+    k = te.reduce_axis((0, N), name="k")
+    return [X, te.compute((T,), lambda i: te.sum(X[i, k], axis=k), name="Y")]
+
+
+def test_dispatch_to_adapted_states():
+    T = tir.DynShapeVar("T")
+    task = auto_scheduler.SearchTask(
+        func=dietcode_row_sum,
+        args=(T, 96),
+        shape_vars=(T,),
+        wkl_insts=[(4,), (1024,)],
+        wkl_inst_weights=[1.0, 1.0],
+        target="cuda",
+        hardware_params=auto_scheduler.HardwareParams(
+            num_cores=80,
+            vector_unit_bytes=16,
+            cache_line_bytes=64,
+            max_shared_memory_per_block=49152,
+            max_local_memory_per_block=2147483647,
+            max_threads_per_block=1024,
+            max_vthread_extent=8,
+            warp_size=32,
+        ),
+    )
+    row_sum = _get_op(task, "Y")
+
+    def make_state(threads_per_row):
+        # one row per block, reduced across the threads of the block
+        state = task.compute_dag.get_init_state()
+        i, k = state[row_sum].iters
+        ko, ki = state.split(row_sum, k, [threads_per_row])
+        state.bind(row_sum, i, "blockIdx.x")
+        state.bind(row_sum, ki, "threadIdx.x")
+        return state.state_object
+
+    # 64 threads pad the rows of 96 elements by 4/3, which outweighs their
+    # higher base score
+    states = [make_state(64), make_state(32)]
+    state_ids = auto_scheduler._ffi_api.DispatchToAdaptedStates(task, states, [1.2, 1.0])
+    # 4 rows cannot fill the 80 cores with any state, hence T=4 falls back to
+    # the best state before the occupancy threshold rather than the first one
+    assert [int(state_id) for state_id in state_ids] == [1, 1]
+
+
+def _make_row_sum_task(T_values):
+    T = tir.DynShapeVar("T")
+    return auto_scheduler.SearchTask(
+        func=dietcode_row_sum,
+        args=(T, 4096),
+        shape_vars=(T,),
+        wkl_insts=[(v,) for v in T_values],
+        wkl_inst_weights=[1.0 for _ in T_values],
+        target="cuda",
+        hardware_params=auto_scheduler.HardwareParams(
+            num_cores=82,
+            vector_unit_bytes=16,
+            cache_line_bytes=64,
+            max_shared_memory_per_block=49152,
+            max_local_memory_per_block=2147483647,
+            max_threads_per_block=1024,
+            max_vthread_extent=8,
+            warp_size=32,
+        ),
+        hardware_api=HardwareAPI(RTX3090()),
+    )
+
+
+def _analytically_dispatch(policy):
+    # no measurement is needed, hence neither is a GPU
+    return auto_scheduler._ffi_api.AutoSchedule(
+        policy, auto_scheduler.TuningOptions(num_measure_trials=1, verbose=0)
+    )
+
+
+def test_analytical_dispatch_row_reduction():
+    task = _make_row_sum_task([8, 82, 4096])
+    dispatcher = _analytically_dispatch(auto_scheduler.SketchPolicy(task, verbose=0))
+    row_sum = _get_op(task, "Y")
+
+    def get_threads_per_row(wkl_inst):
+        state = task.compute_dag.infer_bound_from_state(dispatcher.dispatch_to_state(wkl_inst))
+        return [int(it.range.extent) for it in state[row_sum].iters if it.name == "k.1"][0]
+
+    # The few rows spread over the whole block to fill the device, while the many rows each
+    # take a warp, which loads more elements per thread and shortens the reduction.
+    assert get_threads_per_row((8,)) == 1024
+    assert get_threads_per_row((82,)) == 128
+    assert get_threads_per_row((4096,)) == 32
+
+
+def test_shape_var_upper_bounds():
+    tasks = [_make_row_sum_task([8, 82]), _make_row_sum_task([4096, 16])]
+    assert auto_scheduler.get_shape_var_upper_bounds(tasks) == {"T": 4096}
+
+
+def test_inst_convergence(capfd):
+    task = _make_row_sum_task([82, 1024, 4096])
+    states = list(
+        _analytically_dispatch(auto_scheduler.SketchPolicy(task, verbose=0)).states
+    )
+    # pretend to measure the states w/o a GPU, each at its own cost
+    costs = {}
+
+    def build(inputs, *args):
+        return [auto_scheduler.measure.BuildResult(None, [], 0, None, 0.0) for _ in inputs]
+
+    def run(inputs, build_results, *args):
+        return [
+            auto_scheduler.measure.MeasureResult(
+                [costs[str(inp.state)]], 0, None, 0.0, time.time()
+            )
+            for inp in inputs
+        ]
+
+    def measure_and_update(policy, cost_factors):
+        for state, factor in zip(states, cost_factors):
+            costs[str(state)] = 1e-3 * factor
+        capfd.readouterr()
+        policy.measure_and_update(
+            [auto_scheduler.MeasureInput(task, state) for state in states], measurer
+        )
+        prob_log = [line for line in capfd.readouterr().err.splitlines() if "opt_prob=" in line]
+        prefix_sum_probs = [float(p) for p in prob_log[-1].split("[")[-1].split(",")[:-1]]
+        assert prefix_sum_probs[-1] == pytest.approx(1.0)
+        return np.diff([0.0] + prefix_sum_probs)
+
+    orig_build = tvm.get_global_func("auto_scheduler.local_builder.build")
+    orig_run = tvm.get_global_func("auto_scheduler.local_runner.run")
+    tvm.register_func("auto_scheduler.local_builder.build", build, override=True)
+    tvm.register_func("auto_scheduler.local_runner.run", run, override=True)
+    try:
+        measurer = auto_scheduler.measure.ProgramMeasurer(
+            auto_scheduler.LocalBuilder(), auto_scheduler.LocalRunner(), [], 0
+        )
+        policy = auto_scheduler.SketchPolicy(
+            task,
+            program_cost_model=auto_scheduler.RandomModel(),
+            params={"inst_early_stopping": 2},
+            verbose=0,
+        )
+        probs = measure_and_update(policy, [1.0, 1.0, 1.0])
+        assert all(probs > 0) and not policy.all_insts_converged
+        probs = measure_and_update(policy, [0.5, 0.5, 0.5])
+        assert all(probs > 0) and not policy.all_insts_converged
+        # The instances converge as they do not improve within 2 trials. The
+        # probabilities then fall back to the unmasked ones rather than
+        # dividing by zero.
+        probs = measure_and_update(policy, [0.5, 0.5, 0.5])
+        assert all(probs > 0) and policy.all_insts_converged
+
+        # the instances that approach the roofline converge right away
+        policy = auto_scheduler.SketchPolicy(
+            task, program_cost_model=auto_scheduler.RandomModel(), verbose=0
+        )
+        measure_and_update(policy, [1e-9, 1e-9, 1e-9])
+        assert policy.all_insts_converged
+    finally:
+        tvm.register_func("auto_scheduler.local_builder.build", orig_build, override=True)
+        tvm.register_func("auto_scheduler.local_runner.run", orig_run, override=True)
+
+
+def _make_dense_dispatcher():
+    M = tir.DynShapeVar("M")
+    task = auto_scheduler.SearchTask(
+        func=relay_integration.RelayIntegration_Dense,
+        args=(M, 64, 32),
+        shape_vars=(M,),
+        wkl_insts=[(16,), (32,)],
+        wkl_inst_weights=[1.0, 1.0],
+        target="llvm",
+    )
+    dense = _get_op(task, "T_matmul_NT")
+    tiled_state = task.compute_dag.get_init_state()
+    tiled_state.split(dense, tiled_state[dense].iters[0], [16])
+    dispatcher = auto_scheduler.DynWklDispatcher(
+        task, [task.compute_dag.get_init_state(), tiled_state], {0: 0, 1: 1}
+    )
+    return dispatcher
+
+
+def test_export_dyn_model(monkeypatch, tmpdir):
+    pytest.importorskip("sklearn")
+    from tvm import relay
+    from tvm.driver import build_module
+
+    dispatcher = _make_dense_dispatcher()
+
+    num_host_dispatch_mods = []
+    make_host_dispatch_mod = build_module._make_host_dispatch_mod
+
+    def count_host_dispatch_mods(*args):
+        num_host_dispatch_mods.append(1)
+        return make_host_dispatch_mod(*args)
+
+    monkeypatch.setattr(build_module, "_make_host_dispatch_mod", count_host_dispatch_mods)
+
+    X = relay.var("X", shape=(relay.Any(), 64))
+    W = relay.var("W", shape=(32, 64))
+    mod = tvm.IRModule.from_expr(relay.Function([X, W], relay.nn.dense(X, W)))
+    W_np = np.random.uniform(size=(32, 64)).astype("float32")
+    path = str(tmpdir.join("dyn_model.so"))
+    start = time.perf_counter()
+    auto_scheduler.export_dyn_model(mod, {"W": W_np}, "llvm", ([], [dispatcher]), path)
+    export_time = time.perf_counter() - start
+    # the dense with the dynamic M is lowered by the dispatcher
+    assert len(num_host_dispatch_mods) == 1
+
+    vm, load_time = auto_scheduler.load_dyn_model(path, tvm.cpu())
+    # the start-up does not involve any compilation
+    assert 0 < load_time < export_time
+    for M_value in [16, 32, 48]:
+        X_np = np.random.uniform(size=(M_value, 64)).astype("float32")
+        tvm.testing.assert_allclose(vm.run(X_np).numpy(), X_np @ W_np.T, rtol=1e-5)
+
+
+
+def test_hot_shape_specializer(monkeypatch):
+    import threading
+    from tvm import relay
+    from tvm.auto_scheduler.dispatcher import DispatchContext, FallbackContext
+
+    dispatcher = _make_dense_dispatcher()
+    X = relay.var("X", shape=(relay.Any(), 64))
+    W = relay.var("W", shape=(32, 64))
+    mod = tvm.IRModule.from_expr(relay.Function([X, W], relay.nn.dense(X, W)))
+    W_np = np.random.uniform(size=(32, 64)).astype("float32")
+    specializer = auto_scheduler.HotShapeSpecializer(
+        mod, {"W": W_np}, "llvm", ([], [dispatcher]), tvm.cpu(),
+        window=8, hot_ratio=0.5, min_count=2
+    )
+
+    class CountingVM:
+        def __init__(self, vm):
+            self.vm, self.num_runs = vm, 0
+
+        def run(self, *inputs):
+            self.num_runs += 1
+            return self.vm.run(*inputs)
+
+    vm = CountingVM(specializer._vm)
+    specializer._vm = vm
+
+    dispatched_wkl_insts = []
+    dispatch_to_state = auto_scheduler.DynWklDispatcher.dispatch_to_state
+
+    def record_dispatch_to_state(self, wkl_inst):
+        dispatched_wkl_insts.append(tuple(wkl_inst))
+        return dispatch_to_state(self, wkl_inst)
+
+    monkeypatch.setattr(auto_scheduler.DynWklDispatcher, "dispatch_to_state",
+                        record_dispatch_to_state)
+    builds = []
+    build = relay.build
+
+    def checked_build(*args, **kwargs):
+        # the dispatch context of the background build does not leak into the main thread
+        builds.append((threading.current_thread() is threading.main_thread(),
+                       type(DispatchContext.current).__name__,
+                       type(type(DispatchContext)._global_current).__name__))
+        if fail_builds:
+            raise RuntimeError("the model cannot be built statically")
+        return build(*args, **kwargs)
+
+    monkeypatch.setattr(relay, "build", checked_build)
+
+    def run(M_value, num_runs):
+        for _ in range(num_runs):
+            X_np = np.random.uniform(size=(M_value, 64)).astype("float32")
+            outputs = specializer.run(X_np)
+            tvm.testing.assert_allclose(outputs[0].numpy(), X_np @ W_np.T, rtol=1e-5)
+        specializer.wait()
+
+    try:
+        fail_builds = False
+        # detection: a signature becomes hot once it reaches min_count requests
+        run(16, 1)
+        assert not builds and not specializer.specialized_signatures
+        run(16, 1)
+        assert builds == [(False, "ApplyHistoryBest", "FallbackContext")]
+        assert specializer.specialized_signatures == [(((16, 64), "float32"),)]
+        # the dense of the specialized module takes the state dispatched to its instance
+        assert dispatched_wkl_insts == [(16,)]
+        # swap: the later requests of the signature bypass the virtual machine
+        assert vm.num_runs == 2
+        run(16, 4)
+        assert vm.num_runs == 2
+        # fallback: a signature whose static build fails stays on the virtual machine
+        fail_builds = True
+        run(32, 4)
+        assert len(builds) == 2
+        assert specializer.specialized_signatures == [(((16, 64), "float32"),)]
+        assert vm.num_runs == 6
+        run(32, 4)
+        assert len(builds) == 2 and vm.num_runs == 10
+    finally:
+        specializer.close()
+
+
+
+def test_cost_model_fusion_policy(monkeypatch):
+    from tvm import relay
+
+    # the task is registered by its function, and the dense is lowered w/ symbolic dimensions
+    dispatcher = _make_dense_dispatcher()
+    predicted_wkl_insts = []
+
+    def predict_latency(self, shape_tuple):
+        predicted_wkl_insts.append(tuple(shape_tuple))
+        return 1e-3 * shape_tuple[0]
+
+    monkeypatch.setattr(auto_scheduler.DynWklDispatcher, "predict_latency", predict_latency)
+
+    def fuse(X_shape, fused_latency):
+        estimated_funcs = []
+
+        def estimate(func):
+            estimated_funcs.append(func)
+            # the fused kernel takes both the inputs, while the elementwise tail takes one
+            return fused_latency if len(func.params) == 2 else 1e-3
+
+        policy = auto_scheduler.CostModelFusionPolicy("llvm", [dispatcher], estimate=estimate)
+        X = relay.var("X", shape=X_shape)
+        W = relay.var("W", shape=(32, 64))
+        mod = tvm.IRModule.from_expr(relay.Function([X, W], relay.nn.relu(relay.nn.dense(X, W))))
+        with tvm.transform.PassContext(opt_level=3, config=policy.config):
+            mod = relay.transform.FuseOps()(relay.transform.InferType()(mod))
+        primitive_funcs = []
+        relay.analysis.post_order_visit(
+            mod["main"],
+            lambda expr: primitive_funcs.append(expr)
+            if isinstance(expr, relay.Function) and expr.attrs and "Primitive" in expr.attrs.keys()
+            else None,
+        )
+        # only the fused kernel and the tail are left to the estimate
+        assert [len(func.params) for func in estimated_funcs] == [2, 1]
+        return len(primitive_funcs)
+
+    # the dense alone is predicted by the dispatcher, weighted over the workload instances
+    assert fuse((relay.Any(), 64), fused_latency=1.0) == 2
+    assert predicted_wkl_insts == [(16,), (32,)]
+    assert fuse((relay.Any(), 64), fused_latency=1e-3) == 1
+    # and at the workload instance of a static shape
+    predicted_wkl_insts.clear()
+    assert fuse((16, 64), fused_latency=1.0) == 2
+    assert predicted_wkl_insts == [(16,)]
+    assert fuse((16, 64), fused_latency=1e-3) == 1
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -24,10 +24,12 @@ import tvm
 from tvm import topi
 from tvm import te, auto_scheduler
 import tempfile
+import time
 import tvm.testing
 import pickle
 from tvm.testing.auto_scheduler import matmul_auto_scheduler_test
 from tvm.auto_scheduler import workload_registry
+from tvm.auto_scheduler.measure import MAX_FLOAT, MeasureErrorNo
 
 
 def record_common(dag, s):
@@ -326,6 +328,170 @@ def test_measure_local_builder_rpc_runner():
         del measure_ctx
 
 
+@tvm.testing.requires_llvm
+def test_measure_local_builder_distributed_rpc_runner():
+    task = auto_scheduler.SearchTask(
+        func=matmul_auto_scheduler_test, args=(128, 128, 128), target="llvm"
+    )
+
+    streamed = []
+    minps = [auto_scheduler.MeasureInput(task, task.compute_dag.init_state) for _ in range(4)]
+    local_builder = auto_scheduler.LocalBuilder()
+    measure_ctx = auto_scheduler.LocalDistributedMeasureContext(
+        num_servers=3,
+        num_keys=2,
+        timeout=60,
+        on_result=lambda i, inp, res: streamed.append((i, res.error_no)),
+    )
+    distributed_runner = measure_ctx.runner
+
+    bress = local_builder.build(minps)
+    assert all(bres.error_no == 0 for bres in bress)
+    mress = distributed_runner.run(minps, bress)
+    assert len(mress) == len(minps)
+    assert all(mres.error_no == 0 for mres in mress)
+    assert sorted(streamed) == [(i, 0) for i in range(len(minps))]
+
+    del measure_ctx
+
+
+@tvm.testing.requires_llvm
+def test_distributed_rpc_runner_retry_on_lost_server():
+    import psutil
+
+    task = auto_scheduler.SearchTask(
+        func=matmul_auto_scheduler_test, args=(128, 128, 128), target="llvm"
+    )
+    minps = [auto_scheduler.MeasureInput(task, task.compute_dag.init_state) for _ in range(4)]
+    bress = auto_scheduler.LocalBuilder().build(minps)
+    assert all(bres.error_no == 0 for bres in bress)
+    measure_ctx = auto_scheduler.LocalDistributedMeasureContext(num_servers=2, timeout=60)
+
+    def num_sessions(server):
+        return len(psutil.Process(server.proc._proc.pid).children(recursive=True))
+
+    rpc_run = auto_scheduler.measure._rpc_run
+    sessions = []
+
+    def rpc_run_losing_a_server(*args, **kwargs):
+        on_session_start = kwargs["on_session_start"]
+
+        def terminate_the_first_server():
+            on_session_start()
+            sessions.append(time.time())
+            if len(sessions) == 1:
+                # Terminate the server that serves this run, which is still in flight.
+                max(measure_ctx.servers, key=num_sessions).terminate()
+
+        kwargs["on_session_start"] = terminate_the_first_server
+        return rpc_run(*args, **kwargs)
+
+    auto_scheduler.measure._rpc_run = rpc_run_losing_a_server
+    try:
+        mress = measure_ctx.runner.run(minps, bress)
+    finally:
+        auto_scheduler.measure._rpc_run = rpc_run
+    assert all(mres.error_no == 0 for mres in mress)
+    # The run on the terminated server is retried on the other one.
+    assert len(sessions) == len(minps) + 1
+
+    del measure_ctx
+
+
+class _FakeRPCFleetBalancer(auto_scheduler.measure._RPCFleetBalancer):
+    """A balancer over a fixed fleet that does not query any RPC tracker."""
+
+    def __init__(self, num_servers):
+        self.acquired_keys = []
+        super().__init__(num_servers.keys(), None, None)
+        self.num_servers = dict(num_servers)
+
+    def refresh(self):
+        pass
+
+    def acquire(self, excluded_keys):
+        key = super().acquire(excluded_keys)
+        self.acquired_keys.append(key)
+        return key
+
+
+def _run_distributed_rpc_worker(fake_rpc_run, balancer, timeout):
+    task = auto_scheduler.SearchTask(
+        func=matmul_auto_scheduler_test, args=(16, 16, 16), target="llvm"
+    )
+    minp = auto_scheduler.MeasureInput(task, task.compute_dag.init_state)
+    (bres,) = auto_scheduler.LocalBuilder().build([minp])
+    assert bres.error_no == 0
+
+    rpc_run = auto_scheduler.measure._rpc_run
+    auto_scheduler.measure._rpc_run = fake_rpc_run
+    try:
+        run_args = ("127.0.0.1", 9190, 1, timeout, 1, 1, 0, 0.0, False)
+        res = auto_scheduler.measure._distributed_rpc_run_worker(
+            minp, bres, balancer, run_args, timeout, 2
+        )
+    finally:
+        auto_scheduler.measure._rpc_run = rpc_run
+    return auto_scheduler.MeasureResult(*res)
+
+
+@tvm.testing.requires_llvm
+def test_distributed_rpc_runner_key_exclusion():
+    # The idle device key "a" is picked first, and excluded once its server is lost.
+    balancer = _FakeRPCFleetBalancer({"a": 2, "b": 1})
+
+    def fake_rpc_run(*args, **kwargs):
+        kwargs["on_session_start"]()
+        if args[3] == "a":
+            return (MAX_FLOAT,), MeasureErrorNo.RUNTIME_DEVICE, "Connection reset", 0, time.time()
+        return (1.0,), MeasureErrorNo.NO_ERROR, None, 0, time.time()
+
+    res = _run_distributed_rpc_worker(fake_rpc_run, balancer, timeout=10)
+    assert res.error_no == MeasureErrorNo.NO_ERROR
+    assert balancer.acquired_keys == ["a", "b"]
+    assert balancer.in_flight == {"a": 0, "b": 0}
+
+    # The runs that fail for reasons other than losing the server are not retried.
+    balancer = _FakeRPCFleetBalancer({"a": 2, "b": 1})
+
+    def failing_rpc_run(*args, **kwargs):
+        kwargs["on_session_start"]()
+        return (MAX_FLOAT,), MeasureErrorNo.RUNTIME_DEVICE, "Invalid argument", 0, time.time()
+
+    res = _run_distributed_rpc_worker(failing_rpc_run, balancer, timeout=10)
+    assert res.error_no == MeasureErrorNo.RUNTIME_DEVICE
+    assert balancer.acquired_keys == ["a"]
+
+
+@tvm.testing.requires_llvm
+def test_distributed_rpc_runner_run_timeout():
+    balancer = _FakeRPCFleetBalancer({"a": 1, "b": 1})
+
+    def timed_out_rpc_run(*args, **kwargs):
+        kwargs["on_session_start"]()
+        time.sleep(1.5)
+        # The server closes the session once it runs out of time.
+        return (MAX_FLOAT,), MeasureErrorNo.RUNTIME_DEVICE, "Connection closed", 0, time.time()
+
+    res = _run_distributed_rpc_worker(timed_out_rpc_run, balancer, timeout=1)
+    assert res.error_no == MeasureErrorNo.RUN_TIMEOUT
+    assert balancer.acquired_keys == ["a"]
+
+    # The time spent waiting for the session in the tracker queue does not count.
+    balancer = _FakeRPCFleetBalancer({"a": 1, "b": 1})
+
+    def queued_rpc_run(*args, **kwargs):
+        time.sleep(1.5)
+        kwargs["on_session_start"]()
+        if args[3] == "a":
+            return (MAX_FLOAT,), MeasureErrorNo.RUNTIME_DEVICE, "Connection reset", 0, time.time()
+        return (1.0,), MeasureErrorNo.NO_ERROR, None, 0, time.time()
+
+    res = _run_distributed_rpc_worker(queued_rpc_run, balancer, timeout=1)
+    assert res.error_no == MeasureErrorNo.NO_ERROR
+    assert balancer.acquired_keys == ["a", "b"]
+
+
 def measure_local_builder_rpc_runner_spawn():
     assert multiprocessing.get_start_method(False) == "spawn"
     test_measure_local_builder_rpc_runner()
@@ -434,6 +600,10 @@ if __name__ == "__main__":
     test_dag_measure_local_builder_runner()
     test_workload_serialization()
     test_measure_local_builder_rpc_runner()
+    test_measure_local_builder_distributed_rpc_runner()
+    test_distributed_rpc_runner_retry_on_lost_server()
+    test_distributed_rpc_runner_key_exclusion()
+    test_distributed_rpc_runner_run_timeout()
     test_measure_target_host()
     test_measure_special_inputs_map_by_name_local_runner()
     test_measure_special_inputs_map_by_name_rpc_runner()
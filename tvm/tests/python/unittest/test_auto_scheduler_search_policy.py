@@ -20,6 +20,9 @@
 import random
 import multiprocessing
 import numpy as np
+import os
+import pytest
+import struct
 import tempfile
 
 import tvm
@@ -209,6 +212,81 @@ def test_sketch_search_policy_custom_sketch():
     )
 
 
+@tvm.testing.requires_llvm
+def test_sketch_search_policy_checkpoint():
+    task = auto_scheduler.SearchTask(
+        func=matmul_auto_scheduler_test, args=(64, 64, 64), target="llvm"
+    )
+    tmpdir = tempfile.mkdtemp()
+    log_file = os.path.join(tmpdir, "matmul.json")
+
+    def make_policy(init_search_callbacks=None):
+        return auto_scheduler.SketchPolicy(
+            task,
+            program_cost_model=auto_scheduler.RandomModel(),
+            verbose=0,
+            init_search_callbacks=init_search_callbacks,
+        )
+
+    def make_measurer(callbacks=None):
+        return auto_scheduler.measure.ProgramMeasurer(
+            auto_scheduler.LocalBuilder(), auto_scheduler.LocalRunner(), callbacks or [], 0
+        )
+
+    def read_bytes(filename):
+        with open(filename, "rb") as fin:
+            return fin.read()
+
+    # measure two states to fill the per-instance bests of the measurer, and
+    # preload them into the policy as its visited states
+    measurer = make_measurer([auto_scheduler.RecordToFile(log_file)])
+    inputs = []
+    for factor in [4, 8]:
+        state = task.compute_dag.get_init_state()
+        C = state.stage_ops[2]
+        state.split(C, state[C].iters[0], [factor])
+        inputs.append(auto_scheduler.MeasureInput(task, state.state_object))
+    assert make_policy().measure_and_update(inputs, measurer)[0] == 2
+    policy = make_policy([auto_scheduler.PreloadMeasuredStates(log_file)])
+
+    checkpoint = os.path.join(tmpdir, "checkpoint.bin")
+    assert policy.load_checkpoint(checkpoint, make_measurer()) == -1
+    policy.save_checkpoint(checkpoint, measurer, 2)
+    # the visited fingerprints follow the magic number, the workload key, the
+    # trial counters and the random generator state
+    blob = read_bytes(checkpoint)
+
+    def skip_string(offset):
+        return offset + 8 + struct.unpack_from("<Q", blob, offset)[0]
+
+    offset = skip_string(8) + 4 + 8
+    offset = skip_string(offset)
+    assert struct.unpack_from("<Q", blob, offset)[0] == 2
+
+    # a fresh policy and measurer resume from the checkpoint and save it back
+    # unchanged, i.e., the counters, the visited fingerprints and the
+    # per-instance bests are all restored
+    resumed_policy, resumed_measurer = make_policy(), make_measurer()
+    assert resumed_policy.load_checkpoint(checkpoint, resumed_measurer) == 2
+    resumed_checkpoint = os.path.join(tmpdir, "resumed_checkpoint.bin")
+    resumed_policy.save_checkpoint(resumed_checkpoint, resumed_measurer, 2)
+    assert read_bytes(resumed_checkpoint) == blob
+
+    fresh_checkpoint = os.path.join(tmpdir, "fresh_checkpoint.bin")
+    make_policy().save_checkpoint(fresh_checkpoint, make_measurer(), 2)
+    assert read_bytes(fresh_checkpoint) != blob
+
+    # the checkpoint cannot be resumed by another workload
+    other_task = auto_scheduler.SearchTask(
+        func=matmul_auto_scheduler_test, args=(32, 32, 32), target="llvm"
+    )
+    other_policy = auto_scheduler.SketchPolicy(
+        other_task, program_cost_model=auto_scheduler.RandomModel(), verbose=0
+    )
+    with pytest.raises(tvm.TVMError, match="different workload"):
+        other_policy.load_checkpoint(checkpoint, make_measurer())
+
+
 if __name__ == "__main__":
     test_workload_registry_empty_policy()
     test_sketch_search_policy_basic()
@@ -218,3 +296,4 @@ if __name__ == "__main__":
     test_sketch_search_policy_cuda_xgbmodel_rpc_runner()
     test_sketch_search_policy_zero_rank()
     test_sketch_search_policy_custom_sketch()
+    test_sketch_search_policy_checkpoint()
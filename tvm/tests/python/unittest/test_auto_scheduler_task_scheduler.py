@@ -17,6 +17,8 @@
 """ Test task scheduler """
 
 import tempfile
+import threading
+import time
 
 import multiprocessing
 import numpy as np
@@ -24,6 +26,7 @@ import numpy as np
 import tvm
 import tvm.testing
 from tvm import auto_scheduler
+from tvm.auto_scheduler.cost_model.cost_model import PythonBasedModel
 
 from tvm.testing.auto_scheduler import matmul_auto_scheduler_test
 
@@ -139,6 +142,76 @@ def test_task_scheduler_gradient():
         del measure_ctx
 
 
+class SlowUpdateModel(PythonBasedModel):
+    """A cost model that takes a while to update and counts the predictions during an update."""
+
+    def __init__(self):
+        super().__init__()
+        self.updating = False
+        self.num_predicts = 0
+        self.num_predicts_while_updating = 0
+
+    def update(self, inputs, results):
+        self.updating = True
+        time.sleep(0.05)
+        self.updating = False
+
+    def predict(self, task, states):
+        self.num_predicts += 1
+        if self.updating:
+            self.num_predicts_while_updating += 1
+        return np.ones(len(states))
+
+
+@tvm.testing.requires_llvm
+def test_task_scheduler_concurrent_shared_model(monkeypatch):
+    tasks = [
+        auto_scheduler.SearchTask(func=matmul_auto_scheduler_test, args=(n, n, n), target="llvm")
+        for n in [2, 4, 8]
+    ]
+    model = SlowUpdateModel()
+    num_searching = [0, 0]  # current, maximum
+    searching_lock = threading.Lock()
+
+    # Stand in for the search and the measurement phases with the cost model
+    # calls they make, so that the predictions of the search threads race with
+    # the update of the measurement thread.
+    def propose_measure_inputs(policy, num_measure):
+        with searching_lock:
+            num_searching[0] += 1
+            num_searching[1] = max(num_searching)
+        state = policy.search_task.compute_dag.get_init_state().state_object
+        for _ in range(20):
+            auto_scheduler._ffi_api.CostModelPredict(model, policy.search_task, [state])
+            time.sleep(0.005)
+        with searching_lock:
+            num_searching[0] -= 1
+        return [auto_scheduler.MeasureInput(policy.search_task, state)] * num_measure
+
+    def measure_and_update(policy, inputs, measurer):
+        auto_scheduler._ffi_api.CostModelUpdate(model, [], [])
+        return len(inputs), 1.0
+
+    monkeypatch.setattr(
+        auto_scheduler.SketchPolicy, "propose_measure_inputs", propose_measure_inputs
+    )
+    monkeypatch.setattr(auto_scheduler.SketchPolicy, "measure_and_update", measure_and_update)
+
+    search_policies = [
+        auto_scheduler.SketchPolicy(task, program_cost_model=model, verbose=0) for task in tasks
+    ]
+    tune_option = auto_scheduler.TuningOptions(num_measure_trials=12, num_measures_per_round=1)
+    task_scheduler = auto_scheduler.TaskScheduler(tasks, strategy="round-robin", callbacks=[])
+    task_scheduler.tune(tune_option, search_policy=search_policies, num_concurrent_tasks=2)
+
+    # the searches in flight when the budget runs out are still measured
+    assert 12 <= task_scheduler.ct < 12 + 2
+    assert num_searching[1] == 2
+    assert model.num_predicts > 0
+    # the shared model never predicts while it is being updated
+    assert model.num_predicts_while_updating == 0
+
+
 if __name__ == "__main__":
     test_task_scheduler_round_robin()
     test_task_scheduler_round_robin_spawn()
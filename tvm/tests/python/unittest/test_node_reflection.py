@@ -14,9 +14,10 @@
 # KIND, either express or implied.  See the License for the
 # specific language governing permissions and limitations
 # under the License.
+import numpy as np
 import tvm
 import pytest
-from tvm import te
+from tvm import te, relay
 
 
 def test_const_saveload_json():
@@ -154,6 +155,26 @@ def test_pass_config():
         cfg = tvm.transform.PassContext(config={"tir.UnrollLoop": 1})
 
 
+def test_saveload_binary():
+    x = te.var("x", "int64")
+    y = te.var("y", "int64")
+    z = tvm.tir.Add(x, tvm.tir.const(-3, "int64") + y)
+    smap = tvm.runtime.convert({"z": z, "x": x, "s": "xy\x01z", "f": tvm.tir.const(0.5)})
+    data = tvm.ir.save_binary(tvm.runtime.convert([smap]))
+    assert len(data) < len(tvm.ir.save_json(tvm.runtime.convert([smap])))
+    arr = tvm.ir.load_binary(data)
+    assert len(arr) == 1
+    assert arr[0]["z"].a == arr[0]["x"]
+    tvm.ir.assert_structural_equal(arr, [smap], map_free_vars=True)
+
+    nd = tvm.nd.array(np.arange(6, dtype="float32").reshape(2, 3))
+    arr = tvm.ir.load_binary(tvm.ir.save_binary(tvm.runtime.convert([relay.const(nd)])))
+    np.testing.assert_equal(arr[0].data.numpy(), nd.numpy())
+
+    with pytest.raises(tvm.error.TVMError):
+        tvm.ir.load_binary(data[:-1])
+
+
 def test_dict():
     x = tvm.tir.const(1)  # a class that has Python-defined methods
     # instances should see the full class dict
@@ -166,6 +187,7 @@ if __name__ == "__main__":
     test_make_node()
     test_make_smap()
     test_const_saveload_json()
+    test_saveload_binary()
     test_make_sum()
     test_pass_config()
     test_dict()
@@ -21,6 +21,7 @@ import logging
 import multiprocessing
 import os
 import stat
+import struct
 import sys
 import time
 
@@ -214,6 +215,38 @@ def test_rpc_file_exchange():
     check_remote()
 
 
+@tvm.testing.requires_rpc
+@tvm.testing.requires_llvm
+def test_rpc_measure_module():
+    if not tvm.get_global_func("tvm.contrib.random.random_fill", True):
+        pytest.skip("USE_RANDOM is not enabled")
+
+    n = 1024
+    A = te.placeholder((n,), name="A")
+    B = te.compute(A.shape, lambda *i: A(*i) + 1.0, name="B")
+    s = te.create_schedule(B.op)
+    f = tvm.build(s, [A, B], "llvm", name="myadd")
+    temp = utils.tempdir()
+    path_dso = temp.relpath("dev_lib.so")
+    f.export_library(path_dso)
+
+    server = rpc.Server(key="x1")
+    remote = rpc.connect("127.0.0.1", server.port, key="x1")
+    dev = tvm.cpu(0)
+    repeat = 3
+    measure_module = remote.get_function("tvm.rpc.server.MeasureModule")
+
+    remote.upload(path_dso)
+    args = ["float32", 1, n, "float32", 1, n]
+    blob = measure_module("dev_lib.so", dev.device_type, dev.device_id, 1, repeat, 0, "", *args)
+    costs = struct.unpack("@" + "d" * repeat, blob)
+    assert all(cost > 0 for cost in costs)
+
+    # the uploaded module is removed once measured
+    with pytest.raises(tvm.error.TVMError, match="Cannot load module"):
+        measure_module("dev_lib.so", dev.device_type, dev.device_id, 1, repeat, 0, "")
+
+
 @tvm.testing.requires_rpc
 @tvm.testing.requires_llvm
 def test_rpc_remote_module():